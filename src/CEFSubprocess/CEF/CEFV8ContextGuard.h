@@ -12,7 +12,7 @@ namespace NL::CEF
     public:
         CEFV8ContextGuard(CefRefPtr<CefV8Context> a_context)
         {
-            if (a_context->Enter())
+            if (a_context != nullptr && a_context->Enter())
             {
                 m_context = a_context;
             }
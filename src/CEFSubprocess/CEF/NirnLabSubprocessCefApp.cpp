@@ -2,11 +2,25 @@
 
 namespace NL::CEF
 {
-    void NirnLabSubprocessCefApp::InitLog(CefRefPtr<CefBrowser> a_browser)
+    void NirnLabSubprocessCefApp::InitLog(CefRefPtr<CefCommandLine> a_commandLine)
     {
         auto level = spdlog::level::info;
-        m_logSink = std::make_shared<NL::Log::IPCLogSink_mt>(a_browser);
-        auto logger = std::make_shared<spdlog::logger>("global log"s, m_logSink);
+        auto logger = std::make_shared<spdlog::logger>("global log"s);
+
+        // Only renderers have a browser to announce the ring with
+        if (m_processType == "renderer")
+        {
+            const auto mainProcessId = a_commandLine->GetSwitchValue(IPC_CL_PROCESS_ID_NAME).ToString();
+            m_logSink = std::make_shared<NL::Log::IPCLogSink_mt>(fmt::format("Local\\NirnLabUILog_{}_{}", mainProcessId, ::GetCurrentProcessId()));
+            if (m_logSink->IsValid())
+            {
+                logger->sinks().push_back(m_logSink);
+            }
+            else
+            {
+                m_logSink = nullptr;
+            }
+        }
 
 #ifdef _DEBUG
         level = spdlog::level::trace;
@@ -20,12 +34,15 @@ namespace NL::CEF
         spdlog::set_default_logger(logger);
     }
 
-    CefRefPtr<CefV8Value> NirnLabSubprocessCefApp::GetOrCreateObject(CefRefPtr<CefV8Value> a_parent, const CefString& a_objectName)
+    CefRefPtr<CefV8Value> NirnLabSubprocessCefApp::GetOrCreateObject(CefRefPtr<CefV8Value> a_parent,
+                                                                     const CefString& a_objectName,
+                                                                     CefRefPtr<NL::JS::CEFFunctionHandler> a_lazyFuncHandler)
     {
         auto object = a_parent->GetValue(a_objectName);
         if (object == nullptr || object->IsNull() || object->IsUndefined())
         {
-            object = CefV8Value::CreateObject(nullptr, nullptr);
+            object = a_lazyFuncHandler != nullptr ? NL::JS::CEFNamespaceInterceptor::CreateNamespace(a_lazyFuncHandler, a_objectName.ToString())
+                                                  : CefV8Value::CreateObject(nullptr, nullptr);
             a_parent->SetValue(a_objectName, object, V8_PROPERTY_ATTRIBUTE_NONE);
         }
         return object;
@@ -34,50 +51,165 @@ namespace NL::CEF
     size_t NirnLabSubprocessCefApp::AddFunctionHandlers(CefRefPtr<CefBrowser> a_browser,
                                                         CefRefPtr<CefFrame> a_frame,
                                                         CefProcessId a_sourceProcess,
-                                                        CefRefPtr<CefDictionaryValue> a_funcDict)
+                                                        CefRefPtr<CefDictionaryValue> a_funcDict,
+                                                        CefRefPtr<CefDictionaryValue> a_funcIdDict,
+                                                        CefRefPtr<CefDictionaryValue> a_batchedFuncDict,
+                                                        CefRefPtr<CefDictionaryValue> a_asyncFuncDict,
+                                                        CefRefPtr<CefDictionaryValue> a_lazyFuncDict)
     {
-        size_t addedFuncCount = 0;
+        // Function names of one object in a flag dictionary
+        const auto getFuncSet = [](const CefRefPtr<CefDictionaryValue>& a_dict, const CefString& a_objectName, std::unordered_set<std::string>& a_outFuncSet) {
+            a_outFuncSet.clear();
+            if (a_dict == nullptr || a_dict->GetType(a_objectName) != VTYPE_LIST)
+            {
+                return;
+            }
 
-        CEFV8ContextGuard v8ContextGuard(a_frame->GetV8Context());
-        if (!v8ContextGuard.IsEntered())
-        {
-            spdlog::error("{}[{}]: can't enter v8 context", NameOf(NirnLabSubprocessCefApp::AddFunctionHandlers), ::GetCurrentProcessId());
-            return addedFuncCount;
-        }
+            const auto funcList = a_dict->GetList(a_objectName);
+            for (size_t i = 0; i < funcList->GetSize(); ++i)
+            {
+                a_outFuncSet.insert(funcList->GetString(i).ToString());
+            }
+        };
 
         CefDictionaryValue::KeyList keyList;
         if (!a_funcDict->GetKeys(keyList))
         {
             spdlog::error("{}[{}]: can't get keys from function dictionary", NameOf(NirnLabSubprocessCefApp::AddFunctionHandlers), ::GetCurrentProcessId());
+            return 0;
         }
-        else
+
+        const auto funcHandler = NL::JS::CEFFunctionHandler::GetOrCreate(a_browser);
+        std::vector<CefString> funcKeys;
+        std::unordered_set<std::string> batchedFuncSet;
+        std::unordered_set<std::string> asyncFuncSet;
+        std::unordered_set<std::string> lazyFuncSet;
+        for (const auto& objectName : keyList)
         {
-            for (const auto& objectName : keyList)
+            const auto funcList = a_funcDict->GetList(objectName);
+            if (funcList == nullptr || funcList->GetSize() == 0)
             {
-                auto currentObjectValue = a_frame->GetV8Context()->GetGlobal();
-                const auto funcList = a_funcDict->GetList(objectName);
-                for (auto i = 0; i < funcList->GetSize(); ++i)
+                continue;
+            }
+
+            const auto objectNameString = objectName.ToString();
+            const auto idDict = a_funcIdDict != nullptr && a_funcIdDict->GetType(objectName) == VTYPE_DICTIONARY ? a_funcIdDict->GetDictionary(objectName) : nullptr;
+            getFuncSet(a_batchedFuncDict, objectName, batchedFuncSet);
+            getFuncSet(a_asyncFuncDict, objectName, asyncFuncSet);
+            getFuncSet(a_lazyFuncDict, objectName, lazyFuncSet);
+
+            for (size_t i = 0; i < funcList->GetSize(); ++i)
+            {
+                const auto funcName = funcList->GetString(i);
+                if (funcName.empty())
                 {
-                    const auto& funcName = funcList->GetString(i);
-                    if (funcName.empty())
-                    {
-                        continue;
-                    }
+                    continue;
+                }
 
-                    if (!objectName.empty())
-                    {
-                        currentObjectValue = GetOrCreateObject(currentObjectValue, objectName);
-                    }
+                const auto funcId = idDict != nullptr && idDict->GetType(funcName) == VTYPE_INT ? static_cast<std::uint32_t>(idDict->GetInt(funcName)) : 0;
+                if (funcId == 0)
+                {
+                    spdlog::error("{}[{}]: no id for function {}.{}", NameOf(NirnLabSubprocessCefApp::AddFunctionHandlers), ::GetCurrentProcessId(), objectNameString, funcName.ToString());
+                    continue;
+                }
 
-                    CefRefPtr<NL::JS::CEFFunctionHandler> funcHandler = new NL::JS::CEFFunctionHandler(a_browser, objectName);
-                    CefRefPtr<CefV8Value> funcValue = CefV8Value::CreateFunction(funcName, funcHandler);
-                    currentObjectValue->SetValue(funcName, funcValue, V8_PROPERTY_ATTRIBUTE_NONE);
-                    ++addedFuncCount;
+                const auto funcNameString = funcName.ToString();
+                CefString funcKey;
+                if (!NL::JS::CEFFunctionHandler::GetFunctionKey(objectNameString, funcNameString, funcKey))
+                {
+                    spdlog::error("{}[{}]: function name {}.{} can't contain '.'", NameOf(NirnLabSubprocessCefApp::AddFunctionHandlers), ::GetCurrentProcessId(), objectNameString, funcNameString);
+                    continue;
                 }
+
+                const auto metricName = objectNameString + "." + funcNameString;
+                NL::JS::CEFFunctionHandler::FunctionInfo funcInfo;
+                funcInfo.funcId = funcId;
+                funcInfo.metricKey = NL::Metrics::MetricTable::MakeKey(metricName);
+                funcInfo.isBatched = batchedFuncSet.contains(funcNameString);
+                funcInfo.isAsync = asyncFuncSet.contains(funcNameString);
+                funcInfo.isLazy = lazyFuncSet.contains(funcNameString);
+                NL::JS::CEFMetrics::GetFunctionTable().SetName(funcInfo.metricKey, metricName);
+
+                funcHandler->AddFunction(funcKey, objectNameString, funcNameString, funcInfo);
+                funcKeys.push_back(std::move(funcKey));
             }
         }
 
-        return addedFuncCount;
+        // Without a frame only the registry changes, functions are bound when the main context is created
+        if (a_frame == nullptr || funcKeys.empty())
+        {
+            return funcKeys.size();
+        }
+
+        const auto v8Context = a_frame->GetV8Context();
+        CEFV8ContextGuard v8ContextGuard(v8Context);
+        if (!v8ContextGuard.IsEntered())
+        {
+            spdlog::warn("{}[{}]: can't enter v8 context, functions are bound in the next one", NameOf(NirnLabSubprocessCefApp::AddFunctionHandlers), ::GetCurrentProcessId());
+            return funcKeys.size();
+        }
+
+        BindFunctionHandlers(v8Context, funcHandler, funcKeys);
+        return funcKeys.size();
+    }
+
+    size_t NirnLabSubprocessCefApp::BindFunctionHandlers(CefRefPtr<CefV8Context> a_context,
+                                                         CefRefPtr<NL::JS::CEFFunctionHandler> a_funcHandler,
+                                                         const std::vector<CefString>& a_funcKeys)
+    {
+        struct NamespaceInfo
+        {
+            CefRefPtr<CefV8Value> object = nullptr;
+            bool isLazy = false;
+        };
+
+        const auto& functions = a_funcHandler->GetFunctions();
+
+        // A new namespace with lazy functions gets an interceptor
+        std::unordered_set<std::string_view> lazyObjectSet;
+        for (const auto& funcKey : a_funcKeys)
+        {
+            const auto funcIt = functions.find(funcKey);
+            if (funcIt != functions.end() && funcIt->second.info.isLazy)
+            {
+                lazyObjectSet.insert(funcIt->second.objectName);
+            }
+        }
+
+        // The namespace is resolved once per object, lazy functions of an existing plain object are created right away
+        const auto globalObject = a_context->GetGlobal();
+        std::unordered_map<std::string_view, NamespaceInfo> namespaceMap;
+        size_t boundFuncCount = 0;
+        for (const auto& funcKey : a_funcKeys)
+        {
+            const auto funcIt = functions.find(funcKey);
+            if (funcIt == functions.end())
+            {
+                continue;
+            }
+
+            const auto& function = funcIt->second;
+            const auto [namespaceIt, isNewNamespace] = namespaceMap.try_emplace(function.objectName);
+            auto& namespaceInfo = namespaceIt->second;
+            if (isNewNamespace)
+            {
+                namespaceInfo.object = globalObject;
+                if (!function.objectName.empty())
+                {
+                    namespaceInfo.object = GetOrCreateObject(globalObject, function.objectName, lazyObjectSet.contains(function.objectName) ? a_funcHandler : nullptr);
+                    namespaceInfo.isLazy = NL::JS::CEFNamespaceInterceptor::IsLazyNamespace(namespaceInfo.object, a_funcHandler);
+                }
+            }
+
+            // The interceptor is asked before own properties, so a lazy function also hides a replaced eager one
+            if (!function.info.isLazy || !namespaceInfo.isLazy)
+            {
+                namespaceInfo.object->SetValue(function.funcName, CefV8Value::CreateFunction(funcKey, a_funcHandler), V8_PROPERTY_ATTRIBUTE_NONE);
+            }
+            ++boundFuncCount;
+        }
+
+        return boundFuncCount;
     }
 
     size_t NirnLabSubprocessCefApp::RemoveFunctionHandlers(CefRefPtr<CefBrowser> a_browser,
@@ -86,59 +218,128 @@ namespace NL::CEF
                                                            CefRefPtr<CefDictionaryValue> a_funcDict)
     {
         size_t removedFuncCount = 0;
-        const auto v8Context = a_frame->GetV8Context();
-        if (!v8Context->Enter())
-        {
-            spdlog::error("{}[{}]: can't enter v8 context", NameOf(NirnLabSubprocessCefApp::RemoveFunctionHandlers), ::GetCurrentProcessId());
-            return removedFuncCount;
-        }
-
         CefDictionaryValue::KeyList keyList;
         if (!a_funcDict->GetKeys(keyList))
         {
             spdlog::error("{}[{}]: can't get keys from function dictionary", NameOf(NirnLabSubprocessCefApp::RemoveFunctionHandlers), ::GetCurrentProcessId());
+            return removedFuncCount;
         }
-        else
+
+        // Lazy functions exist only in the registry, the interceptor stops returning them
+        const auto funcHandler = NL::JS::CEFFunctionHandler::GetOrCreate(a_browser);
+        for (const auto& objectName : keyList)
         {
-            for (const auto& objectName : keyList)
+            const auto funcList = a_funcDict->GetList(objectName);
+            if (funcList == nullptr)
             {
-                auto currentObjectValue = v8Context->GetGlobal();
-                const auto funcList = a_funcDict->GetList(objectName);
-                for (auto i = 0; i < funcList->GetSize(); ++i)
+                continue;
+            }
+
+            const auto objectNameString = objectName.ToString();
+            CefString funcKey;
+            for (size_t i = 0; i < funcList->GetSize(); ++i)
+            {
+                if (NL::JS::CEFFunctionHandler::GetFunctionKey(objectNameString, funcList->GetString(i).ToString(), funcKey) && funcHandler->RemoveFunction(funcKey))
                 {
-                    const auto& funcName = funcList->GetString(i);
-                    if (funcName.empty())
-                    {
-                        continue;
-                    }
+                    ++removedFuncCount;
+                }
+            }
+        }
 
-                    if (!objectName.empty())
-                    {
-                        auto objectValue = currentObjectValue->GetValue(objectName);
-                        if (objectValue != nullptr && objectValue->IsObject())
-                        {
-                            currentObjectValue = objectValue;
-                        }
-                    }
+        if (a_frame == nullptr || removedFuncCount == 0)
+        {
+            return removedFuncCount;
+        }
+
+        const auto v8Context = a_frame->GetV8Context();
+        CEFV8ContextGuard v8ContextGuard(v8Context);
+        if (!v8ContextGuard.IsEntered())
+        {
+            spdlog::warn("{}[{}]: can't enter v8 context, functions are removed from the registry only", NameOf(NirnLabSubprocessCefApp::RemoveFunctionHandlers), ::GetCurrentProcessId());
+            return removedFuncCount;
+        }
+
+        const auto globalObject = v8Context->GetGlobal();
+        for (const auto& objectName : keyList)
+        {
+            const auto funcList = a_funcDict->GetList(objectName);
+            if (funcList == nullptr || funcList->GetSize() == 0)
+            {
+                continue;
+            }
 
+            auto namespaceObject = globalObject;
+            if (!objectName.empty())
+            {
+                namespaceObject = globalObject->GetValue(objectName);
+                if (namespaceObject == nullptr || !namespaceObject->IsObject())
+                {
+                    continue;
+                }
+            }
+
+            for (size_t i = 0; i < funcList->GetSize(); ++i)
+            {
+                const auto funcName = funcList->GetString(i);
+                if (!funcName.empty())
+                {
                     // Note: the window object does not allow deleting a custom function for some reason. Use different object.
-                    if (currentObjectValue->DeleteValue(funcName))
-                    {
-                        ++removedFuncCount;
-                    }
+                    namespaceObject->DeleteValue(funcName);
                 }
             }
         }
 
-        v8Context->Exit();
         return removedFuncCount;
     }
 
+    size_t NirnLabSubprocessCefApp::ApplyFunctionRegistry(CefRefPtr<CefBrowser> a_browser,
+                                                          CefRefPtr<CefFrame> a_frame,
+                                                          CefProcessId a_sourceProcess,
+                                                          CefRefPtr<CefListValue> a_registry)
+    {
+        const auto funcDict = a_registry->GetType(0) == VTYPE_DICTIONARY ? a_registry->GetDictionary(0) : nullptr;
+        if (funcDict == nullptr)
+        {
+            return 0;
+        }
+
+        const auto funcHandler = NL::JS::CEFFunctionHandler::GetOrCreate(a_browser);
+        if (a_registry->GetType(IPC_JS_FUNCTION_ADD_REPLACE_INDEX) == VTYPE_BOOL && a_registry->GetBool(IPC_JS_FUNCTION_ADD_REPLACE_INDEX))
+        {
+            RemoveFunctionHandlers(a_browser, a_frame, a_sourceProcess, funcHandler->ConvertToCefDictionary());
+        }
+        if (a_registry->GetType(IPC_JS_FUNCTION_ADD_REVISION_INDEX) == VTYPE_INT)
+        {
+            funcHandler->SetRevision(static_cast<std::uint32_t>(a_registry->GetInt(IPC_JS_FUNCTION_ADD_REVISION_INDEX)));
+        }
+
+        const auto batchedFuncDict = a_registry->GetType(1) == VTYPE_DICTIONARY ? a_registry->GetDictionary(1) : nullptr;
+        const auto asyncFuncDict = a_registry->GetType(2) == VTYPE_DICTIONARY ? a_registry->GetDictionary(2) : nullptr;
+        const auto funcIdDict = a_registry->GetType(3) == VTYPE_DICTIONARY ? a_registry->GetDictionary(3) : nullptr;
+        const auto lazyFuncDict = a_registry->GetType(4) == VTYPE_DICTIONARY ? a_registry->GetDictionary(4) : nullptr;
+        return AddFunctionHandlers(a_browser, a_frame, a_sourceProcess, funcDict, funcIdDict, batchedFuncDict, asyncFuncDict, lazyFuncDict);
+    }
+
+    void NirnLabSubprocessCefApp::ReplayPreloadOperations(CefRefPtr<CefFrame> a_frame, CefRefPtr<CefListValue> a_operations)
+    {
+        // [script, scriptUrl] per operation
+        for (size_t i = 0; i < a_operations->GetSize(); ++i)
+        {
+            const auto operation = a_operations->GetList(i);
+            if (operation != nullptr && operation->GetSize() >= 2)
+            {
+                a_frame->ExecuteJavaScript(operation->GetString(0), operation->GetString(1), 0);
+            }
+        }
+    }
+
     void NirnLabSubprocessCefApp::OnBeforeCommandLineProcessing(CefString const& process_type,
                                                                 CefRefPtr<CefCommandLine> command_line)
     {
         m_processType = process_type;
-        InitLog(nullptr);
+        InitLog(command_line);
+        NL::Converters::CEFValueConverter::InitLimits(command_line);
+        NL::JS::CEFAsyncCallRegistry::InitTimeout(command_line);
     }
 
     CefRefPtr<CefRenderProcessHandler> NirnLabSubprocessCefApp::GetRenderProcessHandler()
@@ -149,9 +350,24 @@ namespace NL::CEF
     void NirnLabSubprocessCefApp::OnBrowserCreated(CefRefPtr<CefBrowser> browser,
                                                    CefRefPtr<CefDictionaryValue> extra_info)
     {
-        m_logSink->SetBrowser(browser);
         m_extraInfo = extra_info;
 
+        // Every browser announces the ring of this process, the browser process drains it once
+        if (m_logSink != nullptr)
+        {
+            auto message = CefProcessMessage::Create(IPC_LOG_RING_EVENT);
+            message->GetArgumentList()->SetString(0, m_logSink->GetMappingName());
+            message->GetArgumentList()->SetInt(1, static_cast<int>(::GetCurrentProcessId()));
+            browser->GetMainFrame()->SendProcessMessage(PID_BROWSER, message);
+        }
+
+        // Functions registered before the browser was created. A new renderer process of the browser gets the same
+        // extra info, its registry is then replaced after the main context reports an old revision
+        if (extra_info != nullptr && extra_info->GetType(IPC_JS_FUNCTION_REGISTRY_NAME) == VTYPE_LIST)
+        {
+            ApplyFunctionRegistry(browser, nullptr, PID_BROWSER, extra_info->GetList(IPC_JS_FUNCTION_REGISTRY_NAME));
+        }
+
         if (!m_browserCreatedMsgSent)
         {
             spdlog::info("{}[{}]: browser created with id {}, using CEF {}", NameOf(NirnLabSubprocessCefApp), ::GetCurrentProcessId(), browser->GetIdentifier(), CEF_VERSION);
@@ -161,7 +377,11 @@ namespace NL::CEF
 
     void NirnLabSubprocessCefApp::OnBrowserDestroyed(CefRefPtr<CefBrowser> browser)
     {
-        m_logSink->SetBrowser(nullptr);
+        NL::JS::CEFFunctionCallBatch::Remove(browser);
+        NL::JS::CEFFunctionHandler::Remove(browser);
+        NL::JS::CEFEventSchemaRegistry::RemoveBrowser(browser->GetIdentifier());
+        NL::JS::CEFScriptRegistry::RemoveBrowser(browser->GetIdentifier());
+        NL::JS::CEFStateRegistry::RemoveBrowser(browser->GetIdentifier());
         m_extraInfo = nullptr;
     }
 
@@ -175,35 +395,65 @@ namespace NL::CEF
         {
             spdlog::info("{}[{}]: main context with id {} created in browser id {}", NameOf(NirnLabSubprocessCefApp), ::GetCurrentProcessId(), frame->GetIdentifier().ToString().data(), browser->GetIdentifier());
 
-            auto message = CefProcessMessage::Create(IPC_JS_CONTEXT_CREATED);
-            frame->SendProcessMessage(PID_BROWSER, message);
-
-            // Event name func
-            const auto evenFuncInfo = m_extraInfo->GetList(IPC_JS_EVENT_FUNCTION_ADD_NAME);
-            if (evenFuncInfo != nullptr && evenFuncInfo->GetSize() > 1)
+            const auto funcHandler = NL::JS::CEFFunctionHandler::GetOrCreate(browser);
+            // Functions cleared by a url load were kept for the previous page
+            const auto staleFuncCount = funcHandler->RemoveStaleFunctions();
+            if (staleFuncCount > 0)
             {
-                const auto objectName = evenFuncInfo->GetString(0);
-                const auto funcName = evenFuncInfo->GetString(1);
-                if (!funcName.empty())
+                spdlog::info("{}[{}]: removed {} functions of the previous page for the browser with id {}", NameOf(NirnLabSubprocessCefApp), ::GetCurrentProcessId(), staleFuncCount, browser->GetIdentifier());
+            }
+            {
+                CEFV8ContextGuard v8ContextGuard(context);
+                if (v8ContextGuard.IsEntered())
                 {
-                    CEFV8ContextGuard v8ContextGuard(frame->GetV8Context());
-                    if (!v8ContextGuard.IsEntered())
+                    // Event name func
+                    const auto evenFuncInfo = m_extraInfo->GetList(IPC_JS_EVENT_FUNCTION_ADD_NAME);
+                    if (evenFuncInfo != nullptr && evenFuncInfo->GetSize() > 1)
                     {
-                        spdlog::error("{}[{}]: can't enter v8 context", NameOf(NirnLabSubprocessCefApp::OnContextCreated), ::GetCurrentProcessId());
-                        return;
+                        const auto objectName = evenFuncInfo->GetString(0);
+                        const auto funcName = evenFuncInfo->GetString(1);
+                        if (!funcName.empty())
+                        {
+                            auto currentObjectValue = context->GetGlobal();
+                            if (!objectName.empty())
+                            {
+                                // Functions of this namespace can be lazy
+                                currentObjectValue = GetOrCreateObject(currentObjectValue, objectName, funcHandler);
+                            }
+
+                            CefRefPtr<NL::JS::CEFEventFunctionHandler> eventFuncHandler = new NL::JS::CEFEventFunctionHandler();
+                            CefRefPtr<CefV8Value> funcValue = CefV8Value::CreateFunction(funcName, eventFuncHandler);
+                            currentObjectValue->SetValue(funcName, funcValue, V8_PROPERTY_ATTRIBUTE_NONE);
+                        }
                     }
 
-                    auto currentObjectValue = frame->GetV8Context()->GetGlobal();
-                    if (!objectName.empty())
+                    // Registered functions are bound before any page script runs, without waiting for the browser process
+                    std::vector<CefString> funcKeys;
+                    funcKeys.reserve(funcHandler->GetFunctions().size());
+                    for (const auto& [funcKey, function] : funcHandler->GetFunctions())
                     {
-                        currentObjectValue = GetOrCreateObject(currentObjectValue, objectName);
+                        funcKeys.push_back(funcKey);
                     }
+                    const auto boundFuncCount = BindFunctionHandlers(context, funcHandler, funcKeys);
+                    spdlog::info("{}[{}]: bound {} registered functions for the browser with id {}", NameOf(NirnLabSubprocessCefApp), ::GetCurrentProcessId(), boundFuncCount, browser->GetIdentifier());
 
-                    CefRefPtr<NL::JS::CEFEventFunctionHandler> funcHandler = new NL::JS::CEFEventFunctionHandler();
-                    CefRefPtr<CefV8Value> funcValue = CefV8Value::CreateFunction(funcName, funcHandler);
-                    currentObjectValue->SetValue(funcName, funcValue, V8_PROPERTY_ATTRIBUTE_NONE);
+                    // State objects of the previous page, the browser process sends them again only if they have changed
+                    const auto boundStateCount = NL::JS::CEFStateRegistry::BindAll(browser->GetIdentifier(), context);
+                    if (boundStateCount > 0)
+                    {
+                        spdlog::info("{}[{}]: bound {} state objects for the browser with id {}", NameOf(NirnLabSubprocessCefApp), ::GetCurrentProcessId(), boundStateCount, browser->GetIdentifier());
+                    }
+                }
+                else
+                {
+                    spdlog::error("{}[{}]: can't enter v8 context", NameOf(NirnLabSubprocessCefApp::OnContextCreated), ::GetCurrentProcessId());
                 }
             }
+
+            // The browser process replaces the registry if it has changed since this revision
+            auto message = CefProcessMessage::Create(IPC_JS_CONTEXT_CREATED);
+            message->GetArgumentList()->SetInt(0, static_cast<int>(funcHandler->GetRevision()));
+            frame->SendProcessMessage(PID_BROWSER, message);
         }
     }
 
@@ -211,48 +461,236 @@ namespace NL::CEF
                                                     CefRefPtr<CefFrame> frame,
                                                     CefRefPtr<CefV8Context> context)
     {
-        NL::JS::CEFEventFunctionHandler::RemoveEventFunc(context);
+        NL::JS::CEFEventFunctionHandler::RemoveEventFunc(browser, frame, context);
+        NL::JS::CEFAsyncCallRegistry::RemoveContext(context);
+        NL::JS::CEFEventSchemaRegistry::RemoveContext(context);
+        NL::JS::CEFScriptRegistry::RemoveContext(context);
     }
 
     bool NirnLabSubprocessCefApp::OnProcessMessageReceived(CefRefPtr<CefBrowser> browser,
                                                            CefRefPtr<CefFrame> frame,
                                                            CefProcessId source_process,
                                                            CefRefPtr<CefProcessMessage> message)
+    {
+        const auto startTime = std::chrono::steady_clock::now();
+        const auto isMessageHandled = DispatchProcessMessage(browser, frame, source_process, message);
+
+        const auto endTime = std::chrono::steady_clock::now();
+        // Reuses the buffer, names are only copied when a thread records a message type for the first time
+        thread_local std::string messageName;
+        NL::IPC::AssignUTF8(messageName, message->GetName());
+        NL::JS::CEFMetrics::GetMessageTable().Record(NL::Metrics::MetricTable::MakeKey(messageName),
+                                                     NL::IPC::GetMessageSize(message),
+                                                     NL::JS::CEFMetrics::GetMicroseconds(endTime - startTime),
+                                                     NL::Metrics::MetricTable::NO_TIMING,
+                                                     messageName);
+        NL::JS::CEFMetrics::SendReportIfDue(browser, endTime);
+        return isMessageHandled;
+    }
+
+    bool NirnLabSubprocessCefApp::DispatchProcessMessage(CefRefPtr<CefBrowser> a_browser,
+                                                         CefRefPtr<CefFrame> a_frame,
+                                                         CefProcessId a_sourceProcess,
+                                                         CefRefPtr<CefProcessMessage> a_message)
     {
         auto isMessageHandled = false;
 
-        if (message->GetName() == IPC_JS_FUNCION_ADD_EVENT)
+        if (a_message->GetName() == IPC_JS_FUNCION_ADD_EVENT)
+        {
+            const auto addedFuncCount = ApplyFunctionRegistry(a_browser, a_frame, a_sourceProcess, a_message->GetArgumentList());
+            spdlog::info("{}[{}]: registered {} functions for the browser with id {}", NameOf(NirnLabSubprocessCefApp::DispatchProcessMessage), ::GetCurrentProcessId(), addedFuncCount, a_browser->GetIdentifier());
+            isMessageHandled = true;
+        }
+        else if (a_message->GetName() == IPC_JS_FUNCTION_REMOVE_EVENT)
+        {
+            // (function dictionary, registry revision)
+            const auto args = a_message->GetArgumentList();
+            if (args->GetType(0) != VTYPE_DICTIONARY)
+            {
+                return true;
+            }
+
+            if (args->GetType(1) == VTYPE_INT)
+            {
+                NL::JS::CEFFunctionHandler::GetOrCreate(a_browser)->SetRevision(static_cast<std::uint32_t>(args->GetInt(1)));
+            }
+            const auto removedFuncCount = RemoveFunctionHandlers(a_browser, a_frame, a_sourceProcess, args->GetDictionary(0));
+            spdlog::info("{}[{}]: removed {} functions for the browser with id {}", NameOf(NirnLabSubprocessCefApp::DispatchProcessMessage), ::GetCurrentProcessId(), removedFuncCount, a_browser->GetIdentifier());
+            isMessageHandled = true;
+        }
+        else if (a_message->GetName() == IPC_JS_EVENT_FUNCTION_CALL_EVENT)
+        {
+            if (a_message->GetArgumentList()->GetSize() < 2)
+            {
+                return true;
+            }
+
+            NL::JS::CEFEventFunctionHandler::CallEventFunc(a_message->GetArgumentList()->GetString(0), a_browser, a_message->GetArgumentList()->GetString(1));
+            isMessageHandled = true;
+        }
+        else if (a_message->GetName() == IPC_JS_EVENT_FUNCTION_CALL_SHARED_EVENT)
+        {
+            const auto region = a_message->GetSharedMemoryRegion();
+            if (region == nullptr || !region->IsValid())
+            {
+                return true;
+            }
+
+            NL::IPC::PayloadReader reader(region->Memory(), region->Size());
+            std::string_view eventName;
+            std::string_view eventData;
+            if (!reader.ReadString(eventName) || !reader.ReadString(eventData))
+            {
+                spdlog::error("{}[{}]: malformed shared event payload", NameOf(NirnLabSubprocessCefApp::DispatchProcessMessage), ::GetCurrentProcessId());
+                return true;
+            }
+
+            NL::JS::CEFEventFunctionHandler::CallEventFunc(NL::IPC::ToCefString(eventName), a_browser, NL::IPC::ToCefString(eventData));
+            isMessageHandled = true;
+        }
+        else if (a_message->GetName() == IPC_JS_EVENT_FUNCTION_BATCH_EVENT)
+        {
+            const auto region = a_message->GetSharedMemoryRegion();
+            if (region != nullptr && region->IsValid())
+            {
+                NL::JS::CEFEventFunctionHandler::CallEventFuncBatch(a_browser, region->Memory(), region->Size());
+            }
+            else if (const auto args = a_message->GetArgumentList(); args != nullptr && args->GetType(0) == VTYPE_BINARY)
+            {
+                const auto payload = args->GetBinary(0);
+                NL::JS::CEFEventFunctionHandler::CallEventFuncBatch(a_browser, payload->GetRawData(), payload->GetSize());
+            }
+            isMessageHandled = true;
+        }
+        else if (a_message->GetName() == IPC_JS_EVENT_SCHEMA_EVENT)
+        {
+            const auto args = a_message->GetArgumentList();
+            NL::IPC::EventSchema schema;
+            if (args->GetType(0) != VTYPE_STRING || args->GetType(1) != VTYPE_LIST || !NL::IPC::EventSchema::FromCefList(args->GetList(1), schema))
+            {
+                spdlog::error("{}[{}]: malformed event schema", NameOf(NirnLabSubprocessCefApp::DispatchProcessMessage), ::GetCurrentProcessId());
+                return true;
+            }
+
+            NL::JS::CEFEventSchemaRegistry::SetSchema(a_browser->GetIdentifier(), args->GetString(0).ToString(), std::move(schema));
+            isMessageHandled = true;
+        }
+        else if (a_message->GetName() == IPC_JS_EVENT_PACKED_EVENT)
+        {
+            const auto args = a_message->GetArgumentList();
+            if (args->GetType(0) != VTYPE_STRING || args->GetType(1) != VTYPE_BINARY)
+            {
+                return true;
+            }
+
+            const auto payload = args->GetBinary(1);
+            NL::JS::CEFEventFunctionHandler::CallEventFuncPacked(args->GetString(0), a_browser, payload->GetRawData(), payload->GetSize());
+            isMessageHandled = true;
+        }
+        else if (a_message->GetName() == IPC_JS_EVENT_BINARY_EVENT)
+        {
+            // Shared memory: [string eventName][string data], otherwise the arguments are (eventName, binary data)
+            const auto region = a_message->GetSharedMemoryRegion();
+            const auto args = a_message->GetArgumentList();
+            if (region != nullptr && region->IsValid())
+            {
+                NL::IPC::PayloadReader reader(region->Memory(), region->Size());
+                std::string_view eventName;
+                std::string_view eventData;
+                if (!reader.ReadString(eventName) || !reader.ReadString(eventData))
+                {
+                    spdlog::error("{}[{}]: malformed binary event payload", NameOf(NirnLabSubprocessCefApp::DispatchProcessMessage), ::GetCurrentProcessId());
+                    return true;
+                }
+
+                NL::JS::CEFEventFunctionHandler::CallEventFuncBinary(NL::IPC::ToCefString(eventName), a_browser, eventData.data(), eventData.size());
+            }
+            else if (args != nullptr && args->GetType(0) == VTYPE_STRING)
+            {
+                const auto payload = args->GetType(1) == VTYPE_BINARY ? args->GetBinary(1) : nullptr;
+                NL::JS::CEFEventFunctionHandler::CallEventFuncBinary(args->GetString(0),
+                                                                     a_browser,
+                                                                     payload != nullptr ? payload->GetRawData() : nullptr,
+                                                                     payload != nullptr ? payload->GetSize() : 0);
+            }
+            isMessageHandled = true;
+        }
+        else if (a_message->GetName() == IPC_JS_FUNCTION_CLEAR_EVENT)
+        {
+            const auto args = a_message->GetArgumentList();
+            const auto funcHandler = NL::JS::CEFFunctionHandler::GetOrCreate(a_browser);
+            funcHandler->MarkFunctionsStale();
+            if (args->GetType(0) == VTYPE_INT)
+            {
+                funcHandler->SetRevision(static_cast<std::uint32_t>(args->GetInt(0)));
+            }
+            isMessageHandled = true;
+        }
+        else if (a_message->GetName() == IPC_JS_PRELOAD_BATCH_EVENT)
         {
-            const auto funcDict = message->GetArgumentList()->GetDictionary(0);
-            if (funcDict == nullptr)
+            // (operation list)
+            const auto args = a_message->GetArgumentList();
+            if (args->GetType(0) != VTYPE_LIST)
             {
                 return true;
             }
 
-            const auto addedFuncCount = AddFunctionHandlers(browser, frame, source_process, funcDict);
-            spdlog::info("{}[{}]: registered {} functions for the browser with id {}", NameOf(NirnLabSubprocessCefApp::OnProcessMessageReceived), ::GetCurrentProcessId(), addedFuncCount, browser->GetIdentifier());
+            const auto operations = args->GetList(0);
+            ReplayPreloadOperations(a_frame, operations);
+            spdlog::info("{}[{}]: executed {} scripts made before page load for the browser with id {}", NameOf(NirnLabSubprocessCefApp::DispatchProcessMessage), ::GetCurrentProcessId(), operations->GetSize(), a_browser->GetIdentifier());
             isMessageHandled = true;
         }
-        else if (message->GetName() == IPC_JS_FUNCTION_REMOVE_EVENT)
+        else if (a_message->GetName() == IPC_JS_SCRIPT_REGISTER_EVENT)
         {
-            const auto funcDict = message->GetArgumentList()->GetDictionary(0);
-            if (funcDict == nullptr)
+            const auto args = a_message->GetArgumentList();
+            if (args->GetType(0) != VTYPE_INT || args->GetType(1) != VTYPE_STRING || args->GetType(2) != VTYPE_STRING)
             {
+                spdlog::error("{}[{}]: malformed script registration", NameOf(NirnLabSubprocessCefApp::DispatchProcessMessage), ::GetCurrentProcessId());
                 return true;
             }
 
-            const auto addedFuncCount = RemoveFunctionHandlers(browser, frame, source_process, funcDict);
-            spdlog::info("{}[{}]: removed {} functions for the browser with id {}", NameOf(NirnLabSubprocessCefApp::OnProcessMessageReceived), ::GetCurrentProcessId(), addedFuncCount, browser->GetIdentifier());
+            NL::JS::CEFScriptRegistry::SetScript(a_browser->GetIdentifier(), static_cast<std::uint32_t>(args->GetInt(0)), args->GetString(1).ToString(), args->GetString(2).ToString());
             isMessageHandled = true;
         }
-        else if (message->GetName() == IPC_JS_EVENT_FUNCTION_CALL_EVENT)
+        else if (a_message->GetName() == IPC_JS_STATE_REGISTER_EVENT)
         {
-            if (message->GetArgumentList()->GetSize() < 2)
+            const auto args = a_message->GetArgumentList();
+            if (args->GetType(0) != VTYPE_STRING || args->GetType(1) != VTYPE_STRING || args->GetType(2) != VTYPE_BINARY)
             {
+                spdlog::error("{}[{}]: malformed state object registration", NameOf(NirnLabSubprocessCefApp::DispatchProcessMessage), ::GetCurrentProcessId());
                 return true;
             }
 
-            NL::JS::CEFEventFunctionHandler::CallEventFunc(message->GetArgumentList()->GetString(0), browser, message->GetArgumentList()->GetString(1));
+            const auto layout = args->GetBinary(2);
+            NL::JS::CEFStateRegistry::SetState(a_browser, args->GetString(0).ToString(), args->GetString(1).ToString(), layout->GetRawData(), layout->GetSize());
+            isMessageHandled = true;
+        }
+        else if (a_message->GetName() == IPC_JS_SCRIPT_CALL_EVENT)
+        {
+            const auto region = a_message->GetSharedMemoryRegion();
+            if (region != nullptr && region->IsValid())
+            {
+                NL::JS::CEFScriptRegistry::Call(a_browser, region->Memory(), region->Size());
+            }
+            else if (const auto args = a_message->GetArgumentList(); args != nullptr && args->GetType(0) == VTYPE_BINARY)
+            {
+                const auto payload = args->GetBinary(0);
+                NL::JS::CEFScriptRegistry::Call(a_browser, payload->GetRawData(), payload->GetSize());
+            }
+            isMessageHandled = true;
+        }
+        else if (a_message->GetName() == IPC_JS_ASYNC_RESULT_EVENT)
+        {
+            const auto region = a_message->GetSharedMemoryRegion();
+            if (region != nullptr && region->IsValid())
+            {
+                NL::JS::CEFAsyncCallRegistry::Complete(region->Memory(), region->Size());
+            }
+            else if (const auto args = a_message->GetArgumentList(); args != nullptr && args->GetType(0) == VTYPE_BINARY)
+            {
+                const auto payload = args->GetBinary(0);
+                NL::JS::CEFAsyncCallRegistry::Complete(payload->GetRawData(), payload->GetSize());
+            }
             isMessageHandled = true;
         }
 
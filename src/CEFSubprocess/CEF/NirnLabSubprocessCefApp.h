@@ -7,7 +7,11 @@
 #include "Log/IPCLogSink.hpp"
 #include "JS/CEFFunctionQueue.h"
 #include "JS/CEFFunctionHandler.h"
+#include "JS/CEFNamespaceInterceptor.h"
 #include "JS/CEFEventFunctionHandler.h"
+#include "JS/CEFScriptRegistry.h"
+#include "JS/CEFStateRegistry.h"
+#include "JS/CEFMetrics.h"
 
 namespace NL::CEF
 {
@@ -22,20 +26,65 @@ namespace NL::CEF
         CefRefPtr<CefDictionaryValue> m_extraInfo = nullptr;
         bool m_browserCreatedMsgSent = false;
 
-        void InitLog(CefRefPtr<CefBrowser> a_browser);
+        /// <summary>
+        /// Renderers log into a shared memory ring, other processes have no log
+        /// </summary>
+        void InitLog(CefRefPtr<CefCommandLine> a_commandLine);
+        /// <summary>
+        /// Handles a message from the browser process, OnProcessMessageReceived adds metrics around it
+        /// </summary>
+        bool DispatchProcessMessage(CefRefPtr<CefBrowser> a_browser,
+                                    CefRefPtr<CefFrame> a_frame,
+                                    CefProcessId a_sourceProcess,
+                                    CefRefPtr<CefProcessMessage> a_message);
 
     public:
         NirnLabSubprocessCefApp() = default;
 
-        CefRefPtr<CefV8Value> GetOrCreateObject(CefRefPtr<CefV8Value> a_parent, const CefString& a_objectName);
+        /// <summary>
+        /// A new object gets a namespace interceptor if a_lazyFuncHandler is set (see CEFNamespaceInterceptor)
+        /// </summary>
+        CefRefPtr<CefV8Value> GetOrCreateObject(CefRefPtr<CefV8Value> a_parent,
+                                                const CefString& a_objectName,
+                                                CefRefPtr<NL::JS::CEFFunctionHandler> a_lazyFuncHandler = nullptr);
+        /// <summary>
+        /// Adds functions to the registry of the browser and binds them in the context of a_frame, a_frame can be nullptr.
+        /// Flag dictionaries have the same layout as a_funcDict and list functions with batched calls, async results
+        /// or lazy creation (see CEFNamespaceInterceptor), they can be nullptr
+        /// </summary>
         size_t AddFunctionHandlers(CefRefPtr<CefBrowser> a_browser,
                                    CefRefPtr<CefFrame> a_frame,
                                    CefProcessId a_sourceProcess,
-                                   CefRefPtr<CefDictionaryValue> a_funcDict);
+                                   CefRefPtr<CefDictionaryValue> a_funcDict,
+                                   CefRefPtr<CefDictionaryValue> a_funcIdDict,
+                                   CefRefPtr<CefDictionaryValue> a_batchedFuncDict = nullptr,
+                                   CefRefPtr<CefDictionaryValue> a_asyncFuncDict = nullptr,
+                                   CefRefPtr<CefDictionaryValue> a_lazyFuncDict = nullptr);
+        /// <summary>
+        /// Binds registered functions in an entered context. Namespace objects are resolved once per object
+        /// </summary>
+        size_t BindFunctionHandlers(CefRefPtr<CefV8Context> a_context,
+                                    CefRefPtr<NL::JS::CEFFunctionHandler> a_funcHandler,
+                                    const std::vector<CefString>& a_funcKeys);
+        /// <summary>
+        /// Removes functions from the registry of the browser and from the context of a_frame, a_frame can be nullptr
+        /// </summary>
         size_t RemoveFunctionHandlers(CefRefPtr<CefBrowser> a_browser,
                                       CefRefPtr<CefFrame> a_frame,
                                       CefProcessId a_sourceProcess,
                                       CefRefPtr<CefDictionaryValue> a_funcDict);
+        /// <summary>
+        /// Applies IPC_JS_FUNCION_ADD_EVENT arguments or the IPC_JS_FUNCTION_REGISTRY_NAME extra info, a replacing registry
+        /// removes the functions it does not list
+        /// </summary>
+        size_t ApplyFunctionRegistry(CefRefPtr<CefBrowser> a_browser,
+                                     CefRefPtr<CefFrame> a_frame,
+                                     CefProcessId a_sourceProcess,
+                                     CefRefPtr<CefListValue> a_registry);
+        /// <summary>
+        /// Executes IPC_JS_PRELOAD_BATCH_EVENT scripts in call order
+        /// </summary>
+        void ReplayPreloadOperations(CefRefPtr<CefFrame> a_frame, CefRefPtr<CefListValue> a_operations);
 
         // CefApp
         void OnBeforeCommandLineProcessing(CefString const& process_type, CefRefPtr<CefCommandLine> command_line) override;
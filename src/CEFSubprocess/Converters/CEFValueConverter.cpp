@@ -248,91 +248,434 @@ namespace NL::Converters
         return obj;
     }
 
-    CefRefPtr<CefValue> CEFValueConverter::ConvertValue(const CefRefPtr<CefV8Value>& a_v8Value,
-                                                        std::vector<CefRefPtr<CefV8Value>>& a_objectRefs,
-                                                        std::unordered_map<std::string, std::uint32_t>& a_warnMap,
-                                                        CefString& a_exception)
+    CEFValueConverter::Limits CEFValueConverter::s_limits;
+
+    namespace
     {
-        auto result = CefValue::Create();
-        const auto repCount = std::count_if(
-            a_objectRefs.begin(),
-            a_objectRefs.end(),
-            [&](const CefRefPtr<CefV8Value>& a_value) {
-                return a_value->IsSame(a_v8Value);
-            });
+        // CEF has no typed array type check, ArrayBuffer.isView tells views (typed arrays, DataView) from plain objects.
+        // Returns false if the value is not binary, a_outData points into the V8 heap
+        bool GetBinaryData(const CefRefPtr<CefV8Value>& a_v8Value, CEFValueConverter::ConvertState& a_state, const char*& a_outData, size_t& a_outSize)
+        {
+            auto buffer = a_v8Value;
+            size_t offset = 0;
+            if (a_v8Value->IsArrayBuffer())
+            {
+                a_outSize = a_v8Value->GetArrayBufferByteLength();
+            }
+            else
+            {
+                if (!a_v8Value->IsObject() || a_v8Value->IsArray() || a_v8Value->IsFunction())
+                {
+                    return false;
+                }
+
+                if (!a_state.isViewFuncResolved)
+                {
+                    a_state.isViewFuncResolved = true;
+                    const auto context = CefV8Context::GetCurrentContext();
+                    const auto arrayBuffer = context != nullptr ? context->GetGlobal()->GetValue("ArrayBuffer") : nullptr;
+                    const auto isViewFunc = arrayBuffer != nullptr && arrayBuffer->IsObject() ? arrayBuffer->GetValue("isView") : nullptr;
+                    a_state.isViewFunc = isViewFunc != nullptr && isViewFunc->IsFunction() ? isViewFunc : nullptr;
+                }
+
+                if (a_state.isViewFunc == nullptr)
+                {
+                    return false;
+                }
+
+                const auto isView = a_state.isViewFunc->ExecuteFunction(nullptr, {a_v8Value});
+                if (isView == nullptr || !isView->IsBool() || !isView->GetBoolValue())
+                {
+                    return false;
+                }
 
-        if (repCount > 0)
+                buffer = a_v8Value->GetValue("buffer");
+                const auto byteOffset = a_v8Value->GetValue("byteOffset");
+                const auto byteLength = a_v8Value->GetValue("byteLength");
+                if (buffer == nullptr || !buffer->IsArrayBuffer() || byteOffset == nullptr || byteLength == nullptr || !byteOffset->IsDouble() ||
+                    !byteLength->IsDouble() || byteOffset->GetDoubleValue() < 0.0 || byteLength->GetDoubleValue() < 0.0)
+                {
+                    return false;
+                }
+
+                offset = static_cast<size_t>(byteOffset->GetDoubleValue());
+                a_outSize = static_cast<size_t>(byteLength->GetDoubleValue());
+                const auto bufferSize = buffer->GetArrayBufferByteLength();
+                if (offset > bufferSize || a_outSize > bufferSize - offset)
+                {
+                    return false;
+                }
+            }
+
+            // Detached buffers have no data
+            const auto data = static_cast<const char*>(buffer->GetArrayBufferData());
+            a_outData = data != nullptr ? data + offset : nullptr;
+            return true;
+        }
+
+        // Sets a_target[a_key] for every non-container value, returns false for arrays and objects
+        template <class TTarget, class... TKey>
+        bool SetLeafValue(const CefRefPtr<CefV8Value>& a_v8Value,
+                          CEFValueConverter::ConvertState& a_state,
+                          const CefRefPtr<TTarget>& a_target,
+                          const TKey&... a_key)
         {
-            a_exception = fmt::format("{}: trying to serialize circular reference", NameOf(CEFValueConverter::ConvertValue));
-            result->SetNull();
-            return result;
+            // Only the top-level value has no key
+            constexpr auto isNested = sizeof...(TKey) > 0;
+
+            const char* binaryData = nullptr;
+            size_t binarySize = 0;
+            if (GetBinaryData(a_v8Value, a_state, binaryData, binarySize))
+            {
+                if (isNested)
+                {
+                    a_state.warnMap.emplace(fmt::format("{}: binary values are passed as top-level arguments only, nested one is null", NameOf(CEFValueConverter::ConvertValue)), 0).first->second++;
+                    a_target->SetNull(a_key...);
+                }
+                // CEF can't hold an empty binary value
+                else if (binaryData == nullptr || binarySize == 0)
+                {
+                    a_target->SetNull(a_key...);
+                }
+                else
+                {
+                    a_state.byteSize += binarySize;
+                    a_target->SetBinary(a_key..., CefBinaryValue::Create(binaryData, binarySize));
+                    return true;
+                }
+            }
+            else if (a_v8Value->IsPromise())
+            {
+                a_state.warnMap.emplace(fmt::format("{}: can't serialize promise", NameOf(CEFValueConverter::ConvertValue)), 0).first->second++;
+                a_target->SetNull(a_key...);
+            }
+            else if (a_v8Value->IsFunction())
+            {
+                a_state.warnMap.emplace(fmt::format("{}: can't serialize function", NameOf(CEFValueConverter::ConvertValue)), 0).first->second++;
+                a_target->SetNull(a_key...);
+            }
+            else if (a_v8Value->IsBool())
+            {
+                a_target->SetBool(a_key..., a_v8Value->GetBoolValue());
+            }
+            else if (a_v8Value->IsInt() || a_v8Value->IsUInt())
+            {
+                a_target->SetInt(a_key..., a_v8Value->GetIntValue());
+            }
+            else if (a_v8Value->IsDouble())
+            {
+                a_target->SetDouble(a_key..., a_v8Value->GetDoubleValue());
+            }
+            else if (a_v8Value->IsString() || a_v8Value->IsDate())
+            {
+                const auto str = a_v8Value->GetStringValue();
+                a_state.byteSize += str.length();
+                a_target->SetString(a_key..., str);
+                return true;
+            }
+            else if (a_v8Value->IsArray() || a_v8Value->IsObject())
+            {
+                return false;
+            }
+            else
+            {
+                a_target->SetNull(a_key...);
+            }
+
+            a_state.byteSize += sizeof(double);
+            return true;
         }
+    }
 
-        if (a_v8Value->IsArrayBuffer())
+    std::uint64_t CEFValueConverter::GetRefKey(bool a_isArray, int a_size)
+    {
+        return (static_cast<std::uint64_t>(a_isArray) << 32) | static_cast<std::uint32_t>(a_size);
+    }
+
+    void CEFValueConverter::AncestorSet::Create()
+    {
+        m_isCreated = true;
+        const auto context = CefV8Context::GetCurrentContext();
+        const auto global = context != nullptr ? context->GetGlobal() : nullptr;
+        const auto reflect = global != nullptr ? global->GetValue("Reflect") : nullptr;
+        const auto constructFunc = reflect != nullptr && reflect->IsObject() ? reflect->GetValue("construct") : nullptr;
+        const auto setClass = global != nullptr ? global->GetValue("Set") : nullptr;
+        if (constructFunc == nullptr || !constructFunc->IsFunction() || setClass == nullptr || !setClass->IsFunction())
         {
-            a_warnMap.emplace(fmt::format("{}: can't serialize array buffer", NameOf(CEFValueConverter::ConvertValue)), 0).first->second++;
-            result->SetNull();
-            return result;
+            return;
         }
-        else if (a_v8Value->IsPromise())
+
+        // Set() can't be called without new, Reflect.construct can
+        const auto set = constructFunc->ExecuteFunction(reflect, {setClass, CefV8Value::CreateArray(0)});
+        if (set == nullptr || !set->IsObject())
         {
-            a_warnMap.emplace(fmt::format("{}: can't serialize promise", NameOf(CEFValueConverter::ConvertValue)), 0).first->second++;
-            result->SetNull();
-            return result;
+            constructFunc->ClearException();
+            return;
         }
-        else if (a_v8Value->IsFunction())
+
+        const auto hasFunc = set->GetValue("has");
+        const auto addFunc = set->GetValue("add");
+        const auto deleteFunc = set->GetValue("delete");
+        if (hasFunc == nullptr || !hasFunc->IsFunction() || addFunc == nullptr || !addFunc->IsFunction() || deleteFunc == nullptr || !deleteFunc->IsFunction())
         {
-            a_warnMap.emplace(fmt::format("{}: can't serialize function", NameOf(CEFValueConverter::ConvertValue)), 0).first->second++;
-            result->SetNull();
-            return result;
+            return;
         }
-        else if (a_v8Value->IsBool())
+
+        m_set = set;
+        m_hasFunc = hasFunc;
+        m_addFunc = addFunc;
+        m_deleteFunc = deleteFunc;
+    }
+
+    bool CEFValueConverter::AncestorSet::Call(const CefRefPtr<CefV8Value>& a_func, const CefRefPtr<CefV8Value>& a_value)
+    {
+        const auto result = a_func->ExecuteFunction(m_set, {a_value});
+        if (a_func->HasException())
         {
-            result->SetBool(a_v8Value->GetBoolValue());
+            a_func->ClearException();
+            return false;
         }
-        else if (a_v8Value->IsInt() || a_v8Value->IsUInt())
+
+        return result != nullptr && result->IsBool() && result->GetBoolValue();
+    }
+
+    bool CEFValueConverter::AncestorSet::Contains(const std::vector<Frame>& a_stack, const CefRefPtr<CefV8Value>& a_v8Value)
+    {
+        if (!m_isCreated)
         {
-            result->SetInt(a_v8Value->GetIntValue());
+            Create();
         }
-        else if (a_v8Value->IsDouble())
+
+        if (m_set == nullptr)
         {
-            result->SetDouble(a_v8Value->GetDoubleValue());
+            // No Set in the context, compare with every ancestor
+            return std::any_of(a_stack.cbegin(), a_stack.cend(), [&](const Frame& a_frame) {
+                return a_frame.v8Value->IsSame(a_v8Value);
+            });
         }
-        else if (a_v8Value->IsNull())
+
+        for (; m_addedCount < a_stack.size(); ++m_addedCount)
         {
-            result->SetNull();
+            Call(m_addFunc, a_stack[m_addedCount].v8Value);
         }
-        else if (a_v8Value->IsString() || a_v8Value->IsDate())
+
+        return Call(m_hasFunc, a_v8Value);
+    }
+
+    void CEFValueConverter::AncestorSet::OnPop(size_t a_stackSize, const CefRefPtr<CefV8Value>& a_v8Value)
+    {
+        if (m_addedCount > a_stackSize)
         {
-            result->SetString(a_v8Value->GetStringValue());
+            Call(m_deleteFunc, a_v8Value);
+            m_addedCount = a_stackSize;
         }
-        else if (a_v8Value->IsArray())
+    }
+
+    bool CEFValueConverter::IsAncestor(const std::vector<Frame>& a_stack,
+                                       const std::unordered_map<std::uint64_t, std::uint32_t>& a_ancestorKeys,
+                                       std::uint64_t a_refKey,
+                                       const CefRefPtr<CefV8Value>& a_v8Value,
+                                       AncestorSet& a_ancestorSet)
+    {
+        // Only a container of the same kind and size as an ancestor can be one, other containers never touch the set
+        const auto keyIt = a_ancestorKeys.find(a_refKey);
+        if (keyIt == a_ancestorKeys.cend() || keyIt->second == 0)
+        {
+            return false;
+        }
+
+        return a_ancestorSet.Contains(a_stack, a_v8Value);
+    }
+
+    bool CEFValueConverter::CheckLimits(const ConvertState& a_state, std::uint32_t a_depth, CefString& a_exception)
+    {
+        if (a_depth > s_limits.maxDepth)
+        {
+            a_exception = fmt::format("{}: argument nesting depth exceeds the limit of {}", NameOf(CEFValueConverter::ConvertValue), s_limits.maxDepth);
+            return false;
+        }
+
+        if (a_state.nodeCount > s_limits.maxNodeCount)
+        {
+            a_exception = fmt::format("{}: argument value count exceeds the limit of {}", NameOf(CEFValueConverter::ConvertValue), s_limits.maxNodeCount);
+            return false;
+        }
+
+        if (a_state.byteSize > s_limits.maxByteSize)
+        {
+            a_exception = fmt::format("{}: argument size exceeds the limit of {} bytes", NameOf(CEFValueConverter::ConvertValue), s_limits.maxByteSize);
+            return false;
+        }
+
+        return true;
+    }
+
+    void CEFValueConverter::SetLimits(const Limits& a_limits)
+    {
+        s_limits = a_limits;
+    }
+
+    const CEFValueConverter::Limits& CEFValueConverter::GetLimits()
+    {
+        return s_limits;
+    }
+
+    void CEFValueConverter::InitLimits(CefRefPtr<CefCommandLine> a_commandLine)
+    {
+        if (a_commandLine == nullptr)
         {
-            auto list = CefListValue::Create();
+            return;
+        }
 
-            a_objectRefs.push_back(a_v8Value);
-            for (int i = 0; i < a_v8Value->GetArrayLength(); ++i)
+        auto limits = s_limits;
+        try
+        {
+            if (a_commandLine->HasSwitch(IPC_CL_JS_ARGS_MAX_DEPTH_NAME))
             {
-                list->SetValue(i, ConvertValue(a_v8Value->GetValue(i), a_objectRefs, a_warnMap, a_exception));
+                limits.maxDepth = static_cast<std::uint32_t>(std::stoul(a_commandLine->GetSwitchValue(IPC_CL_JS_ARGS_MAX_DEPTH_NAME).ToString()));
             }
-            a_objectRefs.pop_back();
 
-            result->SetList(list);
+            if (a_commandLine->HasSwitch(IPC_CL_JS_ARGS_MAX_NODES_NAME))
+            {
+                limits.maxNodeCount = static_cast<std::uint32_t>(std::stoul(a_commandLine->GetSwitchValue(IPC_CL_JS_ARGS_MAX_NODES_NAME).ToString()));
+            }
+
+            if (a_commandLine->HasSwitch(IPC_CL_JS_ARGS_MAX_BYTES_NAME))
+            {
+                limits.maxByteSize = static_cast<std::size_t>(std::stoull(a_commandLine->GetSwitchValue(IPC_CL_JS_ARGS_MAX_BYTES_NAME).ToString()));
+            }
         }
-        else if (a_v8Value->IsObject())
+        catch (const std::exception& e)
         {
-            auto dict = CefDictionaryValue::Create();
-            CefDictionaryValue::KeyList keys;
-            a_v8Value->GetKeys(keys);
+            spdlog::error("{}: invalid limit switch value, {}", NameOf(CEFValueConverter::InitLimits), e.what());
+            return;
+        }
+
+        SetLimits(limits);
+    }
+
+    CefRefPtr<CefValue> CEFValueConverter::ConvertValue(const CefRefPtr<CefV8Value>& a_v8Value,
+                                                        ConvertState& a_state,
+                                                        CefString& a_exception)
+    {
+        auto result = CefValue::Create();
+
+        ++a_state.nodeCount;
+        if (SetLeafValue(a_v8Value, a_state, result))
+        {
+            return CheckLimits(a_state, 0, a_exception) ? result : nullptr;
+        }
+
+        std::vector<Frame> stack;
+        std::unordered_map<std::uint64_t, std::uint32_t> ancestorKeys;
+        AncestorSet ancestorSet;
+
+        const auto pushFrame = [&](const CefRefPtr<CefV8Value>& a_value, std::vector<CefString>&& a_keys, std::uint64_t a_refKey) {
+            auto& frame = stack.emplace_back();
+            frame.v8Value = a_value;
+            frame.refKey = a_refKey;
+            if (a_value->IsArray())
+            {
+                frame.size = a_value->GetArrayLength();
+                frame.list = CefListValue::Create();
+                frame.list->SetSize(frame.size);
+            }
+            else
+            {
+                frame.keys = std::move(a_keys);
+                frame.size = static_cast<int>(frame.keys.size());
+                frame.dictionary = CefDictionaryValue::Create();
+            }
+            ++ancestorKeys[a_refKey];
+        };
+
+        const auto getRefKey = [](const CefRefPtr<CefV8Value>& a_value, std::vector<CefString>& a_outKeys) {
+            if (a_value->IsArray())
+            {
+                return GetRefKey(true, a_value->GetArrayLength());
+            }
+
+            a_value->GetKeys(a_outKeys);
+            return GetRefKey(false, static_cast<int>(a_outKeys.size()));
+        };
+
+        std::vector<CefString> rootKeys;
+        const auto rootRefKey = getRefKey(a_v8Value, rootKeys);
+        pushFrame(a_v8Value, std::move(rootKeys), rootRefKey);
+
+        while (!stack.empty())
+        {
+            auto& frame = stack.back();
+            if (frame.index >= frame.size)
+            {
+                --ancestorKeys[frame.refKey];
+                auto list = std::move(frame.list);
+                auto dictionary = std::move(frame.dictionary);
+                const auto v8Value = std::move(frame.v8Value);
+                stack.pop_back();
+                ancestorSet.OnPop(stack.size(), v8Value);
+
+                // Containers are attached after they are filled: CEF takes the ownership and invalidates the reference
+                if (stack.empty())
+                {
+                    list != nullptr ? result->SetList(list) : result->SetDictionary(dictionary);
+                    break;
+                }
+
+                auto& parent = stack.back();
+                if (parent.list != nullptr)
+                {
+                    list != nullptr ? parent.list->SetList(parent.index, list) : parent.list->SetDictionary(parent.index, dictionary);
+                }
+                else
+                {
+                    const auto& key = parent.keys[parent.index];
+                    list != nullptr ? parent.dictionary->SetList(key, list) : parent.dictionary->SetDictionary(key, dictionary);
+                }
+                ++parent.index;
+                continue;
+            }
+
+            ++a_state.nodeCount;
+            CefRefPtr<CefV8Value> child;
+            bool isLeaf;
+            if (frame.list != nullptr)
+            {
+                child = frame.v8Value->GetValue(frame.index);
+                isLeaf = SetLeafValue(child, a_state, frame.list, static_cast<size_t>(frame.index));
+            }
+            else
+            {
+                const auto& key = frame.keys[frame.index];
+                a_state.byteSize += key.length();
+                child = frame.v8Value->GetValue(key);
+                isLeaf = SetLeafValue(child, a_state, frame.dictionary, key);
+            }
+
+            const auto depth = static_cast<std::uint32_t>(stack.size());
+            if (!CheckLimits(a_state, isLeaf ? depth : depth + 1, a_exception))
+            {
+                return nullptr;
+            }
+
+            if (isLeaf)
+            {
+                ++frame.index;
+                continue;
+            }
 
-            a_objectRefs.push_back(a_v8Value);
-            for (const auto& key : keys)
+            std::vector<CefString> childKeys;
+            const auto childRefKey = getRefKey(child, childKeys);
+            if (IsAncestor(stack, ancestorKeys, childRefKey, child, ancestorSet))
             {
-                dict->SetValue(key, ConvertValue(a_v8Value->GetValue(key), a_objectRefs, a_warnMap, a_exception));
+                a_exception = fmt::format("{}: trying to serialize circular reference", NameOf(CEFValueConverter::ConvertValue));
+                frame.list != nullptr ? frame.list->SetNull(frame.index) : frame.dictionary->SetNull(frame.keys[frame.index]);
+                ++frame.index;
+                continue;
             }
-            a_objectRefs.pop_back();
 
-            result->SetDictionary(dict);
+            // frame reference is invalidated here
+            pushFrame(child, std::move(childKeys), childRefKey);
         }
 
         return result;
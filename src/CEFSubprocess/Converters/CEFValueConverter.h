@@ -22,9 +22,91 @@ namespace NL::Converters
         static CefRefPtr<CefV8Value> to_v8object(CefRefPtr<CefDictionaryValue> const& dictionary);
 
     public:
+        struct Limits
+        {
+            std::uint32_t maxDepth = 128;
+            std::uint32_t maxNodeCount = 1000000;
+            // Approximate size: string, key and binary lengths, 8 bytes for other values
+            std::size_t maxByteSize = 32 * 1024 * 1024;
+        };
+
+        /// <summary>
+        /// Shared by all arguments of one function call, limits apply to the whole call
+        /// </summary>
+        struct ConvertState
+        {
+            std::unordered_map<std::string, std::uint32_t> warnMap;
+            std::uint32_t nodeCount = 0;
+            std::size_t byteSize = 0;
+            // ArrayBuffer.isView of the current context, looked up on the first object of the call
+            CefRefPtr<CefV8Value> isViewFunc = nullptr;
+            bool isViewFuncResolved = false;
+        };
+
+    private:
+        struct Frame
+        {
+            CefRefPtr<CefV8Value> v8Value = nullptr;
+            CefRefPtr<CefListValue> list = nullptr;
+            CefRefPtr<CefDictionaryValue> dictionary = nullptr;
+            std::vector<CefString> keys;
+            int index = 0;
+            int size = 0;
+            std::uint64_t refKey = 0;
+        };
+
+        /// <summary>
+        /// Identity set of the containers on the conversion stack. The CEF API has no V8 identity hash, so it is a JS Set.
+        /// It is created on the first container whose kind and size match an ancestor, stack frames are added to it on demand
+        /// </summary>
+        class AncestorSet
+        {
+          protected:
+            CefRefPtr<CefV8Value> m_set = nullptr;
+            CefRefPtr<CefV8Value> m_hasFunc = nullptr;
+            CefRefPtr<CefV8Value> m_addFunc = nullptr;
+            CefRefPtr<CefV8Value> m_deleteFunc = nullptr;
+            bool m_isCreated = false;
+            // Frames [0, m_addedCount) of the stack are in the set
+            size_t m_addedCount = 0;
+
+            void Create();
+            bool Call(const CefRefPtr<CefV8Value>& a_func, const CefRefPtr<CefV8Value>& a_value);
+
+          public:
+            bool Contains(const std::vector<Frame>& a_stack, const CefRefPtr<CefV8Value>& a_v8Value);
+            /// <summary>
+            /// Call after a frame is popped, a_stackSize is the new size
+            /// </summary>
+            void OnPop(size_t a_stackSize, const CefRefPtr<CefV8Value>& a_v8Value);
+        };
+
+        static Limits s_limits;
+
+        static std::uint64_t GetRefKey(bool a_isArray, int a_size);
+        static bool IsAncestor(const std::vector<Frame>& a_stack,
+                               const std::unordered_map<std::uint64_t, std::uint32_t>& a_ancestorKeys,
+                               std::uint64_t a_refKey,
+                               const CefRefPtr<CefV8Value>& a_v8Value,
+                               AncestorSet& a_ancestorSet);
+        static bool CheckLimits(const ConvertState& a_state, std::uint32_t a_depth, CefString& a_exception);
+
+    public:
+        static void SetLimits(const Limits& a_limits);
+        static const Limits& GetLimits();
+        /// <summary>
+        /// Reads optional limit overrides from the process command line
+        /// </summary>
+        static void InitLimits(CefRefPtr<CefCommandLine> a_commandLine);
+
+        /// <summary>
+        /// Converts the value without recursion.
+        /// Top-level ArrayBuffers, typed arrays and DataViews become binary values with the viewed bytes, empty and nested ones become null.
+        /// Circular references are replaced with null and reported through a_exception.
+        /// Returns nullptr if a limit is exceeded, the call must not be sent in this case
+        /// </summary>
         static CefRefPtr<CefValue> ConvertValue(const CefRefPtr<CefV8Value>& a_v8Value,
-                                                std::vector<CefRefPtr<CefV8Value>>& a_objectRefs,
-                                                std::unordered_map<std::string, std::uint32_t>& a_warnMap,
+                                                ConvertState& a_state,
                                                 CefString& a_exception);
     };
 }
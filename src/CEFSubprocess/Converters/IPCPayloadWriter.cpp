@@ -0,0 +1,110 @@
+#include "IPCPayloadWriter.h"
+
+namespace NL::Converters
+{
+    template <class TOut>
+    void IPCPayloadWriter::WriteUTF8String(TOut& a_out, const CefString& a_value)
+    {
+        const auto size = NL::IPC::GetUTF8Size(a_value);
+        NL::IPC::WriteRaw(a_out, static_cast<std::uint32_t>(size));
+        if (const auto memory = a_out.Allocate(size); memory != nullptr)
+        {
+            NL::IPC::WriteUTF8(a_value, memory);
+        }
+    }
+
+    template <class TOut, class TContainer, class TKey>
+    void IPCPayloadWriter::WriteItem(TOut& a_out, const CefRefPtr<TContainer>& a_container, const TKey& a_key)
+    {
+        switch (a_container->GetType(a_key))
+        {
+        case CefValueType::VTYPE_NULL:
+            NL::IPC::WriteTag(a_out, NL::IPC::PayloadTag::Null);
+            break;
+        case CefValueType::VTYPE_BOOL:
+            NL::IPC::WriteTag(a_out, NL::IPC::PayloadTag::Bool);
+            NL::IPC::WriteRaw(a_out, static_cast<std::uint8_t>(a_container->GetBool(a_key)));
+            break;
+        case CefValueType::VTYPE_INT:
+            NL::IPC::WriteTag(a_out, NL::IPC::PayloadTag::Int);
+            NL::IPC::WriteRaw(a_out, static_cast<std::int32_t>(a_container->GetInt(a_key)));
+            break;
+        case CefValueType::VTYPE_DOUBLE:
+            NL::IPC::WriteTag(a_out, NL::IPC::PayloadTag::Double);
+            NL::IPC::WriteRaw(a_out, a_container->GetDouble(a_key));
+            break;
+        case CefValueType::VTYPE_STRING:
+            NL::IPC::WriteTag(a_out, NL::IPC::PayloadTag::String);
+            WriteUTF8String(a_out, a_container->GetString(a_key));
+            break;
+        case CefValueType::VTYPE_BINARY: {
+            const auto binary = a_container->GetBinary(a_key);
+            NL::IPC::WriteTag(a_out, NL::IPC::PayloadTag::Binary);
+            NL::IPC::WriteString(a_out, std::string_view(static_cast<const char*>(binary->GetRawData()), binary->GetSize()));
+            break;
+        }
+        case CefValueType::VTYPE_LIST:
+            WriteList(a_out, a_container->GetList(a_key));
+            break;
+        case CefValueType::VTYPE_DICTIONARY:
+            WriteDictionary(a_out, a_container->GetDictionary(a_key));
+            break;
+        default:
+            NL::IPC::WriteTag(a_out, NL::IPC::PayloadTag::Invalid);
+            break;
+        }
+    }
+
+    template <class TOut>
+    void IPCPayloadWriter::WriteList(TOut& a_out, const CefRefPtr<CefListValue>& a_value)
+    {
+        NL::IPC::WriteTag(a_out, NL::IPC::PayloadTag::List);
+        NL::IPC::WriteRaw(a_out, static_cast<std::uint32_t>(a_value->GetSize()));
+        for (size_t i = 0; i < a_value->GetSize(); ++i)
+        {
+            WriteItem(a_out, a_value, i);
+        }
+    }
+
+    template <class TOut>
+    void IPCPayloadWriter::WriteDictionary(TOut& a_out, const CefRefPtr<CefDictionaryValue>& a_value)
+    {
+        CefDictionaryValue::KeyList keys;
+        a_value->GetKeys(keys);
+
+        std::vector<std::pair<std::string, size_t>> sortedKeys;
+        sortedKeys.reserve(keys.size());
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            sortedKeys.emplace_back(keys[i].ToString(), i);
+        }
+        std::sort(sortedKeys.begin(), sortedKeys.end());
+
+        NL::IPC::WriteTag(a_out, NL::IPC::PayloadTag::Dictionary);
+        NL::IPC::WriteRaw(a_out, static_cast<std::uint32_t>(sortedKeys.size()));
+        for (const auto& [keyString, keyIdx] : sortedKeys)
+        {
+            NL::IPC::WriteString(a_out, keyString);
+            WriteItem(a_out, a_value, keys[keyIdx]);
+        }
+    }
+
+    template <class TOut>
+    void IPCPayloadWriter::WriteCall(TOut& a_out,
+                                     std::uint32_t a_funcId,
+                                     std::uint32_t a_asyncCallId,
+                                     const CefRefPtr<CefListValue>& a_args)
+    {
+        NL::IPC::WriteRaw(a_out, a_funcId);
+        NL::IPC::WriteRaw(a_out, a_asyncCallId);
+        NL::IPC::WriteRaw(a_out, static_cast<std::uint32_t>(a_args->GetSize()));
+        for (size_t i = 0; i < a_args->GetSize(); ++i)
+        {
+            WriteItem(a_out, a_args, i);
+        }
+    }
+
+    template void IPCPayloadWriter::WriteCall(NL::IPC::PayloadSizeCounter&, std::uint32_t, std::uint32_t, const CefRefPtr<CefListValue>&);
+    template void IPCPayloadWriter::WriteCall(NL::IPC::PayloadMemoryWriter&, std::uint32_t, std::uint32_t, const CefRefPtr<CefListValue>&);
+    template void IPCPayloadWriter::WriteCall(NL::IPC::PayloadStringWriter&, std::uint32_t, std::uint32_t, const CefRefPtr<CefListValue>&);
+}
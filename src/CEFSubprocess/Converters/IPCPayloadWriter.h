@@ -0,0 +1,34 @@
+#pragma once
+
+#include "PCH.h"
+#include "IPCSharedPayload.h"
+
+namespace NL::Converters
+{
+    /// <summary>
+    /// Encodes converted JS call arguments into the shared memory call payload (see IPCSharedPayload.h).
+    /// TOut is NL::IPC::PayloadSizeCounter, PayloadMemoryWriter or PayloadStringWriter
+    /// </summary>
+    class IPCPayloadWriter final
+    {
+      private:
+        template <class TOut>
+        static void WriteUTF8String(TOut& a_out, const CefString& a_value);
+        template <class TOut, class TContainer, class TKey>
+        static void WriteItem(TOut& a_out, const CefRefPtr<TContainer>& a_container, const TKey& a_key);
+
+      public:
+        template <class TOut>
+        static void WriteList(TOut& a_out, const CefRefPtr<CefListValue>& a_value);
+        template <class TOut>
+        static void WriteDictionary(TOut& a_out, const CefRefPtr<CefDictionaryValue>& a_value);
+        /// <summary>
+        /// a_asyncCallId is 0 for functions without a result
+        /// </summary>
+        template <class TOut>
+        static void WriteCall(TOut& a_out,
+                              std::uint32_t a_funcId,
+                              std::uint32_t a_asyncCallId,
+                              const CefRefPtr<CefListValue>& a_args);
+    };
+}
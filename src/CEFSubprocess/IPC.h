@@ -1,7 +1,12 @@
 #define IPC_CL_PROCESS_ID_NAME "main-process-id"
 #define IPC_CL_LOG_DIRECTORY_NAME "log-directory"
+#define IPC_CL_JS_ARGS_MAX_DEPTH_NAME "js-args-max-depth"
+#define IPC_CL_JS_ARGS_MAX_NODES_NAME "js-args-max-nodes"
+#define IPC_CL_JS_ARGS_MAX_BYTES_NAME "js-args-max-bytes"
+#define IPC_CL_JS_ASYNC_TIMEOUT_NAME "js-async-timeout-ms"
 
-#define IPC_LOG_EVENT "log-event"
+// Announces the log ring of a renderer process: [mapping name, process id]
+#define IPC_LOG_RING_EVENT "log-ring"
 
 #define IPC_JS_WINDOW_OBJECT_NAME "window"
 #define IPC_JS_CONTEXT_CREATED "js-context-created"
@@ -9,4 +14,29 @@
 #define IPC_JS_FUNCION_ADD_EVENT "2"
 #define IPC_JS_FUNCTION_REMOVE_EVENT "3"
 #define IPC_JS_EVENT_FUNCTION_ADD_NAME "IPC_JS_EVENT_FUNCTION_ADD_NAME"
+// Function registry in the browser extra info, same layout as the IPC_JS_FUNCION_ADD_EVENT arguments
+#define IPC_JS_FUNCTION_REGISTRY_NAME "IPC_JS_FUNCTION_REGISTRY_NAME"
 #define IPC_JS_EVENT_FUNCTION_CALL_EVENT "5"
+#define IPC_JS_FUNCTION_CALL_SHARED_EVENT "6"
+#define IPC_JS_EVENT_FUNCTION_CALL_SHARED_EVENT "7"
+#define IPC_JS_EVENT_FUNCTION_BATCH_EVENT "8"
+#define IPC_JS_FUNCTION_CALL_BATCH_EVENT "9"
+#define IPC_JS_ASYNC_RESULT_EVENT "10"
+#define IPC_JS_EVENT_SCHEMA_EVENT "11"
+#define IPC_JS_EVENT_PACKED_EVENT "12"
+#define IPC_JS_SCRIPT_REGISTER_EVENT "13"
+#define IPC_JS_SCRIPT_CALL_EVENT "14"
+#define IPC_JS_PRELOAD_BATCH_EVENT "15"
+#define IPC_METRICS_EVENT "16"
+#define IPC_JS_EVENT_BINARY_EVENT "17"
+#define IPC_JS_STATE_REGISTER_EVENT "18"
+// Functions of the live page stay bound, the renderer removes them before it binds the next main context: [registry revision]
+#define IPC_JS_FUNCTION_CLEAR_EVENT "19"
+
+#define IPC_JS_ASYNC_RESULT_JSON 0
+#define IPC_JS_ASYNC_RESULT_BINARY 1
+#define IPC_JS_ASYNC_RESULT_ERROR 2
+
+// Arguments of IPC_JS_FUNCION_ADD_EVENT after the function dictionaries
+#define IPC_JS_FUNCTION_ADD_REVISION_INDEX 5
+#define IPC_JS_FUNCTION_ADD_REPLACE_INDEX 6
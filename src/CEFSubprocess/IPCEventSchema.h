@@ -0,0 +1,95 @@
+#pragma once
+
+#include "IPCSharedPayload.h"
+
+namespace NL::IPC
+{
+    /// <summary>
+    /// Layout of a positional event payload: values in field order without names and padding.
+    /// Sent once per event as [name, type, name, type, ...], offsets are computed on both sides
+    /// </summary>
+    struct EventSchema
+    {
+        struct Field
+        {
+            std::string name;
+            EventFieldType type = EventFieldType::Double;
+            std::uint32_t offset = 0;
+        };
+
+        std::vector<Field> fields;
+        std::uint32_t packedSize = 0;
+
+        bool AddField(std::string_view a_name, std::uint8_t a_type)
+        {
+            if (a_name.empty() || a_type > static_cast<std::uint8_t>(EventFieldType::Bool))
+            {
+                return false;
+            }
+
+            const auto type = static_cast<EventFieldType>(a_type);
+            fields.push_back({std::string(a_name), type, packedSize});
+            packedSize += GetEventFieldSize(type);
+            return true;
+        }
+
+        CefRefPtr<CefListValue> ToCefList() const
+        {
+            auto list = CefListValue::Create();
+            list->SetSize(fields.size() * 2);
+            for (size_t i = 0; i < fields.size(); ++i)
+            {
+                list->SetString(i * 2, fields[i].name);
+                list->SetInt(i * 2 + 1, static_cast<int>(fields[i].type));
+            }
+            return list;
+        }
+
+        static bool FromCefList(const CefRefPtr<CefListValue>& a_list, EventSchema& a_outSchema)
+        {
+            a_outSchema = {};
+            if (a_list == nullptr || a_list->GetSize() % 2 != 0)
+            {
+                return false;
+            }
+
+            for (size_t i = 0; i < a_list->GetSize(); i += 2)
+            {
+                if (a_list->GetType(i) != VTYPE_STRING || a_list->GetType(i + 1) != VTYPE_INT ||
+                    !a_outSchema.AddField(a_list->GetString(i).ToString(), static_cast<std::uint8_t>(a_list->GetInt(i + 1))))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /// <summary>
+        /// Missing values are written as 0
+        /// </summary>
+        void Encode(const double* a_values, std::uint32_t a_valueCount, std::string& a_out) const
+        {
+            a_out.reserve(a_out.size() + packedSize);
+            for (size_t i = 0; i < fields.size(); ++i)
+            {
+                const auto value = a_values != nullptr && i < a_valueCount ? a_values[i] : 0.0;
+                switch (fields[i].type)
+                {
+                case EventFieldType::Int32:
+                    AppendRaw(a_out, ToInt32(value));
+                    break;
+                case EventFieldType::Float:
+                    AppendRaw(a_out, static_cast<float>(value));
+                    break;
+                case EventFieldType::Double:
+                    AppendRaw(a_out, value);
+                    break;
+                case EventFieldType::Bool:
+                default:
+                    AppendRaw(a_out, static_cast<std::uint8_t>(value != 0.0));
+                    break;
+                }
+            }
+        }
+    };
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace NL::IPC
+{
+    /// <summary>
+    /// Field types of positional event payloads and state blocks, values match NL::JS::JSEventFieldType
+    /// </summary>
+    enum class EventFieldType : std::uint8_t
+    {
+        Int32 = 0,
+        Float,
+        Double,
+        Bool,
+    };
+
+    inline std::uint32_t GetEventFieldSize(EventFieldType a_type)
+    {
+        switch (a_type)
+        {
+        case EventFieldType::Int32:
+        case EventFieldType::Float:
+            return 4;
+        case EventFieldType::Double:
+            return 8;
+        case EventFieldType::Bool:
+        default:
+            return 1;
+        }
+    }
+
+    /// <summary>
+    /// Saturating conversion, NaN becomes 0
+    /// </summary>
+    inline std::int32_t ToInt32(double a_value)
+    {
+        return std::isnan(a_value) ? 0 : static_cast<std::int32_t>(std::clamp(a_value, -2147483648.0, 2147483647.0));
+    }
+}
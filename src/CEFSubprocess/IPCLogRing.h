@@ -0,0 +1,209 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace NL::IPC
+{
+    /// <summary>
+    /// Ring of log records in memory shared between processes: [header][data], records are [u32 size][u8 level][message] and can wrap.
+    /// One writer and one reader. Positions only grow, the writer publishes a record with a release store of the write position
+    /// and the reader frees it with a release store of the read position. Records that don't fit are dropped and counted
+    /// </summary>
+    class LogRing
+    {
+      public:
+        static constexpr std::uint32_t DEFAULT_CAPACITY = 256 * 1024;
+        // Longer messages are truncated
+        static constexpr std::uint32_t MAX_MESSAGE_SIZE = 4096;
+        static constexpr std::uint32_t RECORD_HEADER_SIZE = sizeof(std::uint32_t) + sizeof(std::uint8_t);
+
+      protected:
+        // Positions are in separate cache lines, each one is written by one side only
+        struct Header
+        {
+            alignas(64) std::uint64_t writePos;
+            std::uint32_t capacity;
+            std::uint32_t droppedCount;
+            alignas(64) std::uint64_t readPos;
+        };
+
+      public:
+        static constexpr size_t HEADER_SIZE = sizeof(Header);
+
+      protected:
+        static_assert(std::atomic_ref<std::uint32_t>::is_always_lock_free && std::atomic_ref<std::uint64_t>::is_always_lock_free,
+                      "lock free atomics are required in shared memory");
+
+        Header* m_header = nullptr;
+        char* m_data = nullptr;
+        std::uint32_t m_capacity = 0;
+
+        static bool IsValidCapacity(std::uint32_t a_capacity)
+        {
+            return a_capacity >= RECORD_HEADER_SIZE + MAX_MESSAGE_SIZE && (a_capacity & (a_capacity - 1)) == 0;
+        }
+
+        static std::uint64_t Load(std::uint64_t& a_value, std::memory_order a_order)
+        {
+            return std::atomic_ref<std::uint64_t>(a_value).load(a_order);
+        }
+
+        static void Store(std::uint64_t& a_value, std::uint64_t a_newValue)
+        {
+            std::atomic_ref<std::uint64_t>(a_value).store(a_newValue, std::memory_order_release);
+        }
+
+        void CopyIn(std::uint64_t a_pos, const void* a_source, std::uint32_t a_size)
+        {
+            const auto offset = static_cast<std::uint32_t>(a_pos & (m_capacity - 1));
+            const auto firstSize = std::min(a_size, m_capacity - offset);
+            std::memcpy(m_data + offset, a_source, firstSize);
+            std::memcpy(m_data, static_cast<const char*>(a_source) + firstSize, a_size - firstSize);
+        }
+
+        void CopyOut(std::uint64_t a_pos, void* a_destination, std::uint32_t a_size) const
+        {
+            const auto offset = static_cast<std::uint32_t>(a_pos & (m_capacity - 1));
+            const auto firstSize = std::min(a_size, m_capacity - offset);
+            std::memcpy(a_destination, m_data + offset, firstSize);
+            std::memcpy(static_cast<char*>(a_destination) + firstSize, m_data, a_size - firstSize);
+        }
+
+      public:
+        static size_t GetMappingSize(std::uint32_t a_capacity)
+        {
+            return HEADER_SIZE + a_capacity;
+        }
+
+        /// <summary>
+        /// Creator side, resets the ring. a_capacity must be a power of two, a_memory 64 byte aligned
+        /// </summary>
+        bool Initialize(void* a_memory, size_t a_size, std::uint32_t a_capacity)
+        {
+            *this = {};
+            if (a_memory == nullptr || reinterpret_cast<std::uintptr_t>(a_memory) % alignof(Header) != 0 || !IsValidCapacity(a_capacity) ||
+                a_size < GetMappingSize(a_capacity))
+            {
+                return false;
+            }
+
+            std::memset(a_memory, 0, HEADER_SIZE);
+            m_header = static_cast<Header*>(a_memory);
+            m_header->capacity = a_capacity;
+            m_data = static_cast<char*>(a_memory) + HEADER_SIZE;
+            m_capacity = a_capacity;
+            return true;
+        }
+
+        /// <summary>
+        /// Other side, takes the capacity from the header
+        /// </summary>
+        bool Attach(void* a_memory, size_t a_size)
+        {
+            *this = {};
+            if (a_memory == nullptr || reinterpret_cast<std::uintptr_t>(a_memory) % alignof(Header) != 0 || a_size < HEADER_SIZE)
+            {
+                return false;
+            }
+
+            const auto header = static_cast<Header*>(a_memory);
+            if (!IsValidCapacity(header->capacity) || a_size < GetMappingSize(header->capacity))
+            {
+                return false;
+            }
+
+            m_header = header;
+            m_data = static_cast<char*>(a_memory) + HEADER_SIZE;
+            m_capacity = header->capacity;
+            return true;
+        }
+
+        bool IsValid() const
+        {
+            return m_header != nullptr;
+        }
+
+        std::uint32_t GetCapacity() const
+        {
+            return m_capacity;
+        }
+
+        /// <summary>
+        /// Writer side, never blocks. Returns false if the record was dropped because the ring is full
+        /// </summary>
+        bool Write(std::uint8_t a_level, std::string_view a_message)
+        {
+            if (!IsValid())
+            {
+                return false;
+            }
+
+            const auto messageSize = static_cast<std::uint32_t>(std::min<size_t>(a_message.size(), MAX_MESSAGE_SIZE));
+            const auto recordSize = RECORD_HEADER_SIZE + messageSize;
+            const auto writePos = Load(m_header->writePos, std::memory_order_relaxed);
+            // Acquire, the reader is done with the records before this position
+            const auto readPos = Load(m_header->readPos, std::memory_order_acquire);
+            if (writePos - readPos > m_capacity - recordSize)
+            {
+                std::atomic_ref<std::uint32_t>(m_header->droppedCount).fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            CopyIn(writePos, &messageSize, sizeof(messageSize));
+            CopyIn(writePos + sizeof(messageSize), &a_level, sizeof(a_level));
+            CopyIn(writePos + RECORD_HEADER_SIZE, a_message.data(), messageSize);
+            Store(m_header->writePos, writePos + recordSize);
+            return true;
+        }
+
+        /// <summary>
+        /// Reader side. Returns false if the ring is empty, a malformed record discards everything written so far
+        /// </summary>
+        bool Read(std::uint8_t& a_outLevel, std::string& a_outMessage)
+        {
+            if (!IsValid())
+            {
+                return false;
+            }
+
+            const auto readPos = Load(m_header->readPos, std::memory_order_relaxed);
+            const auto writePos = Load(m_header->writePos, std::memory_order_acquire);
+            const auto available = writePos - readPos;
+            if (available == 0)
+            {
+                return false;
+            }
+
+            std::uint32_t messageSize = 0;
+            if (available >= RECORD_HEADER_SIZE && available <= m_capacity)
+            {
+                CopyOut(readPos, &messageSize, sizeof(messageSize));
+            }
+
+            if (available < RECORD_HEADER_SIZE || available > m_capacity || messageSize > MAX_MESSAGE_SIZE || messageSize > available - RECORD_HEADER_SIZE)
+            {
+                Store(m_header->readPos, writePos);
+                return false;
+            }
+
+            CopyOut(readPos + sizeof(messageSize), &a_outLevel, sizeof(a_outLevel));
+            a_outMessage.resize(messageSize);
+            CopyOut(readPos + RECORD_HEADER_SIZE, a_outMessage.data(), messageSize);
+            Store(m_header->readPos, readPos + RECORD_HEADER_SIZE + messageSize);
+            return true;
+        }
+
+        /// <summary>
+        /// Reader side, count of records dropped since the last call
+        /// </summary>
+        std::uint32_t TakeDroppedCount()
+        {
+            return IsValid() ? std::atomic_ref<std::uint32_t>(m_header->droppedCount).exchange(0, std::memory_order_relaxed) : 0;
+        }
+    };
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+namespace NL::IPC
+{
+    /// <summary>
+    /// Named shared memory that lives as long as one process keeps it open. The creator passes the name to the other process
+    /// </summary>
+    class SharedMapping final
+    {
+      private:
+        HANDLE m_handle = nullptr;
+        void* m_memory = nullptr;
+        size_t m_size = 0;
+
+        bool Map(DWORD a_access, size_t a_size)
+        {
+            m_memory = ::MapViewOfFile(m_handle, a_access, 0, 0, a_size);
+            if (m_memory == nullptr)
+            {
+                Close();
+                return false;
+            }
+
+            m_size = a_size;
+            return true;
+        }
+
+      public:
+        SharedMapping() = default;
+        SharedMapping(const SharedMapping&) = delete;
+        SharedMapping& operator=(const SharedMapping&) = delete;
+
+        SharedMapping(SharedMapping&& a_other) noexcept
+        {
+            *this = std::move(a_other);
+        }
+
+        SharedMapping& operator=(SharedMapping&& a_other) noexcept
+        {
+            if (this != &a_other)
+            {
+                Close();
+                m_handle = std::exchange(a_other.m_handle, nullptr);
+                m_memory = std::exchange(a_other.m_memory, nullptr);
+                m_size = std::exchange(a_other.m_size, 0);
+            }
+            return *this;
+        }
+
+        ~SharedMapping()
+        {
+            Close();
+        }
+
+        /// <summary>
+        /// Fails if a mapping with this name already exists
+        /// </summary>
+        bool Create(const std::string& a_name, size_t a_size)
+        {
+            Close();
+            const auto size = static_cast<std::uint64_t>(a_size);
+            m_handle = ::CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), a_name.c_str());
+            if (m_handle != nullptr && ::GetLastError() == ERROR_ALREADY_EXISTS)
+            {
+                Close();
+            }
+            return m_handle != nullptr && Map(FILE_MAP_ALL_ACCESS, a_size);
+        }
+
+        bool Open(const std::string& a_name, size_t a_size, bool a_isReadOnly)
+        {
+            Close();
+            const auto access = a_isReadOnly ? FILE_MAP_READ : FILE_MAP_ALL_ACCESS;
+            m_handle = ::OpenFileMappingA(access, FALSE, a_name.c_str());
+            return m_handle != nullptr && Map(access, a_size);
+        }
+
+        void Close()
+        {
+            if (m_memory != nullptr)
+            {
+                ::UnmapViewOfFile(m_memory);
+                m_memory = nullptr;
+            }
+            if (m_handle != nullptr)
+            {
+                ::CloseHandle(m_handle);
+                m_handle = nullptr;
+            }
+            m_size = 0;
+        }
+
+        bool IsValid() const
+        {
+            return m_memory != nullptr;
+        }
+
+        void* GetMemory() const
+        {
+            return m_memory;
+        }
+
+        size_t GetSize() const
+        {
+            return m_size;
+        }
+    };
+}
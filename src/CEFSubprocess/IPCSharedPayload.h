@@ -0,0 +1,391 @@
+#pragma once
+
+#include <include/cef_shared_process_message_builder.h>
+#include "IPCFieldType.h"
+
+// Payloads of this size and bigger are sent through a shared memory region instead of the argument list
+#define IPC_SHARED_PAYLOAD_THRESHOLD (64 * 1024)
+
+namespace NL::IPC
+{
+    /// <summary>
+    /// Value tags of the call payload: [u32 funcId][u32 asyncCallId][u32 argCount][tagged value]...
+    /// Strings and binary values are u32 length prefixed, dictionary keys are sorted byte-wise
+    /// </summary>
+    enum class PayloadTag : std::uint8_t
+    {
+        Invalid = 0,
+        Null,
+        Bool,
+        Int,
+        Double,
+        String,
+        List,
+        Dictionary,
+        // ArrayBuffer or typed array view bytes
+        Binary
+    };
+
+    inline void AppendTag(std::string& a_out, PayloadTag a_tag)
+    {
+        a_out += static_cast<char>(a_tag);
+    }
+
+    template <class T>
+    inline void AppendRaw(std::string& a_out, T a_value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        a_out.append(reinterpret_cast<const char*>(&a_value), sizeof(T));
+    }
+
+    inline void AppendString(std::string& a_out, std::string_view a_value)
+    {
+        AppendRaw(a_out, static_cast<std::uint32_t>(a_value.size()));
+        a_out.append(a_value);
+    }
+
+    /// <summary>
+    /// Payload outputs: PayloadSizeCounter only counts the bytes, so a payload can be sized first
+    /// and then written straight into its memory with PayloadMemoryWriter. Allocate() returns nullptr for the counter
+    /// </summary>
+    class PayloadSizeCounter
+    {
+      protected:
+        size_t m_size = 0;
+
+      public:
+        char* Allocate(size_t a_size)
+        {
+            m_size += a_size;
+            return nullptr;
+        }
+
+        void Write(const void* a_data, size_t a_size)
+        {
+            m_size += a_size;
+        }
+
+        size_t GetSize() const
+        {
+            return m_size;
+        }
+    };
+
+    class PayloadMemoryWriter
+    {
+      protected:
+        char* m_pos = nullptr;
+
+      public:
+        explicit PayloadMemoryWriter(void* a_memory)
+            : m_pos(static_cast<char*>(a_memory))
+        {
+        }
+
+        char* Allocate(size_t a_size)
+        {
+            const auto memory = m_pos;
+            m_pos += a_size;
+            return memory;
+        }
+
+        void Write(const void* a_data, size_t a_size)
+        {
+            std::memcpy(Allocate(a_size), a_data, a_size);
+        }
+    };
+
+    class PayloadStringWriter
+    {
+      protected:
+        std::string& m_out;
+
+      public:
+        explicit PayloadStringWriter(std::string& a_out)
+            : m_out(a_out)
+        {
+        }
+
+        char* Allocate(size_t a_size)
+        {
+            const auto offset = m_out.size();
+            m_out.resize(offset + a_size);
+            return m_out.data() + offset;
+        }
+
+        void Write(const void* a_data, size_t a_size)
+        {
+            m_out.append(static_cast<const char*>(a_data), a_size);
+        }
+    };
+
+    template <class TOut>
+    inline void WriteTag(TOut& a_out, PayloadTag a_tag)
+    {
+        const auto tag = static_cast<std::uint8_t>(a_tag);
+        a_out.Write(&tag, sizeof(tag));
+    }
+
+    template <class TOut, class T>
+    inline void WriteRaw(TOut& a_out, T a_value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        a_out.Write(&a_value, sizeof(T));
+    }
+
+    template <class TOut>
+    inline void WriteString(TOut& a_out, std::string_view a_value)
+    {
+        WriteRaw(a_out, static_cast<std::uint32_t>(a_value.size()));
+        a_out.Write(a_value.data(), a_value.size());
+    }
+
+    /// <summary>
+    /// Bounds checked reader, every read fails after the first error
+    /// </summary>
+    class PayloadReader
+    {
+      protected:
+        const char* m_data = nullptr;
+        size_t m_size = 0;
+        size_t m_pos = 0;
+        bool m_isFailed = false;
+
+      public:
+        PayloadReader(const void* a_data, size_t a_size)
+            : m_data(static_cast<const char*>(a_data)), m_size(a_data != nullptr ? a_size : 0)
+        {
+        }
+
+        bool IsFailed() const
+        {
+            return m_isFailed;
+        }
+
+        bool IsEnd() const
+        {
+            return m_pos == m_size;
+        }
+
+        template <class T>
+        bool ReadRaw(T& a_outValue)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            if (m_isFailed || m_size - m_pos < sizeof(T))
+            {
+                m_isFailed = true;
+                return false;
+            }
+
+            std::memcpy(&a_outValue, m_data + m_pos, sizeof(T));
+            m_pos += sizeof(T);
+            return true;
+        }
+
+        bool ReadTag(PayloadTag& a_outTag)
+        {
+            std::uint8_t tag = 0;
+            if (!ReadRaw(tag) || tag > static_cast<std::uint8_t>(PayloadTag::Binary))
+            {
+                m_isFailed = true;
+                return false;
+            }
+
+            a_outTag = static_cast<PayloadTag>(tag);
+            return true;
+        }
+
+        /// <summary>
+        /// Tag of the next value without reading it, Invalid at the end or after an error
+        /// </summary>
+        PayloadTag PeekTag() const
+        {
+            if (m_isFailed || m_pos >= m_size || static_cast<std::uint8_t>(m_data[m_pos]) > static_cast<std::uint8_t>(PayloadTag::Binary))
+            {
+                return PayloadTag::Invalid;
+            }
+
+            return static_cast<PayloadTag>(m_data[m_pos]);
+        }
+
+        /// <summary>
+        /// The view points into the payload memory
+        /// </summary>
+        bool ReadString(std::string_view& a_outValue)
+        {
+            std::uint32_t size = 0;
+            if (!ReadRaw(size) || m_size - m_pos < size)
+            {
+                m_isFailed = true;
+                return false;
+            }
+
+            a_outValue = std::string_view(m_data + m_pos, size);
+            m_pos += size;
+            return true;
+        }
+    };
+
+    /// <summary>
+    /// Only the region handle and its size travel in the message. Returns nullptr if the region can't be allocated
+    /// </summary>
+    inline CefRefPtr<CefProcessMessage> CreateSharedMessage(const CefString& a_name, const std::string& a_payload)
+    {
+        const auto builder = CefSharedProcessMessageBuilder::Create(a_name, a_payload.size());
+        if (builder == nullptr || !builder->IsValid())
+        {
+            return nullptr;
+        }
+
+        std::memcpy(builder->Memory(), a_payload.data(), a_payload.size());
+        return builder->Build();
+    }
+
+    /// <summary>
+    /// a_writePayload(auto& a_out) is called twice: with PayloadSizeCounter to size the region,
+    /// then with PayloadMemoryWriter to write straight into it. Returns nullptr if the region can't be allocated
+    /// </summary>
+    template <class TWrite>
+    inline CefRefPtr<CefProcessMessage> CreateSharedMessage(const CefString& a_name, TWrite&& a_writePayload)
+    {
+        PayloadSizeCounter sizeCounter;
+        a_writePayload(sizeCounter);
+
+        const auto builder = CefSharedProcessMessageBuilder::Create(a_name, sizeCounter.GetSize());
+        if (builder == nullptr || !builder->IsValid())
+        {
+            return nullptr;
+        }
+
+        PayloadMemoryWriter memoryWriter(builder->Memory());
+        a_writePayload(memoryWriter);
+        return builder->Build();
+    }
+
+    /// <summary>
+    /// Shared memory size, or the size of top-level binary and string arguments. Nested lists and dictionaries are not counted
+    /// </summary>
+    inline size_t GetMessageSize(const CefRefPtr<CefProcessMessage>& a_message)
+    {
+        if (const auto region = a_message->GetSharedMemoryRegion(); region != nullptr && region->IsValid())
+        {
+            return region->Size();
+        }
+
+        size_t size = 0;
+        const auto args = a_message->GetArgumentList();
+        for (size_t i = 0; args != nullptr && i < args->GetSize(); ++i)
+        {
+            switch (args->GetType(i))
+            {
+            case VTYPE_BINARY:
+                size += args->GetBinary(i)->GetSize();
+                break;
+            case VTYPE_STRING:
+                size += args->GetString(i).length();
+                break;
+            default:
+                break;
+            }
+        }
+        return size;
+    }
+
+    /// <summary>
+    /// UTF-8 size of a_value, same conversion as CefString::ToString() (a lone surrogate becomes U+FFFD)
+    /// </summary>
+    inline size_t GetUTF8Size(const CefString& a_value)
+    {
+        const auto data = a_value.c_str();
+        const auto length = a_value.length();
+        size_t size = 0;
+        for (size_t i = 0; i < length; ++i)
+        {
+            const auto unit = static_cast<std::uint32_t>(data[i]);
+            if (unit < 0x80)
+            {
+                size += 1;
+            }
+            else if (unit < 0x800)
+            {
+                size += 2;
+            }
+            else if (unit >= 0xD800 && unit <= 0xDBFF && i + 1 < length && static_cast<std::uint32_t>(data[i + 1]) >= 0xDC00 && static_cast<std::uint32_t>(data[i + 1]) <= 0xDFFF)
+            {
+                size += 4;
+                ++i;
+            }
+            else
+            {
+                size += 3;
+            }
+        }
+        return size;
+    }
+
+    /// <summary>
+    /// Writes GetUTF8Size(a_value) bytes to a_out, returns the end
+    /// </summary>
+    inline char* WriteUTF8(const CefString& a_value, char* a_out)
+    {
+        const auto data = a_value.c_str();
+        const auto length = a_value.length();
+        for (size_t i = 0; i < length; ++i)
+        {
+            auto codePoint = static_cast<std::uint32_t>(data[i]);
+            if (codePoint >= 0xD800 && codePoint <= 0xDFFF)
+            {
+                const auto next = i + 1 < length ? static_cast<std::uint32_t>(data[i + 1]) : 0;
+                if (codePoint <= 0xDBFF && next >= 0xDC00 && next <= 0xDFFF)
+                {
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (next - 0xDC00);
+                    ++i;
+                }
+                else
+                {
+                    codePoint = 0xFFFD;
+                }
+            }
+
+            if (codePoint < 0x80)
+            {
+                *a_out++ = static_cast<char>(codePoint);
+            }
+            else if (codePoint < 0x800)
+            {
+                *a_out++ = static_cast<char>(0xC0 | (codePoint >> 6));
+                *a_out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else if (codePoint < 0x10000)
+            {
+                *a_out++ = static_cast<char>(0xE0 | (codePoint >> 12));
+                *a_out++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                *a_out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else
+            {
+                *a_out++ = static_cast<char>(0xF0 | (codePoint >> 18));
+                *a_out++ = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+                *a_out++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                *a_out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+        }
+        return a_out;
+    }
+
+    /// <summary>
+    /// Replaces a_out with the UTF-8 of a_value, reuses its capacity unlike CefString::ToString()
+    /// </summary>
+    inline void AssignUTF8(std::string& a_out, const CefString& a_value)
+    {
+        a_out.resize(GetUTF8Size(a_value));
+        WriteUTF8(a_value, a_out.data());
+    }
+
+    inline CefString ToCefString(std::string_view a_utf8)
+    {
+        CefString result;
+        cef_string_utf8_to_utf16(a_utf8.data(), a_utf8.size(), result.GetWritableStruct());
+        return result;
+    }
+}
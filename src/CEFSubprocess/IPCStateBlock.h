@@ -0,0 +1,361 @@
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "IPCFieldType.h"
+
+namespace NL::IPC
+{
+    /// <summary>
+    /// Layout of a state block: fields in registration order, each aligned to its size so no field crosses an 8 byte word.
+    /// Sent as [u32 fieldCount]([u32 nameLength][name][u8 type])..., offsets are computed on both sides
+    /// </summary>
+    struct StateLayout
+    {
+        struct Field
+        {
+            std::string name;
+            EventFieldType type = EventFieldType::Double;
+            std::uint32_t offset = 0;
+        };
+
+        static constexpr std::uint32_t MAX_FIELD_COUNT = 4096;
+        static constexpr std::uint32_t MAX_NAME_SIZE = 256;
+
+        std::vector<Field> fields;
+        // Multiple of 8
+        std::uint32_t dataSize = 0;
+
+        bool AddField(std::string_view a_name, std::uint8_t a_type)
+        {
+            if (a_name.empty() || a_name.size() > MAX_NAME_SIZE || a_type > static_cast<std::uint8_t>(EventFieldType::Bool) || fields.size() >= MAX_FIELD_COUNT)
+            {
+                return false;
+            }
+
+            const auto type = static_cast<EventFieldType>(a_type);
+            const auto fieldSize = GetEventFieldSize(type);
+            const auto lastOffset = fields.empty() ? 0 : fields.back().offset + GetEventFieldSize(fields.back().type);
+            const auto offset = (lastOffset + fieldSize - 1) / fieldSize * fieldSize;
+            fields.push_back({std::string(a_name), type, offset});
+            dataSize = (offset + fieldSize + 7) / 8 * 8;
+            return true;
+        }
+
+        void Serialize(std::string& a_out) const
+        {
+            const auto appendU32 = [&](std::uint32_t a_value) {
+                a_out.append(reinterpret_cast<const char*>(&a_value), sizeof(a_value));
+            };
+
+            appendU32(static_cast<std::uint32_t>(fields.size()));
+            for (const auto& field : fields)
+            {
+                appendU32(static_cast<std::uint32_t>(field.name.size()));
+                a_out.append(field.name);
+                a_out += static_cast<char>(field.type);
+            }
+        }
+
+        static bool Deserialize(const void* a_data, size_t a_size, StateLayout& a_outLayout)
+        {
+            a_outLayout = {};
+            const auto data = static_cast<const char*>(a_data);
+            size_t pos = 0;
+            const auto readU32 = [&](std::uint32_t& a_outValue) {
+                if (data == nullptr || a_size - pos < sizeof(a_outValue))
+                {
+                    return false;
+                }
+                std::memcpy(&a_outValue, data + pos, sizeof(a_outValue));
+                pos += sizeof(a_outValue);
+                return true;
+            };
+
+            std::uint32_t fieldCount = 0;
+            if (!readU32(fieldCount) || fieldCount > MAX_FIELD_COUNT)
+            {
+                return false;
+            }
+
+            for (std::uint32_t i = 0; i < fieldCount; ++i)
+            {
+                std::uint32_t nameSize = 0;
+                if (!readU32(nameSize) || a_size - pos < static_cast<size_t>(nameSize) + 1 ||
+                    !a_outLayout.AddField(std::string_view(data + pos, nameSize), static_cast<std::uint8_t>(data[pos + nameSize])))
+                {
+                    return false;
+                }
+                pos += static_cast<size_t>(nameSize) + 1;
+            }
+
+            return pos == a_size;
+        }
+    };
+
+    /// <summary>
+    /// Seqlock over memory shared between processes: [u32 sequence][u32 dataSize][data].
+    /// One writer, any number of readers that never block it. Data is copied in 8 byte words with release stores and acquire loads
+    /// that keep it between the sequence accesses without fences, a reader retries while the sequence is odd or changes during its copy
+    /// </summary>
+    class StateBlock
+    {
+      public:
+        static constexpr size_t HEADER_SIZE = 8;
+        // A writer that died in the middle of a write must not hang readers
+        static constexpr std::uint32_t MAX_READ_ATTEMPTS = 4096;
+        static constexpr std::uint32_t SPIN_READ_ATTEMPTS = 64;
+
+      protected:
+        static_assert(std::atomic_ref<std::uint32_t>::is_always_lock_free && std::atomic_ref<std::uint64_t>::is_always_lock_free,
+                      "lock free atomics are required in shared memory");
+
+        std::uint32_t* m_sequence = nullptr;
+        std::uint64_t* m_words = nullptr;
+        std::uint32_t m_dataSize = 0;
+        // Writer side copy, only the writer changes the sequence
+        std::uint32_t m_writeSequence = 0;
+
+        static std::uint64_t LoadWord(std::uint64_t* a_word)
+        {
+            return std::atomic_ref<std::uint64_t>(*a_word).load(std::memory_order_acquire);
+        }
+
+        static void StoreWord(std::uint64_t* a_word, std::uint64_t a_value)
+        {
+            std::atomic_ref<std::uint64_t>(*a_word).store(a_value, std::memory_order_release);
+        }
+
+        bool IsInBounds(std::uint32_t a_offset, std::uint32_t a_size) const
+        {
+            return m_words != nullptr && a_size > 0 && a_offset <= m_dataSize && a_size <= m_dataSize - a_offset;
+        }
+
+      public:
+        static size_t GetBlockSize(std::uint32_t a_dataSize)
+        {
+            return HEADER_SIZE + (static_cast<size_t>(a_dataSize) + 7) / 8 * 8;
+        }
+
+        /// <summary>
+        /// Writer side, zeroes the block. a_memory must be 8 byte aligned and at least GetBlockSize(a_dataSize) bytes
+        /// </summary>
+        bool Initialize(void* a_memory, size_t a_size, std::uint32_t a_dataSize)
+        {
+            *this = {};
+            if (a_memory == nullptr || reinterpret_cast<std::uintptr_t>(a_memory) % 8 != 0 || a_size < GetBlockSize(a_dataSize))
+            {
+                return false;
+            }
+
+            std::memset(a_memory, 0, GetBlockSize(a_dataSize));
+            m_sequence = static_cast<std::uint32_t*>(a_memory);
+            m_sequence[1] = a_dataSize;
+            m_words = reinterpret_cast<std::uint64_t*>(static_cast<char*>(a_memory) + HEADER_SIZE);
+            m_dataSize = a_dataSize;
+            return true;
+        }
+
+        /// <summary>
+        /// Reader side, fails if the block was initialized with another data size. The memory can be read-only
+        /// </summary>
+        bool Attach(const void* a_memory, size_t a_size, std::uint32_t a_dataSize)
+        {
+            *this = {};
+            if (a_memory == nullptr || reinterpret_cast<std::uintptr_t>(a_memory) % 8 != 0 || a_size < GetBlockSize(a_dataSize) ||
+                static_cast<const std::uint32_t*>(a_memory)[1] != a_dataSize)
+            {
+                return false;
+            }
+
+            // Only loads are made through these pointers
+            m_sequence = static_cast<std::uint32_t*>(const_cast<void*>(a_memory));
+            m_words = reinterpret_cast<std::uint64_t*>(reinterpret_cast<char*>(m_sequence) + HEADER_SIZE);
+            m_dataSize = a_dataSize;
+            return true;
+        }
+
+        bool IsValid() const
+        {
+            return m_sequence != nullptr;
+        }
+
+        std::uint32_t GetDataSize() const
+        {
+            return m_dataSize;
+        }
+
+        /// <summary>
+        /// Even when no write is in progress, changes with every write
+        /// </summary>
+        std::uint32_t GetSequence() const
+        {
+            return m_sequence != nullptr ? std::atomic_ref<std::uint32_t>(*m_sequence).load(std::memory_order_acquire) : 0;
+        }
+
+        void BeginWrite()
+        {
+            std::atomic_ref<std::uint32_t>(*m_sequence).store(++m_writeSequence, std::memory_order_relaxed);
+        }
+
+        /// <summary>
+        /// Between BeginWrite and EndWrite
+        /// </summary>
+        bool WriteBytes(std::uint32_t a_offset, const void* a_data, std::uint32_t a_size)
+        {
+            if (!IsInBounds(a_offset, a_size) || a_data == nullptr)
+            {
+                return false;
+            }
+
+            auto source = static_cast<const char*>(a_data);
+            auto offset = a_offset;
+            const auto endOffset = a_offset + a_size;
+            while (offset < endOffset)
+            {
+                const auto wordIndex = offset / 8;
+                const auto byteIndex = offset % 8;
+                const auto byteCount = std::min<std::uint32_t>(8 - byteIndex, endOffset - offset);
+
+                // Only the writer stores, so a partial word can be merged with its current value
+                auto word = byteCount == 8 ? std::uint64_t(0) : LoadWord(m_words + wordIndex);
+                std::memcpy(reinterpret_cast<char*>(&word) + byteIndex, source, byteCount);
+                StoreWord(m_words + wordIndex, word);
+
+                source += byteCount;
+                offset += byteCount;
+            }
+            return true;
+        }
+
+        void EndWrite()
+        {
+            std::atomic_ref<std::uint32_t>(*m_sequence).store(++m_writeSequence, std::memory_order_release);
+        }
+
+        /// <summary>
+        /// Writes values from field a_firstField on in one write, so readers see all of them or none. Returns the written count
+        /// </summary>
+        std::uint32_t WriteValues(const StateLayout& a_layout, std::uint32_t a_firstField, const double* a_values, std::uint32_t a_valueCount)
+        {
+            if (!IsValid() || a_values == nullptr || a_layout.dataSize != m_dataSize || a_firstField >= a_layout.fields.size())
+            {
+                return 0;
+            }
+
+            const auto valueCount = std::min<std::uint32_t>(a_valueCount, static_cast<std::uint32_t>(a_layout.fields.size()) - a_firstField);
+            BeginWrite();
+            for (std::uint32_t i = 0; i < valueCount; ++i)
+            {
+                const auto& field = a_layout.fields[a_firstField + i];
+                const auto value = a_values[i];
+                switch (field.type)
+                {
+                case EventFieldType::Int32: {
+                    const auto intValue = ToInt32(value);
+                    WriteBytes(field.offset, &intValue, sizeof(intValue));
+                    break;
+                }
+                case EventFieldType::Float: {
+                    const auto floatValue = static_cast<float>(value);
+                    WriteBytes(field.offset, &floatValue, sizeof(floatValue));
+                    break;
+                }
+                case EventFieldType::Double:
+                    WriteBytes(field.offset, &value, sizeof(value));
+                    break;
+                case EventFieldType::Bool:
+                default: {
+                    const auto boolValue = static_cast<std::uint8_t>(value != 0.0);
+                    WriteBytes(field.offset, &boolValue, sizeof(boolValue));
+                    break;
+                }
+                }
+            }
+            EndWrite();
+            return valueCount;
+        }
+
+        /// <summary>
+        /// Consistent copy of a range. Fails if it is out of bounds or a write did not finish in MAX_READ_ATTEMPTS
+        /// </summary>
+        bool Read(std::uint32_t a_offset, void* a_out, std::uint32_t a_size) const
+        {
+            if (!IsInBounds(a_offset, a_size) || a_out == nullptr)
+            {
+                return false;
+            }
+
+            const auto firstWord = a_offset / 8;
+            const auto lastWord = (a_offset + a_size - 1) / 8;
+            for (std::uint32_t attempt = 0; attempt < MAX_READ_ATTEMPTS; ++attempt)
+            {
+                const auto sequence = std::atomic_ref<std::uint32_t>(*m_sequence).load(std::memory_order_acquire);
+                if ((sequence & 1) == 0)
+                {
+                    auto destination = static_cast<char*>(a_out);
+                    for (auto wordIndex = firstWord; wordIndex <= lastWord; ++wordIndex)
+                    {
+                        const auto word = LoadWord(m_words + wordIndex);
+                        const auto wordStart = wordIndex * 8;
+                        const auto copyStart = std::max(a_offset, wordStart);
+                        const auto copyEnd = std::min(a_offset + a_size, wordStart + 8);
+                        std::memcpy(destination, reinterpret_cast<const char*>(&word) + (copyStart - wordStart), copyEnd - copyStart);
+                        destination += copyEnd - copyStart;
+                    }
+
+                    if (std::atomic_ref<std::uint32_t>(*m_sequence).load(std::memory_order_relaxed) == sequence)
+                    {
+                        return true;
+                    }
+                }
+
+                if (attempt >= SPIN_READ_ATTEMPTS)
+                {
+                    std::this_thread::yield();
+                }
+            }
+            return false;
+        }
+
+        /// <summary>
+        /// Reads one field as a double, bool is 0 or 1
+        /// </summary>
+        bool ReadValue(const StateLayout::Field& a_field, double& a_outValue) const
+        {
+            char bytes[8]{};
+            if (!Read(a_field.offset, bytes, GetEventFieldSize(a_field.type)))
+            {
+                return false;
+            }
+
+            switch (a_field.type)
+            {
+            case EventFieldType::Int32: {
+                std::int32_t intValue = 0;
+                std::memcpy(&intValue, bytes, sizeof(intValue));
+                a_outValue = intValue;
+                break;
+            }
+            case EventFieldType::Float: {
+                float floatValue = 0;
+                std::memcpy(&floatValue, bytes, sizeof(floatValue));
+                a_outValue = floatValue;
+                break;
+            }
+            case EventFieldType::Double:
+                std::memcpy(&a_outValue, bytes, sizeof(a_outValue));
+                break;
+            case EventFieldType::Bool:
+            default:
+                a_outValue = bytes[0] != 0 ? 1.0 : 0.0;
+                break;
+            }
+            return true;
+        }
+    };
+}
@@ -0,0 +1,206 @@
+#include "CEFAsyncCallRegistry.h"
+
+namespace NL::JS
+{
+    class CEFAsyncCallRegistry::TimeoutTask : public CefTask
+    {
+        IMPLEMENT_REFCOUNTING(TimeoutTask);
+
+      protected:
+        std::uint32_t m_callId = 0;
+
+      public:
+        TimeoutTask(std::uint32_t a_callId)
+            : m_callId(a_callId)
+        {
+        }
+
+        void Execute() override
+        {
+            CEFAsyncCallRegistry::Reject(m_callId, "Native function call timed out");
+        }
+    };
+
+    CEFAsyncCallRegistry::ContextKey CEFAsyncCallRegistry::GetContextKey(const CefRefPtr<CefV8Context>& a_context)
+    {
+        return {a_context->GetBrowser()->GetIdentifier(), a_context->GetFrame()->GetIdentifier().ToString()};
+    }
+
+    bool CEFAsyncCallRegistry::TakePendingCall(std::uint32_t a_callId, PendingCall& a_outCall)
+    {
+        const auto it = s_pendingCallMap.find(a_callId);
+        if (it == s_pendingCallMap.end())
+        {
+            return false;
+        }
+
+        a_outCall = std::move(it->second);
+        s_pendingCallMap.erase(it);
+
+        const auto contextIt = s_contextCallMap.find(a_outCall.contextKey);
+        if (contextIt != s_contextCallMap.end())
+        {
+            contextIt->second.erase(a_callId);
+            if (contextIt->second.empty())
+            {
+                s_contextCallMap.erase(contextIt);
+            }
+        }
+
+        return true;
+    }
+
+    CefRefPtr<CefV8Value> CEFAsyncCallRegistry::ParseJSON(const CefRefPtr<CefV8Context>& a_context, std::string_view a_json, CefString& a_outError)
+    {
+        const auto jsonObject = a_context->GetGlobal()->GetValue("JSON");
+        const auto parseFunc = jsonObject != nullptr ? jsonObject->GetValue("parse") : nullptr;
+        if (parseFunc == nullptr || !parseFunc->IsFunction())
+        {
+            a_outError = "JSON.parse is not available";
+            return nullptr;
+        }
+
+        CefV8ValueList arguments;
+        arguments.push_back(CefV8Value::CreateString(NL::IPC::ToCefString(a_json)));
+        const auto result = parseFunc->ExecuteFunction(jsonObject, arguments);
+        if (result == nullptr || parseFunc->HasException())
+        {
+            a_outError = parseFunc->HasException() ? parseFunc->GetException()->GetMessage() : CefString("Can't parse native function result");
+            parseFunc->ClearException();
+            return nullptr;
+        }
+
+        return result;
+    }
+
+    void CEFAsyncCallRegistry::InitTimeout(CefRefPtr<CefCommandLine> a_commandLine)
+    {
+        if (a_commandLine == nullptr || !a_commandLine->HasSwitch(IPC_CL_JS_ASYNC_TIMEOUT_NAME))
+        {
+            return;
+        }
+
+        try
+        {
+            s_timeoutMs = static_cast<std::uint32_t>(std::stoul(a_commandLine->GetSwitchValue(IPC_CL_JS_ASYNC_TIMEOUT_NAME).ToString()));
+        }
+        catch (const std::exception& e)
+        {
+            spdlog::error("{}: invalid timeout switch value, {}", NameOf(CEFAsyncCallRegistry::InitTimeout), e.what());
+        }
+    }
+
+    std::uint32_t CEFAsyncCallRegistry::Add(CefRefPtr<CefV8Value>& a_outPromise)
+    {
+        // 0 means "no result expected"
+        if (++s_lastCallId == 0)
+        {
+            ++s_lastCallId;
+        }
+
+        const auto context = CefV8Context::GetCurrentContext();
+        auto contextKey = GetContextKey(context);
+        a_outPromise = CefV8Value::CreatePromise();
+        s_contextCallMap[contextKey].insert(s_lastCallId);
+        s_pendingCallMap[s_lastCallId] = {context, a_outPromise, std::move(contextKey)};
+
+        if (s_timeoutMs > 0)
+        {
+            CefPostDelayedTask(TID_RENDERER, new TimeoutTask(s_lastCallId), s_timeoutMs);
+        }
+
+        return s_lastCallId;
+    }
+
+    void CEFAsyncCallRegistry::Complete(const void* a_payload, size_t a_size)
+    {
+        NL::IPC::PayloadReader reader(a_payload, a_size);
+        std::uint32_t callId = 0;
+        std::uint8_t resultType = 0;
+        std::string_view result;
+        if (!reader.ReadRaw(callId) || !reader.ReadRaw(resultType) || !reader.ReadString(result))
+        {
+            spdlog::error("{}[{}]: malformed async result payload", NameOf(CEFAsyncCallRegistry::Complete), ::GetCurrentProcessId());
+            return;
+        }
+
+        PendingCall call;
+        if (!TakePendingCall(callId, call))
+        {
+            // Timed out or the context is released
+            return;
+        }
+
+        NL::CEF::CEFV8ContextGuard v8ContextGuard(call.context);
+        if (!v8ContextGuard.IsEntered())
+        {
+            spdlog::error("{}[{}]: can't enter v8 context", NameOf(CEFAsyncCallRegistry::Complete), ::GetCurrentProcessId());
+            return;
+        }
+
+        switch (resultType)
+        {
+        case IPC_JS_ASYNC_RESULT_JSON: {
+            CefString error;
+            const auto value = ParseJSON(call.context, result, error);
+            value != nullptr ? call.promise->ResolvePromise(value) : call.promise->RejectPromise(error);
+            break;
+        }
+        case IPC_JS_ASYNC_RESULT_BINARY:
+            call.promise->ResolvePromise(CefV8Value::CreateArrayBufferWithCopy(const_cast<char*>(result.data()), result.size()));
+            break;
+        case IPC_JS_ASYNC_RESULT_ERROR:
+        default:
+            call.promise->RejectPromise(NL::IPC::ToCefString(result));
+            break;
+        }
+    }
+
+    void CEFAsyncCallRegistry::Reject(std::uint32_t a_callId, const CefString& a_message)
+    {
+        PendingCall call;
+        if (!TakePendingCall(a_callId, call))
+        {
+            return;
+        }
+
+        NL::CEF::CEFV8ContextGuard v8ContextGuard(call.context);
+        if (v8ContextGuard.IsEntered())
+        {
+            call.promise->RejectPromise(a_message);
+        }
+    }
+
+    void CEFAsyncCallRegistry::RemoveContext(CefRefPtr<CefV8Context> a_context)
+    {
+        const auto contextIt = s_contextCallMap.find(GetContextKey(a_context));
+        if (contextIt == s_contextCallMap.end())
+        {
+            return;
+        }
+
+        // The frame can have a new context already, its calls stay
+        auto& callIds = contextIt->second;
+        for (auto it = callIds.begin(); it != callIds.end();)
+        {
+            const auto callIt = s_pendingCallMap.find(*it);
+            if (callIt == s_pendingCallMap.end() || callIt->second.context->IsSame(a_context))
+            {
+                if (callIt != s_pendingCallMap.end())
+                {
+                    s_pendingCallMap.erase(callIt);
+                }
+                it = callIds.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        if (callIds.empty())
+        {
+            s_contextCallMap.erase(contextIt);
+        }
+    }
+}
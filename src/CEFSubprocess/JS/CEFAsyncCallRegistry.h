@@ -0,0 +1,59 @@
+#pragma once
+
+#include "PCH.h"
+#include "CEF/CEFV8ContextGuard.h"
+#include "IPCSharedPayload.h"
+
+namespace NL::JS
+{
+    /// <summary>
+    /// Pending promises of async native functions. A promise is completed by IPC_JS_ASYNC_RESULT_EVENT,
+    /// rejected on timeout and dropped when its context is released.
+    /// Renderer thread only
+    /// </summary>
+    class CEFAsyncCallRegistry final
+    {
+      public:
+        static constexpr std::uint32_t DEFAULT_TIMEOUT_MS = 30000;
+
+      private:
+        // Browser id and frame id, a frame has one context at a time
+        using ContextKey = std::pair<int, std::string>;
+
+        struct PendingCall
+        {
+            CefRefPtr<CefV8Context> context = nullptr;
+            CefRefPtr<CefV8Value> promise = nullptr;
+            ContextKey contextKey;
+        };
+
+        class TimeoutTask;
+
+        static inline std::uint32_t s_lastCallId = 0;
+        static inline std::uint32_t s_timeoutMs = DEFAULT_TIMEOUT_MS;
+        static inline std::unordered_map<std::uint32_t, PendingCall> s_pendingCallMap;
+        // Call ids of every context, so a released context doesn't scan all pending calls
+        static inline std::map<ContextKey, std::unordered_set<std::uint32_t>> s_contextCallMap;
+
+        static ContextKey GetContextKey(const CefRefPtr<CefV8Context>& a_context);
+        static bool TakePendingCall(std::uint32_t a_callId, PendingCall& a_outCall);
+        static CefRefPtr<CefV8Value> ParseJSON(const CefRefPtr<CefV8Context>& a_context, std::string_view a_json, CefString& a_outError);
+
+      public:
+        /// <summary>
+        /// Reads optional timeout override from the process command line
+        /// </summary>
+        static void InitTimeout(CefRefPtr<CefCommandLine> a_commandLine);
+
+        /// <summary>
+        /// Creates a promise in the current context, returns the call id to send with the call
+        /// </summary>
+        static std::uint32_t Add(CefRefPtr<CefV8Value>& a_outPromise);
+        /// <summary>
+        /// Completes the call: [u32 asyncCallId][u8 resultType][string result]
+        /// </summary>
+        static void Complete(const void* a_payload, size_t a_size);
+        static void Reject(std::uint32_t a_callId, const CefString& a_message);
+        static void RemoveContext(CefRefPtr<CefV8Context> a_context);
+    };
+}
@@ -2,52 +2,262 @@
 
 namespace NL::JS
 {
-    void CEFEventFunctionHandler::CallEventFunc(const CefString& a_eventName, CefRefPtr<CefBrowser> a_browser, const CefString& a_data)
+    class CEFEventFunctionHandler::UnsubscribeHandler : public CefV8Handler
     {
+        IMPLEMENT_REFCOUNTING(UnsubscribeHandler);
+
+    protected:
+        int m_browserId = 0;
+        std::string m_frameId;
+        std::string m_eventName;
+        std::uint32_t m_listenerId = 0;
+
+    public:
+        UnsubscribeHandler(int a_browserId, std::string a_frameId, std::string a_eventName, std::uint32_t a_listenerId)
+            : m_browserId(a_browserId), m_frameId(std::move(a_frameId)), m_eventName(std::move(a_eventName)), m_listenerId(a_listenerId)
+        {
+        }
+
+        bool Execute(const CefString& name,
+                     CefRefPtr<CefV8Value> object,
+                     const CefV8ValueList& arguments,
+                     CefRefPtr<CefV8Value>& retval,
+                     CefString& exception) override
+        {
+            retval = CefV8Value::CreateBool(CEFEventFunctionHandler::RemoveListener(m_browserId, m_frameId, m_eventName, m_listenerId));
+            return true;
+        }
+    };
+
+    void CEFEventFunctionHandler::CollectListeners(int a_browserId, const std::string& a_eventName, std::vector<DispatchItem>& a_outItems)
+    {
+        a_outItems.clear();
+
         std::lock_guard locker(s_eventFuncMapMutex);
-        if (s_eventFuncMap.empty())
+        const auto browserIt = s_eventFuncMap.find(a_browserId);
+        if (browserIt == s_eventFuncMap.end())
         {
             return;
         }
 
-        const auto it = s_eventFuncMap.find(std::make_pair(a_eventName.ToString(), a_browser->GetIdentifier()));
-        if (it != s_eventFuncMap.end())
+        for (const auto& [frameId, bucket] : browserIt->second)
+        {
+            const auto listenersIt = bucket.listenerMap.find(a_eventName);
+            if (listenersIt != bucket.listenerMap.end())
+            {
+                for (const auto& listener : listenersIt->second)
+                {
+                    a_outItems.push_back({bucket.context, listener});
+                }
+            }
+
+            for (const auto& listener : bucket.wildcardListeners)
+            {
+                a_outItems.push_back({bucket.context, listener});
+            }
+        }
+    }
+
+    bool CEFEventFunctionHandler::RemoveListener(int a_browserId, const std::string& a_frameId, const std::string& a_eventName, std::uint32_t a_listenerId)
+    {
+        std::lock_guard locker(s_eventFuncMapMutex);
+        const auto browserIt = s_eventFuncMap.find(a_browserId);
+        if (browserIt == s_eventFuncMap.end())
+        {
+            return false;
+        }
+
+        const auto bucketIt = browserIt->second.find(a_frameId);
+        if (bucketIt == browserIt->second.end())
         {
-            const auto context = std::get<0>(it->second);
-            auto thisObject = std::get<1>(it->second);
-            auto callback = std::get<2>(it->second);
+            return false;
+        }
 
-            NL::CEF::CEFV8ContextGuard v8ContextGuard(context);
+        auto& bucket = bucketIt->second;
+        const auto isWildcard = a_eventName == WILDCARD_EVENT_NAME;
+        std::vector<Listener>* listeners = nullptr;
+        if (isWildcard)
+        {
+            listeners = &bucket.wildcardListeners;
+        }
+        else
+        {
+            const auto listenersIt = bucket.listenerMap.find(a_eventName);
+            if (listenersIt == bucket.listenerMap.end())
+            {
+                return false;
+            }
+            listeners = &listenersIt->second;
+        }
+
+        const auto it = std::find_if(listeners->begin(), listeners->end(), [&](const Listener& a_listener) {
+            return a_listener.id == a_listenerId;
+        });
+        if (it == listeners->end())
+        {
+            return false;
+        }
+
+        listeners->erase(it);
+        if (listeners->empty() && !isWildcard)
+        {
+            bucket.listenerMap.erase(a_eventName);
+        }
+        return true;
+    }
+
+    void CEFEventFunctionHandler::CallEventFunc(const CefString& a_eventName, CefRefPtr<CefBrowser> a_browser, const CefString& a_data)
+    {
+        std::vector<DispatchItem> items;
+        CollectListeners(a_browser->GetIdentifier(), a_eventName.ToString(), items);
+        if (items.empty())
+        {
+            return;
+        }
+
+        CefV8ValueList arguments;
+        for (const auto& item : items)
+        {
+            NL::CEF::CEFV8ContextGuard v8ContextGuard(item.context);
             if (!v8ContextGuard.IsEntered())
             {
                 spdlog::error("{}[{}]: can't enter v8 context", NameOf(CEFEventFunctionHandler::CallEventFunc), ::GetCurrentProcessId());
-                return;
+                continue;
             }
 
-            CefV8ValueList arguments;
+            // Values belong to the context, create them per listener
+            arguments.clear();
             arguments.push_back(CefV8Value::CreateString(a_data));
-            callback->ExecuteFunction(thisObject, arguments);
+            arguments.push_back(CefV8Value::CreateString(a_eventName));
+            item.listener.callback->ExecuteFunction(item.listener.thisObject, arguments);
         }
     }
 
-    void CEFEventFunctionHandler::RemoveEventFunc(CefRefPtr<CefV8Context> a_context)
+    void CEFEventFunctionHandler::CallEventFuncBatch(CefRefPtr<CefBrowser> a_browser, const void* a_payload, size_t a_size)
     {
-        // Remove any JavaScript callbacks registered for the context that has been released.
-        std::lock_guard locker(s_eventFuncMapMutex);
-        if (s_eventFuncMap.empty())
+        const auto browserId = a_browser->GetIdentifier();
+        std::optional<NL::CEF::CEFV8ContextGuard> v8ContextGuard;
+        CefRefPtr<CefV8Context> enteredContext = nullptr;
+        std::string eventNameString;
+        std::vector<DispatchItem> items;
+        CefV8ValueList arguments;
+
+        NL::IPC::PayloadReader reader(a_payload, a_size);
+        while (!reader.IsEnd())
+        {
+            std::string_view eventName;
+            std::string_view eventData;
+            if (!reader.ReadString(eventName) || !reader.ReadString(eventData))
+            {
+                spdlog::error("{}[{}]: malformed event batch payload", NameOf(CEFEventFunctionHandler::CallEventFuncBatch), ::GetCurrentProcessId());
+                return;
+            }
+
+            eventNameString.assign(eventName);
+            CollectListeners(browserId, eventNameString, items);
+            for (const auto& item : items)
+            {
+                if (enteredContext == nullptr || !enteredContext->IsSame(item.context))
+                {
+                    v8ContextGuard.reset();
+                    v8ContextGuard.emplace(item.context);
+                    if (!v8ContextGuard->IsEntered())
+                    {
+                        spdlog::error("{}[{}]: can't enter v8 context", NameOf(CEFEventFunctionHandler::CallEventFuncBatch), ::GetCurrentProcessId());
+                        v8ContextGuard.reset();
+                        enteredContext = nullptr;
+                        continue;
+                    }
+                    enteredContext = item.context;
+                }
+
+                arguments.clear();
+                arguments.push_back(CefV8Value::CreateString(NL::IPC::ToCefString(eventData)));
+                arguments.push_back(CefV8Value::CreateString(NL::IPC::ToCefString(eventName)));
+                item.listener.callback->ExecuteFunction(item.listener.thisObject, arguments);
+            }
+        }
+    }
+
+    void CEFEventFunctionHandler::CallEventFuncPacked(const CefString& a_eventName, CefRefPtr<CefBrowser> a_browser, const void* a_payload, size_t a_size)
+    {
+        const auto browserId = a_browser->GetIdentifier();
+        const auto eventName = a_eventName.ToString();
+        std::vector<DispatchItem> items;
+        CollectListeners(browserId, eventName, items);
+        if (items.empty())
         {
             return;
         }
 
-        for (auto it = s_eventFuncMap.begin(); it != s_eventFuncMap.end();)
+        CefV8ValueList arguments;
+        for (const auto& item : items)
         {
-            if (std::get<0>(it->second)->IsSame(a_context))
+            NL::CEF::CEFV8ContextGuard v8ContextGuard(item.context);
+            if (!v8ContextGuard.IsEntered())
             {
-                it = s_eventFuncMap.erase(it);
+                spdlog::error("{}[{}]: can't enter v8 context", NameOf(CEFEventFunctionHandler::CallEventFuncPacked), ::GetCurrentProcessId());
+                continue;
             }
-            else
+
+            const auto value = CEFEventSchemaRegistry::Decode(browserId, eventName, item.context, a_payload, a_size);
+            if (value == nullptr)
             {
-                ++it;
+                return;
+            }
+
+            arguments.clear();
+            arguments.push_back(value);
+            arguments.push_back(CefV8Value::CreateString(a_eventName));
+            item.listener.callback->ExecuteFunction(item.listener.thisObject, arguments);
+        }
+    }
+
+    void CEFEventFunctionHandler::CallEventFuncBinary(const CefString& a_eventName, CefRefPtr<CefBrowser> a_browser, const void* a_data, size_t a_size)
+    {
+        std::vector<DispatchItem> items;
+        CollectListeners(a_browser->GetIdentifier(), a_eventName.ToString(), items);
+
+        // Empty events still get a valid pointer
+        char emptyData = 0;
+        const auto data = a_data != nullptr && a_size > 0 ? const_cast<void*>(a_data) : &emptyData;
+        const auto size = data != &emptyData ? a_size : 0;
+
+        CefV8ValueList arguments;
+        for (const auto& item : items)
+        {
+            NL::CEF::CEFV8ContextGuard v8ContextGuard(item.context);
+            if (!v8ContextGuard.IsEntered())
+            {
+                spdlog::error("{}[{}]: can't enter v8 context", NameOf(CEFEventFunctionHandler::CallEventFuncBinary), ::GetCurrentProcessId());
+                continue;
+            }
+
+            // The shared memory is read-only and owned by the message, so the buffer can't reference it
+            arguments.clear();
+            arguments.push_back(CefV8Value::CreateArrayBufferWithCopy(data, size));
+            arguments.push_back(CefV8Value::CreateString(a_eventName));
+            item.listener.callback->ExecuteFunction(item.listener.thisObject, arguments);
+        }
+    }
+
+    void CEFEventFunctionHandler::RemoveEventFunc(CefRefPtr<CefBrowser> a_browser, CefRefPtr<CefFrame> a_frame, CefRefPtr<CefV8Context> a_context)
+    {
+        // Remove any JavaScript callbacks registered for the context that has been released.
+        std::lock_guard locker(s_eventFuncMapMutex);
+        const auto browserIt = s_eventFuncMap.find(a_browser->GetIdentifier());
+        if (browserIt == s_eventFuncMap.end())
+        {
+            return;
+        }
+
+        const auto bucketIt = browserIt->second.find(a_frame->GetIdentifier().ToString());
+        if (bucketIt != browserIt->second.end() && bucketIt->second.context->IsSame(a_context))
+        {
+            browserIt->second.erase(bucketIt);
+            if (browserIt->second.empty())
+            {
+                s_eventFuncMap.erase(browserIt);
             }
         }
     }
@@ -65,15 +275,28 @@ namespace NL::JS
             return true;
         }
 
-        const auto eventName = arguments[0]->GetStringValue();
+        auto eventName = arguments[0]->GetStringValue().ToString();
         const auto context = CefV8Context::GetCurrentContext();
         const auto browserId = context->GetBrowser()->GetIdentifier();
+        auto frameId = context->GetFrame()->GetIdentifier().ToString();
 
-        std::lock_guard locker(s_eventFuncMapMutex);
-        s_eventFuncMap.erase(std::make_pair(eventName, browserId));
-        s_eventFuncMap.insert(std::make_pair(std::make_pair(eventName, browserId),
-                                             std::make_tuple(context, object, arguments[1])));
+        std::uint32_t listenerId = 0;
+        {
+            std::lock_guard locker(s_eventFuncMapMutex);
+            auto& bucket = s_eventFuncMap[browserId][frameId];
+            if (bucket.context == nullptr || !bucket.context->IsSame(context))
+            {
+                // The frame has a new context, the old one is not released yet
+                bucket = {};
+                bucket.context = context;
+            }
+
+            listenerId = ++s_lastListenerId;
+            auto& listeners = eventName == WILDCARD_EVENT_NAME ? bucket.wildcardListeners : bucket.listenerMap[eventName];
+            listeners.push_back({listenerId, object, arguments[1]});
+        }
 
+        retval = CefV8Value::CreateFunction("unsubscribe", new UnsubscribeHandler(browserId, std::move(frameId), std::move(eventName), listenerId));
         return true;
     }
 }
@@ -2,22 +2,74 @@
 
 #include "PCH.h"
 #include "CEF/CEFV8ContextGuard.h"
+#include "IPCSharedPayload.h"
+#include "JS/CEFEventSchemaRegistry.h"
 
 namespace NL::JS
 {
+    /// <summary>
+    /// eventFunc(eventName, callback) adds a listener and returns a function that removes it.
+    /// An event can have many listeners, "*" listens to every event. Listeners are called with (data, eventName)
+    /// </summary>
     class CEFEventFunctionHandler : public CefV8Handler
     {
         IMPLEMENT_REFCOUNTING(CEFEventFunctionHandler);
 
+    public:
+        static constexpr std::string_view WILDCARD_EVENT_NAME = "*";
+
     protected:
-        CefRefPtr<CefBrowser> m_browser = nullptr;
+        struct Listener
+        {
+            std::uint32_t id = 0;
+            CefRefPtr<CefV8Value> thisObject = nullptr;
+            CefRefPtr<CefV8Value> callback = nullptr;
+        };
+
+        /// <summary>
+        /// Listeners of one frame context, dropped as a whole when the context is released
+        /// </summary>
+        struct ContextBucket
+        {
+            CefRefPtr<CefV8Context> context = nullptr;
+            std::unordered_map<std::string, std::vector<Listener>> listenerMap;
+            std::vector<Listener> wildcardListeners;
+        };
+
+        struct DispatchItem
+        {
+            CefRefPtr<CefV8Context> context = nullptr;
+            Listener listener;
+        };
+
+        class UnsubscribeHandler;
 
         static inline std::mutex s_eventFuncMapMutex;
-        static inline std::map<std::pair<std::string, int>, std::tuple<CefRefPtr<CefV8Context>, CefRefPtr<CefV8Value>, CefRefPtr<CefV8Value>>> s_eventFuncMap;
+        static inline std::uint32_t s_lastListenerId = 0;
+        // browser id -> frame id -> bucket
+        static inline std::unordered_map<int, std::unordered_map<std::string, ContextBucket>> s_eventFuncMap;
+
+        /// <summary>
+        /// Copies the listeners, so JS runs without the lock and listeners can subscribe or unsubscribe
+        /// </summary>
+        static void CollectListeners(int a_browserId, const std::string& a_eventName, std::vector<DispatchItem>& a_outItems);
+        static bool RemoveListener(int a_browserId, const std::string& a_frameId, const std::string& a_eventName, std::uint32_t a_listenerId);
 
     public:
         static void CallEventFunc(const CefString& a_eventName, CefRefPtr<CefBrowser> a_browser, const CefString& a_data);
-        static void RemoveEventFunc(CefRefPtr<CefV8Context> a_context);
+        /// <summary>
+        /// Calls events of the batch payload in order, the v8 context is entered once per run of listeners in the same context
+        /// </summary>
+        static void CallEventFuncBatch(CefRefPtr<CefBrowser> a_browser, const void* a_payload, size_t a_size);
+        /// <summary>
+        /// Listeners get the object decoded by the event schema instead of a string, the object is reused by the next event
+        /// </summary>
+        static void CallEventFuncPacked(const CefString& a_eventName, CefRefPtr<CefBrowser> a_browser, const void* a_payload, size_t a_size);
+        /// <summary>
+        /// Every listener gets its own ArrayBuffer with a copy of the data
+        /// </summary>
+        static void CallEventFuncBinary(const CefString& a_eventName, CefRefPtr<CefBrowser> a_browser, const void* a_data, size_t a_size);
+        static void RemoveEventFunc(CefRefPtr<CefBrowser> a_browser, CefRefPtr<CefFrame> a_frame, CefRefPtr<CefV8Context> a_context);
 
         // CefV8Handler
         bool Execute(const CefString& name,
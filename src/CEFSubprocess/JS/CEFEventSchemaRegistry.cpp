@@ -0,0 +1,95 @@
+#include "CEFEventSchemaRegistry.h"
+
+namespace NL::JS
+{
+    void CEFEventSchemaRegistry::SetSchema(int a_browserId, const std::string& a_eventName, NL::IPC::EventSchema&& a_schema)
+    {
+        auto& entry = s_schemaMap[std::make_pair(a_browserId, a_eventName)];
+        entry.schema = std::move(a_schema);
+        // Old object has old fields
+        entry.context = nullptr;
+        entry.object = nullptr;
+    }
+
+    void CEFEventSchemaRegistry::RemoveBrowser(int a_browserId)
+    {
+        for (auto it = s_schemaMap.begin(); it != s_schemaMap.end();)
+        {
+            it = it->first.first == a_browserId ? s_schemaMap.erase(it) : std::next(it);
+        }
+    }
+
+    void CEFEventSchemaRegistry::RemoveContext(CefRefPtr<CefV8Context> a_context)
+    {
+        for (auto& [key, entry] : s_schemaMap)
+        {
+            if (entry.context != nullptr && entry.context->IsSame(a_context))
+            {
+                entry.context = nullptr;
+                entry.object = nullptr;
+            }
+        }
+    }
+
+    CefRefPtr<CefV8Value> CEFEventSchemaRegistry::Decode(int a_browserId,
+                                                         const std::string& a_eventName,
+                                                         const CefRefPtr<CefV8Context>& a_context,
+                                                         const void* a_payload,
+                                                         size_t a_size)
+    {
+        const auto it = s_schemaMap.find(std::make_pair(a_browserId, a_eventName));
+        if (it == s_schemaMap.end())
+        {
+            spdlog::warn("{}[{}]: no schema for event \"{}\"", NameOf(CEFEventSchemaRegistry::Decode), ::GetCurrentProcessId(), a_eventName);
+            return nullptr;
+        }
+
+        auto& entry = it->second;
+        if (a_payload == nullptr || a_size != entry.schema.packedSize)
+        {
+            spdlog::error("{}[{}]: payload of event \"{}\" has {} bytes, schema has {}", NameOf(CEFEventSchemaRegistry::Decode), ::GetCurrentProcessId(), a_eventName, a_size, entry.schema.packedSize);
+            return nullptr;
+        }
+
+        if (entry.object == nullptr || !entry.context->IsSame(a_context))
+        {
+            entry.context = a_context;
+            entry.object = CefV8Value::CreateObject(nullptr, nullptr);
+        }
+
+        const auto data = static_cast<const char*>(a_payload);
+        for (const auto& field : entry.schema.fields)
+        {
+            CefRefPtr<CefV8Value> value = nullptr;
+            switch (field.type)
+            {
+            case NL::IPC::EventFieldType::Int32: {
+                std::int32_t intValue;
+                std::memcpy(&intValue, data + field.offset, sizeof(intValue));
+                value = CefV8Value::CreateInt(intValue);
+                break;
+            }
+            case NL::IPC::EventFieldType::Float: {
+                float floatValue;
+                std::memcpy(&floatValue, data + field.offset, sizeof(floatValue));
+                value = CefV8Value::CreateDouble(floatValue);
+                break;
+            }
+            case NL::IPC::EventFieldType::Double: {
+                double doubleValue;
+                std::memcpy(&doubleValue, data + field.offset, sizeof(doubleValue));
+                value = CefV8Value::CreateDouble(doubleValue);
+                break;
+            }
+            case NL::IPC::EventFieldType::Bool:
+            default:
+                value = CefV8Value::CreateBool(data[field.offset] != 0);
+                break;
+            }
+
+            entry.object->SetValue(field.name, value, V8_PROPERTY_ATTRIBUTE_NONE);
+        }
+
+        return entry.object;
+    }
+}
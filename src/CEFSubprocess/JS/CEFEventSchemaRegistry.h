@@ -0,0 +1,40 @@
+#pragma once
+
+#include "PCH.h"
+#include "IPCEventSchema.h"
+
+namespace NL::JS
+{
+    /// <summary>
+    /// Schemas of positional event payloads, set by IPC_JS_EVENT_SCHEMA_EVENT.
+    /// Payloads are written into one object per event and context that is reused by the next event.
+    /// Renderer thread only
+    /// </summary>
+    class CEFEventSchemaRegistry final
+    {
+      private:
+        struct Entry
+        {
+            NL::IPC::EventSchema schema;
+            CefRefPtr<CefV8Context> context = nullptr;
+            CefRefPtr<CefV8Value> object = nullptr;
+        };
+
+        // (browser id, event name) -> entry
+        static inline std::map<std::pair<int, std::string>, Entry> s_schemaMap;
+
+      public:
+        static void SetSchema(int a_browserId, const std::string& a_eventName, NL::IPC::EventSchema&& a_schema);
+        static void RemoveBrowser(int a_browserId);
+        static void RemoveContext(CefRefPtr<CefV8Context> a_context);
+
+        /// <summary>
+        /// Must be called in a_context. Returns nullptr if there is no schema or the payload size doesn't match
+        /// </summary>
+        static CefRefPtr<CefV8Value> Decode(int a_browserId,
+                                            const std::string& a_eventName,
+                                            const CefRefPtr<CefV8Context>& a_context,
+                                            const void* a_payload,
+                                            size_t a_size);
+    };
+}
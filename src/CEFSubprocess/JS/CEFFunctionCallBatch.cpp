@@ -0,0 +1,80 @@
+#include "CEFFunctionCallBatch.h"
+
+namespace NL::JS
+{
+    CEFFunctionCallBatch::CEFFunctionCallBatch(CefRefPtr<CefBrowser> a_browser)
+    {
+        m_browser = a_browser;
+    }
+
+    CefRefPtr<CEFFunctionCallBatch> CEFFunctionCallBatch::GetOrCreate(CefRefPtr<CefBrowser> a_browser)
+    {
+        auto& batch = s_batchMap[a_browser->GetIdentifier()];
+        if (batch == nullptr)
+        {
+            batch = new CEFFunctionCallBatch(a_browser);
+        }
+        return batch;
+    }
+
+    void CEFFunctionCallBatch::Remove(CefRefPtr<CefBrowser> a_browser)
+    {
+        const auto it = s_batchMap.find(a_browser->GetIdentifier());
+        if (it != s_batchMap.end())
+        {
+            it->second->Flush();
+            s_batchMap.erase(it);
+        }
+    }
+
+    void CEFFunctionCallBatch::Add(std::uint32_t a_funcId, std::uint32_t a_asyncCallId, const CefRefPtr<CefListValue>& a_args)
+    {
+        NL::IPC::PayloadStringWriter payloadWriter(m_payload);
+        NL::Converters::IPCPayloadWriter::WriteCall(payloadWriter, a_funcId, a_asyncCallId, a_args);
+        ++m_callCount;
+
+        if (m_callCount >= MAX_CALL_COUNT)
+        {
+            Flush();
+        }
+        else if (!m_isFlushPosted)
+        {
+            m_isFlushPosted = CefPostTask(TID_RENDERER, this);
+        }
+    }
+
+    void CEFFunctionCallBatch::Flush()
+    {
+        if (m_payload.empty())
+        {
+            return;
+        }
+
+        CefRefPtr<CefProcessMessage> message = nullptr;
+        if (m_payload.size() >= IPC_SHARED_PAYLOAD_THRESHOLD)
+        {
+            message = NL::IPC::CreateSharedMessage(IPC_JS_FUNCTION_CALL_BATCH_EVENT, m_payload);
+        }
+
+        if (message == nullptr)
+        {
+            message = CefProcessMessage::Create(IPC_JS_FUNCTION_CALL_BATCH_EVENT);
+            message->GetArgumentList()->SetBinary(0, CefBinaryValue::Create(m_payload.data(), m_payload.size()));
+        }
+
+        m_payload.clear();
+        m_callCount = 0;
+
+        const auto frame = m_browser->GetMainFrame();
+        if (frame != nullptr)
+        {
+            frame->SendProcessMessage(PID_BROWSER, message);
+        }
+    }
+
+    void CEFFunctionCallBatch::Execute()
+    {
+        m_isFlushPosted = false;
+        Flush();
+    }
+}
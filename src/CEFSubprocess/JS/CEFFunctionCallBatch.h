@@ -0,0 +1,43 @@
+#pragma once
+
+#include "PCH.h"
+#include "Converters/IPCPayloadWriter.h"
+
+namespace NL::JS
+{
+    /// <summary>
+    /// Queues calls of batched functions made within one JS task and sends them as a single message.
+    /// The flush task is posted to the renderer thread, so it runs after the current task and its microtasks.
+    /// Renderer thread only
+    /// </summary>
+    class CEFFunctionCallBatch : public CefTask
+    {
+        IMPLEMENT_REFCOUNTING(CEFFunctionCallBatch);
+
+      protected:
+        static constexpr std::uint32_t MAX_CALL_COUNT = 1024;
+
+        static inline std::map<int, CefRefPtr<CEFFunctionCallBatch>> s_batchMap;
+
+        CefRefPtr<CefBrowser> m_browser = nullptr;
+        // [call][call]... (see IPCSharedPayload.h)
+        std::string m_payload;
+        std::uint32_t m_callCount = 0;
+        bool m_isFlushPosted = false;
+
+      public:
+        CEFFunctionCallBatch(CefRefPtr<CefBrowser> a_browser);
+
+        static CefRefPtr<CEFFunctionCallBatch> GetOrCreate(CefRefPtr<CefBrowser> a_browser);
+        /// <summary>
+        /// Sends pending calls and forgets the browser batch
+        /// </summary>
+        static void Remove(CefRefPtr<CefBrowser> a_browser);
+
+        void Add(std::uint32_t a_funcId, std::uint32_t a_asyncCallId, const CefRefPtr<CefListValue>& a_args);
+        void Flush();
+
+        // CefTask
+        void Execute() override;
+    };
+}
@@ -2,15 +2,137 @@
 
 namespace NL::JS
 {
-    CEFFunctionHandler::CEFFunctionHandler(CefRefPtr<CefBrowser> a_browser, CefString a_objectName)
+    CEFFunctionHandler::CEFFunctionHandler(CefRefPtr<CefBrowser> a_browser)
     {
-        if (a_browser == nullptr)
+        m_browser = a_browser;
+        m_callBatch = CEFFunctionCallBatch::GetOrCreate(a_browser);
+    }
+
+    CefRefPtr<CEFFunctionHandler> CEFFunctionHandler::GetOrCreate(CefRefPtr<CefBrowser> a_browser)
+    {
+        auto& handler = s_handlerMap[a_browser->GetIdentifier()];
+        if (handler == nullptr)
         {
-            spdlog::error("{}: browser is nullptr", NameOf(CEFFunctionHandler));
+            handler = new CEFFunctionHandler(a_browser);
         }
+        return handler;
+    }
 
-        m_browser = a_browser;
-        m_objectName = a_objectName;
+    void CEFFunctionHandler::Remove(CefRefPtr<CefBrowser> a_browser)
+    {
+        s_handlerMap.erase(a_browser->GetIdentifier());
+    }
+
+    bool CEFFunctionHandler::GetFunctionKey(std::string_view a_objectName, std::string_view a_funcName, CefString& a_outKey)
+    {
+        if (a_objectName.find('.') != std::string_view::npos || a_funcName.find('.') != std::string_view::npos)
+        {
+            return false;
+        }
+
+        thread_local std::string key;
+        key.clear();
+        if (!a_objectName.empty())
+        {
+            key.append(a_objectName).append(1, '.');
+        }
+        key.append(a_funcName);
+        a_outKey.FromString(key);
+        return true;
+    }
+
+    void CEFFunctionHandler::AddFunction(const CefString& a_key, std::string_view a_objectName, std::string_view a_funcName, const FunctionInfo& a_info)
+    {
+        m_functionMap.insert_or_assign(a_key, RegisteredFunction{std::string(a_objectName), std::string(a_funcName), a_info});
+        ++m_changeCount;
+        if (!m_staleFunctionKeys.empty())
+        {
+            m_staleFunctionKeys.erase(a_key);
+        }
+    }
+
+    bool CEFFunctionHandler::RemoveFunction(const CefString& a_key)
+    {
+        if (!m_staleFunctionKeys.empty())
+        {
+            m_staleFunctionKeys.erase(a_key);
+        }
+        if (m_functionMap.erase(a_key) == 0)
+        {
+            return false;
+        }
+
+        ++m_changeCount;
+        return true;
+    }
+
+    const CEFFunctionHandler::FunctionInfo* CEFFunctionHandler::FindFunction(const CefString& a_key) const
+    {
+        const auto it = m_functionMap.find(a_key);
+        return it != m_functionMap.end() ? &it->second.info : nullptr;
+    }
+
+    const std::map<CefString, CEFFunctionHandler::RegisteredFunction>& CEFFunctionHandler::GetFunctions() const
+    {
+        return m_functionMap;
+    }
+
+    void CEFFunctionHandler::MarkFunctionsStale()
+    {
+        for (const auto& [funcKey, function] : m_functionMap)
+        {
+            m_staleFunctionKeys.insert(funcKey);
+        }
+    }
+
+    size_t CEFFunctionHandler::RemoveStaleFunctions()
+    {
+        size_t removedCount = 0;
+        for (const auto& funcKey : m_staleFunctionKeys)
+        {
+            removedCount += m_functionMap.erase(funcKey);
+        }
+        m_staleFunctionKeys.clear();
+        if (removedCount > 0)
+        {
+            ++m_changeCount;
+        }
+        return removedCount;
+    }
+
+    CefRefPtr<CefDictionaryValue> CEFFunctionHandler::ConvertToCefDictionary() const
+    {
+        const auto result = CefDictionaryValue::Create();
+        for (const auto& [funcKey, function] : m_functionMap)
+        {
+            // GetList references the stored list, a new list is moved into the dictionary
+            if (result->GetType(function.objectName) == VTYPE_LIST)
+            {
+                const auto funcList = result->GetList(function.objectName);
+                funcList->SetString(funcList->GetSize(), function.funcName);
+                continue;
+            }
+
+            const auto funcList = CefListValue::Create();
+            funcList->SetString(0, function.funcName);
+            result->SetList(function.objectName, funcList);
+        }
+        return result;
+    }
+
+    std::uint64_t CEFFunctionHandler::GetChangeCount() const
+    {
+        return m_changeCount;
+    }
+
+    std::uint32_t CEFFunctionHandler::GetRevision() const
+    {
+        return m_revision;
+    }
+
+    void CEFFunctionHandler::SetRevision(std::uint32_t a_revision)
+    {
+        m_revision = a_revision;
     }
 
     bool CEFFunctionHandler::Execute(const CefString& name,
@@ -19,39 +141,106 @@ namespace NL::JS
                                      CefRefPtr<CefV8Value>& retval,
                                      CefString& exception)
     {
-        auto message = CefProcessMessage::Create(IPC_JS_FUNCTION_CALL_EVENT);
-        auto messageArgs = message->GetArgumentList();
+        // A page can keep a reference to a removed function
+        const auto info = FindFunction(name);
+        if (info == nullptr)
+        {
+            const auto funcKey = name.ToString();
+            spdlog::warn("{}: function \"{}\" is removed", NameOf(CEFFunctionHandler), funcKey);
+            exception = "Native function \"" + funcKey + "\" is removed";
+            return true;
+        }
+
+        // The map can change while JS runs, so the call works on a copy
+        const auto funcInfo = *info;
+        const auto startTime = std::chrono::steady_clock::now();
+        size_t argBytes = 0;
+        Call(funcInfo, arguments, retval, exception, argBytes);
+
+        const auto endTime = std::chrono::steady_clock::now();
+        CEFMetrics::GetFunctionTable().Record(funcInfo.metricKey, argBytes, CEFMetrics::GetMicroseconds(endTime - startTime));
+        CEFMetrics::SendReportIfDue(m_browser, endTime);
+        return true;
+    }
+
+    void CEFFunctionHandler::Call(const FunctionInfo& a_info, const CefV8ValueList& a_arguments, CefRefPtr<CefV8Value>& a_retval, CefString& a_exception, size_t& a_outArgBytes)
+    {
         auto funcArgs = CefListValue::Create();
 
-        std::vector<CefRefPtr<CefV8Value>> objectRefs;
-        std::unordered_map<std::string, std::uint32_t> warnMap;
+        NL::Converters::CEFValueConverter::ConvertState convertState;
         CefString firstException;
-        for (size_t i = 0; i < arguments.size(); ++i)
+        for (size_t i = 0; i < a_arguments.size(); ++i)
         {
-            funcArgs->SetValue(static_cast<int32_t>(i), NL::Converters::CEFValueConverter::ConvertValue(arguments[i], objectRefs, warnMap, exception));
+            const auto value = NL::Converters::CEFValueConverter::ConvertValue(a_arguments[i], convertState, a_exception);
+            if (value == nullptr)
+            {
+                // Limit exceeded, the call is dropped and exception is thrown in JS
+                spdlog::error("{}: {}", NameOf(CEFFunctionHandler::Call), a_exception.ToString());
+                return;
+            }
+
+            funcArgs->SetValue(static_cast<int32_t>(i), value);
 
-            if (!exception.empty())
+            if (!a_exception.empty())
             {
-                spdlog::error("{}: {}", NameOf(CEFFunctionHandler::Execute), exception.ToString());
+                spdlog::error("{}: {}", NameOf(CEFFunctionHandler::Call), a_exception.ToString());
                 if (firstException.empty())
                 {
-                    firstException = exception;
+                    firstException = a_exception;
                 }
-                exception = "";
+                a_exception = "";
             }
         }
 
-        exception = firstException;
-        for (const auto& it : warnMap)
+        a_exception = firstException;
+        a_outArgBytes = convertState.byteSize;
+        for (const auto& it : convertState.warnMap)
         {
             spdlog::warn("{} ({})", it.first.c_str(), it.second);
         }
 
-        messageArgs->SetString(0, m_objectName);
-        messageArgs->SetString(1, name);
-        messageArgs->SetList(2, funcArgs);
-        m_browser->GetMainFrame()->SendProcessMessage(PID_BROWSER, message);
+        // A thrown exception replaces the return value, so there is no promise to wait for
+        std::uint32_t asyncCallId = 0;
+        if (a_info.isAsync && a_exception.empty())
+        {
+            asyncCallId = NL::JS::CEFAsyncCallRegistry::Add(a_retval);
+        }
 
-        return true;
+        if (m_callBatch != nullptr)
+        {
+            if (a_info.isBatched)
+            {
+                m_callBatch->Add(a_info.funcId, asyncCallId, funcArgs);
+                return;
+            }
+
+            // Earlier batched calls must arrive first
+            m_callBatch->Flush();
+        }
+
+        if (convertState.byteSize >= IPC_SHARED_PAYLOAD_THRESHOLD)
+        {
+            // Sized first, then written straight into the region
+            const auto sharedMessage = NL::IPC::CreateSharedMessage(IPC_JS_FUNCTION_CALL_SHARED_EVENT, [&](auto& a_out) {
+                NL::Converters::IPCPayloadWriter::WriteCall(a_out, a_info.funcId, asyncCallId, funcArgs);
+            });
+            if (sharedMessage != nullptr)
+            {
+                m_browser->GetMainFrame()->SendProcessMessage(PID_BROWSER, sharedMessage);
+                return;
+            }
+
+            spdlog::warn("{}: can't allocate shared memory for {} bytes of arguments, using the argument list", NameOf(CEFFunctionHandler::Call), convertState.byteSize);
+        }
+
+        auto message = CefProcessMessage::Create(IPC_JS_FUNCTION_CALL_EVENT);
+        auto messageArgs = message->GetArgumentList();
+        messageArgs->SetInt(0, static_cast<int>(a_info.funcId));
+        messageArgs->SetList(1, funcArgs);
+        if (asyncCallId != 0)
+        {
+            messageArgs->SetInt(2, static_cast<int>(asyncCallId));
+        }
+        m_browser->GetMainFrame()->SendProcessMessage(PID_BROWSER, message);
     }
 }
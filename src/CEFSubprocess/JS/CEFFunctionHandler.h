@@ -2,19 +2,96 @@
 
 #include "PCH.h"
 #include "Converters/CEFValueConverter.h"
+#include "Converters/IPCPayloadWriter.h"
+#include "JS/CEFFunctionCallBatch.h"
+#include "JS/CEFAsyncCallRegistry.h"
+#include "JS/CEFMetrics.h"
 
 namespace NL::JS
 {
+    /// <summary>
+    /// One handler per browser for every native function, calls are dispatched on the V8 function name (see GetFunctionKey).
+    /// The registry is keyed by that CefString, so a call doesn't convert or build strings.
+    /// Its function map is the renderer side registry of the browser, it outlives navigations and is installed into every new main context.
+    /// Renderer thread only
+    /// </summary>
     class CEFFunctionHandler : public CefV8Handler
     {
         IMPLEMENT_REFCOUNTING(CEFFunctionHandler);
 
+    public:
+        struct FunctionInfo
+        {
+            // Id of the native function (see JSFunctionStorage::FuncId)
+            std::uint32_t funcId = 0;
+            // See CEFMetrics
+            std::uint64_t metricKey = 0;
+            bool isBatched = false;
+            // Returns a promise completed by the native side
+            bool isAsync = false;
+            // Created on first access through the namespace object (see CEFNamespaceInterceptor)
+            bool isLazy = false;
+        };
+
+        struct RegisteredFunction
+        {
+            std::string objectName;
+            std::string funcName;
+            FunctionInfo info;
+        };
+
     protected:
+        static inline std::map<int, CefRefPtr<CEFFunctionHandler>> s_handlerMap;
+
         CefRefPtr<CefBrowser> m_browser = nullptr;
-        CefString m_objectName = "";
+        CefRefPtr<CEFFunctionCallBatch> m_callBatch = nullptr;
+        std::map<CefString, RegisteredFunction> m_functionMap;
+        // Keys cleared by IPC_JS_FUNCTION_CLEAR_EVENT, removed when the next main context is created. Adding a function again keeps it
+        std::set<CefString> m_staleFunctionKeys;
+        // Registry revision of the browser process this map matches, 0 if it was never seeded
+        std::uint32_t m_revision = 0;
+        // Bumped when m_functionMap changes, see CEFNamespaceInterceptor
+        std::uint64_t m_changeCount = 0;
+
+        /// <summary>
+        /// Converts the arguments and sends the call, a_outArgBytes is the converted size
+        /// </summary>
+        void Call(const FunctionInfo& a_info, const CefV8ValueList& a_arguments, CefRefPtr<CefV8Value>& a_retval, CefString& a_exception, size_t& a_outArgBytes);
 
     public:
-        CEFFunctionHandler(CefRefPtr<CefBrowser> a_browser, CefString a_objectName);
+        CEFFunctionHandler(CefRefPtr<CefBrowser> a_browser);
+
+        static CefRefPtr<CEFFunctionHandler> GetOrCreate(CefRefPtr<CefBrowser> a_browser);
+        static void Remove(CefRefPtr<CefBrowser> a_browser);
+        /// <summary>
+        /// "objectName.funcName", or funcName for global functions. Also the name of the V8 function.
+        /// Returns false if a name contains '.', the key would be ambiguous (the browser process rejects such names)
+        /// </summary>
+        static bool GetFunctionKey(std::string_view a_objectName, std::string_view a_funcName, CefString& a_outKey);
+
+        /// <summary>
+        /// Adds or replaces the function, a_key is GetFunctionKey(a_objectName, a_funcName)
+        /// </summary>
+        void AddFunction(const CefString& a_key, std::string_view a_objectName, std::string_view a_funcName, const FunctionInfo& a_info);
+        bool RemoveFunction(const CefString& a_key);
+        const FunctionInfo* FindFunction(const CefString& a_key) const;
+        const std::map<CefString, RegisteredFunction>& GetFunctions() const;
+        /// <summary>
+        /// Every registered function is removed by the next RemoveStaleFunctions unless it is added again before
+        /// </summary>
+        void MarkFunctionsStale();
+        /// <summary>
+        /// Removes stale functions from the registry only, call it before a new main context is bound. Returns the removed count
+        /// </summary>
+        size_t RemoveStaleFunctions();
+        /// <summary>
+        /// Object name -> list of function names, the IPC_JS_FUNCION_ADD_EVENT layout
+        /// </summary>
+        CefRefPtr<CefDictionaryValue> ConvertToCefDictionary() const;
+
+        std::uint64_t GetChangeCount() const;
+        std::uint32_t GetRevision() const;
+        void SetRevision(std::uint32_t a_revision);
 
         // CefV8Handler
         bool Execute(const CefString& name,
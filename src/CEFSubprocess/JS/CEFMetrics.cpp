@@ -0,0 +1,47 @@
+#include "CEFMetrics.h"
+
+namespace NL::JS
+{
+    NL::Metrics::MetricTable& CEFMetrics::GetFunctionTable()
+    {
+        return s_functionTable;
+    }
+
+    NL::Metrics::MetricTable& CEFMetrics::GetMessageTable()
+    {
+        return s_messageTable;
+    }
+
+    std::uint64_t CEFMetrics::GetMicroseconds(std::chrono::steady_clock::duration a_duration)
+    {
+        return static_cast<std::uint64_t>(std::max<std::int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(a_duration).count(), 0));
+    }
+
+    void CEFMetrics::SendReportIfDue(const CefRefPtr<CefBrowser>& a_browser, std::chrono::steady_clock::time_point a_now)
+    {
+        if (a_now - s_lastReportTime < REPORT_INTERVAL || a_browser == nullptr || !a_browser->IsValid())
+        {
+            return;
+        }
+        s_lastReportTime = a_now;
+
+        // [function entries][message entries] (see MetricTable::Serialize)
+        std::string payload;
+        NL::Metrics::MetricTable::Serialize(s_functionTable.TakeSnapshot(), payload);
+        NL::Metrics::MetricTable::Serialize(s_messageTable.TakeSnapshot(), payload);
+
+        CefRefPtr<CefProcessMessage> message = nullptr;
+        if (payload.size() >= IPC_SHARED_PAYLOAD_THRESHOLD)
+        {
+            message = NL::IPC::CreateSharedMessage(IPC_METRICS_EVENT, payload);
+        }
+
+        if (message == nullptr)
+        {
+            message = CefProcessMessage::Create(IPC_METRICS_EVENT);
+            message->GetArgumentList()->SetBinary(0, CefBinaryValue::Create(payload.data(), payload.size()));
+        }
+
+        a_browser->GetMainFrame()->SendProcessMessage(PID_BROWSER, message);
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "PCH.h"
+#include "IPCSharedPayload.h"
+#include "Metrics/MetricTable.hpp"
+
+namespace NL::JS
+{
+    /// <summary>
+    /// Renderer side metrics, sent to the browser process periodically (see IPC_METRICS_EVENT).
+    /// Functions are keyed by MetricTable::MakeKey("objectName.funcName") with one timing: conversion and sending.
+    /// Messages are keyed by MetricTable::MakeKey(message name) with one timing: dispatch
+    /// </summary>
+    class CEFMetrics final
+    {
+      public:
+        static constexpr auto REPORT_INTERVAL = std::chrono::seconds(10);
+
+      private:
+        static inline NL::Metrics::MetricTable s_functionTable;
+        static inline NL::Metrics::MetricTable s_messageTable;
+        static inline std::chrono::steady_clock::time_point s_lastReportTime = std::chrono::steady_clock::now();
+
+      public:
+        static NL::Metrics::MetricTable& GetFunctionTable();
+        static NL::Metrics::MetricTable& GetMessageTable();
+
+        static std::uint64_t GetMicroseconds(std::chrono::steady_clock::duration a_duration);
+
+        /// <summary>
+        /// Renderer thread only
+        /// </summary>
+        static void SendReportIfDue(const CefRefPtr<CefBrowser>& a_browser, std::chrono::steady_clock::time_point a_now = std::chrono::steady_clock::now());
+    };
+}
@@ -0,0 +1,95 @@
+#include "CEFNamespaceInterceptor.h"
+
+namespace NL::JS
+{
+    CEFNamespaceInterceptor::CEFNamespaceInterceptor(CefRefPtr<CEFFunctionHandler> a_funcHandler, std::string_view a_objectName)
+    {
+        m_funcHandler = a_funcHandler;
+        m_objectName = a_objectName;
+    }
+
+    CefRefPtr<CefV8Value> CEFNamespaceInterceptor::CreateNamespace(CefRefPtr<CEFFunctionHandler> a_funcHandler, std::string_view a_objectName)
+    {
+        auto object = CefV8Value::CreateObject(nullptr, new CEFNamespaceInterceptor(a_funcHandler, a_objectName));
+        object->SetUserData(a_funcHandler);
+        return object;
+    }
+
+    bool CEFNamespaceInterceptor::IsLazyNamespace(const CefRefPtr<CefV8Value>& a_object, const CefRefPtr<CEFFunctionHandler>& a_funcHandler)
+    {
+        const auto userData = a_object->GetUserData();
+        return userData != nullptr && userData.get() == static_cast<CefBaseRefCounted*>(a_funcHandler.get());
+    }
+
+    bool CEFNamespaceInterceptor::Get(const CefString& name,
+                                      const CefRefPtr<CefV8Value> object,
+                                      CefRefPtr<CefV8Value>& retval,
+                                      CefString& exception)
+    {
+        const auto changeCount = m_funcHandler->GetChangeCount();
+        if (const auto it = m_funcCache.find(name); it != m_funcCache.end())
+        {
+            auto& cachedFunc = it->second;
+            const auto info = cachedFunc.changeCount != changeCount ? m_funcHandler->FindFunction(cachedFunc.funcKey) : nullptr;
+            if (cachedFunc.changeCount == changeCount || (info != nullptr && info->isLazy))
+            {
+                cachedFunc.changeCount = changeCount;
+                retval = cachedFunc.value;
+                return true;
+            }
+
+            m_funcCache.erase(it);
+        }
+
+        // Other properties, like the event function, fall through to the object
+        if (m_missChangeCount != changeCount)
+        {
+            m_missNames.clear();
+            m_missChangeCount = changeCount;
+        }
+        if (m_missNames.contains(name))
+        {
+            return false;
+        }
+
+        CefString funcKey;
+        const auto info = CEFFunctionHandler::GetFunctionKey(m_objectName, name.ToString(), funcKey) ? m_funcHandler->FindFunction(funcKey) : nullptr;
+        if (info == nullptr || !info->isLazy)
+        {
+            if (m_missNames.size() < MAX_MISS_COUNT)
+            {
+                m_missNames.insert(name);
+            }
+            return false;
+        }
+
+        auto funcValue = CefV8Value::CreateFunction(funcKey, m_funcHandler);
+        retval = funcValue;
+        m_funcCache.insert_or_assign(name, CachedFunction{std::move(funcKey), std::move(funcValue), changeCount});
+        return true;
+    }
+
+    bool CEFNamespaceInterceptor::Get(int index,
+                                      const CefRefPtr<CefV8Value> object,
+                                      CefRefPtr<CefV8Value>& retval,
+                                      CefString& exception)
+    {
+        return false;
+    }
+
+    bool CEFNamespaceInterceptor::Set(const CefString& name,
+                                      const CefRefPtr<CefV8Value> object,
+                                      const CefRefPtr<CefV8Value> value,
+                                      CefString& exception)
+    {
+        return false;
+    }
+
+    bool CEFNamespaceInterceptor::Set(int index,
+                                      const CefRefPtr<CefV8Value> object,
+                                      const CefRefPtr<CefV8Value> value,
+                                      CefString& exception)
+    {
+        return false;
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "PCH.h"
+#include "JS/CEFFunctionHandler.h"
+
+namespace NL::JS
+{
+    /// <summary>
+    /// Interceptor of a namespace object that creates its lazy functions on first access, works like a JS Proxy "get" trap.
+    /// Lazy functions are not enumerable. One interceptor per namespace object, so the cached functions belong to its context
+    /// </summary>
+    class CEFNamespaceInterceptor : public CefV8Interceptor
+    {
+        IMPLEMENT_REFCOUNTING(CEFNamespaceInterceptor);
+
+    public:
+        // Names that are not lazy functions, kept until the registry changes
+        static constexpr size_t MAX_MISS_COUNT = 256;
+
+    protected:
+        struct CachedFunction
+        {
+            CefString funcKey;
+            // Same function object on every access
+            CefRefPtr<CefV8Value> value = nullptr;
+            // Checked again when the registry has changed since (see CEFFunctionHandler::GetChangeCount)
+            std::uint64_t changeCount = 0;
+        };
+
+        CefRefPtr<CEFFunctionHandler> m_funcHandler = nullptr;
+        std::string m_objectName;
+        // Keyed by the V8 property name, so an access doesn't convert or build strings
+        std::map<CefString, CachedFunction> m_funcCache;
+        std::set<CefString> m_missNames;
+        std::uint64_t m_missChangeCount = 0;
+
+    public:
+        CEFNamespaceInterceptor(CefRefPtr<CEFFunctionHandler> a_funcHandler, std::string_view a_objectName);
+
+        /// <summary>
+        /// Creates the namespace object, its user data is the function handler (see IsLazyNamespace)
+        /// </summary>
+        static CefRefPtr<CefV8Value> CreateNamespace(CefRefPtr<CEFFunctionHandler> a_funcHandler, std::string_view a_objectName);
+        static bool IsLazyNamespace(const CefRefPtr<CefV8Value>& a_object, const CefRefPtr<CEFFunctionHandler>& a_funcHandler);
+
+        // CefV8Interceptor
+        bool Get(const CefString& name,
+                 const CefRefPtr<CefV8Value> object,
+                 CefRefPtr<CefV8Value>& retval,
+                 CefString& exception) override;
+        bool Get(int index,
+                 const CefRefPtr<CefV8Value> object,
+                 CefRefPtr<CefV8Value>& retval,
+                 CefString& exception) override;
+        bool Set(const CefString& name,
+                 const CefRefPtr<CefV8Value> object,
+                 const CefRefPtr<CefV8Value> value,
+                 CefString& exception) override;
+        bool Set(int index,
+                 const CefRefPtr<CefV8Value> object,
+                 const CefRefPtr<CefV8Value> value,
+                 CefString& exception) override;
+    };
+}
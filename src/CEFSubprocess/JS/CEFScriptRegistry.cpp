@@ -0,0 +1,157 @@
+#include "CEFScriptRegistry.h"
+
+namespace NL::JS
+{
+    CefRefPtr<CefV8Value> CEFScriptRegistry::ReadArg(NL::IPC::PayloadReader& a_reader)
+    {
+        NL::IPC::PayloadTag tag;
+        if (!a_reader.ReadTag(tag))
+        {
+            return nullptr;
+        }
+
+        switch (tag)
+        {
+        case NL::IPC::PayloadTag::Null:
+            return CefV8Value::CreateNull();
+        case NL::IPC::PayloadTag::Bool: {
+            std::uint8_t value = 0;
+            return a_reader.ReadRaw(value) ? CefV8Value::CreateBool(value != 0) : nullptr;
+        }
+        case NL::IPC::PayloadTag::Int: {
+            std::int32_t value = 0;
+            return a_reader.ReadRaw(value) ? CefV8Value::CreateInt(value) : nullptr;
+        }
+        case NL::IPC::PayloadTag::Double: {
+            double value = 0;
+            return a_reader.ReadRaw(value) ? CefV8Value::CreateDouble(value) : nullptr;
+        }
+        case NL::IPC::PayloadTag::String: {
+            std::string_view value;
+            return a_reader.ReadString(value) ? CefV8Value::CreateString(NL::IPC::ToCefString(value)) : nullptr;
+        }
+        default:
+            return nullptr;
+        }
+    }
+
+    bool CEFScriptRegistry::Compile(Script& a_script, const CefRefPtr<CefV8Context>& a_context)
+    {
+        // A failed script is not compiled again in this context
+        a_script.context = a_context;
+        a_script.function = nullptr;
+
+        CefRefPtr<CefV8Value> result = nullptr;
+        CefRefPtr<CefV8Exception> exception = nullptr;
+        // Parentheses make "function (a) {}" an expression, the line break keeps a trailing line comment from eating them
+        if (!a_context->Eval("(" + a_script.source + "\n)", a_script.name, 1, result, exception) || result == nullptr)
+        {
+            spdlog::error("{}[{}]: can't compile script \"{}\": {}", NameOf(CEFScriptRegistry::Compile), ::GetCurrentProcessId(), a_script.name, exception != nullptr ? exception->GetMessage().ToString() : "unknown error"s);
+            return false;
+        }
+
+        if (!result->IsFunction())
+        {
+            spdlog::error("{}[{}]: script \"{}\" is not a function", NameOf(CEFScriptRegistry::Compile), ::GetCurrentProcessId(), a_script.name);
+            return false;
+        }
+
+        a_script.function = result;
+        return true;
+    }
+
+    void CEFScriptRegistry::SetScript(int a_browserId, std::uint32_t a_scriptId, std::string a_name, std::string a_source)
+    {
+        auto& script = s_scriptMap[std::make_pair(a_browserId, a_scriptId)];
+        script.name = std::move(a_name);
+        script.source = std::move(a_source);
+        // Compiled again on the next call
+        script.context = nullptr;
+        script.function = nullptr;
+    }
+
+    void CEFScriptRegistry::RemoveBrowser(int a_browserId)
+    {
+        for (auto it = s_scriptMap.begin(); it != s_scriptMap.end();)
+        {
+            it = it->first.first == a_browserId ? s_scriptMap.erase(it) : std::next(it);
+        }
+    }
+
+    void CEFScriptRegistry::RemoveContext(CefRefPtr<CefV8Context> a_context)
+    {
+        for (auto& [key, script] : s_scriptMap)
+        {
+            if (script.context != nullptr && script.context->IsSame(a_context))
+            {
+                script.context = nullptr;
+                script.function = nullptr;
+            }
+        }
+    }
+
+    void CEFScriptRegistry::Call(CefRefPtr<CefBrowser> a_browser, const void* a_payload, size_t a_size)
+    {
+        NL::IPC::PayloadReader reader(a_payload, a_size);
+        std::uint32_t scriptId = 0;
+        std::uint32_t argCount = 0;
+        if (!reader.ReadRaw(scriptId) || !reader.ReadRaw(argCount))
+        {
+            spdlog::error("{}[{}]: malformed script call payload", NameOf(CEFScriptRegistry::Call), ::GetCurrentProcessId());
+            return;
+        }
+
+        const auto it = s_scriptMap.find(std::make_pair(a_browser->GetIdentifier(), scriptId));
+        if (it == s_scriptMap.end())
+        {
+            spdlog::warn("{}[{}]: no script with id {}", NameOf(CEFScriptRegistry::Call), ::GetCurrentProcessId(), scriptId);
+            return;
+        }
+
+        const auto context = a_browser->GetMainFrame()->GetV8Context();
+        if (context == nullptr)
+        {
+            return;
+        }
+
+        NL::CEF::CEFV8ContextGuard v8ContextGuard(context);
+        if (!v8ContextGuard.IsEntered())
+        {
+            spdlog::error("{}[{}]: can't enter v8 context", NameOf(CEFScriptRegistry::Call), ::GetCurrentProcessId());
+            return;
+        }
+
+        CefV8ValueList arguments;
+        arguments.reserve(std::min<std::uint32_t>(argCount, 64));
+        for (std::uint32_t i = 0; i < argCount; ++i)
+        {
+            auto value = ReadArg(reader);
+            if (value == nullptr)
+            {
+                spdlog::error("{}[{}]: malformed argument {} of script \"{}\"", NameOf(CEFScriptRegistry::Call), ::GetCurrentProcessId(), i, it->second.name);
+                return;
+            }
+            arguments.push_back(std::move(value));
+        }
+
+        auto& script = it->second;
+        if (script.context == nullptr || !script.context->IsSame(context))
+        {
+            if (!Compile(script, context))
+            {
+                return;
+            }
+        }
+        else if (script.function == nullptr)
+        {
+            return;
+        }
+
+        script.function->ExecuteFunction(nullptr, arguments);
+        if (script.function->HasException())
+        {
+            spdlog::error("{}[{}]: script \"{}\" failed: {}", NameOf(CEFScriptRegistry::Call), ::GetCurrentProcessId(), script.name, script.function->GetException()->GetMessage().ToString());
+            script.function->ClearException();
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "PCH.h"
+#include "CEF/CEFV8ContextGuard.h"
+#include "IPCSharedPayload.h"
+
+namespace NL::JS
+{
+    /// <summary>
+    /// Named scripts set by IPC_JS_SCRIPT_REGISTER_EVENT. A script source is a function expression that is compiled
+    /// on the first call in a context and cached until the context is released.
+    /// Renderer thread only
+    /// </summary>
+    class CEFScriptRegistry final
+    {
+      private:
+        struct Script
+        {
+            std::string name;
+            std::string source;
+            CefRefPtr<CefV8Context> context = nullptr;
+            CefRefPtr<CefV8Value> function = nullptr;
+        };
+
+        // (browser id, script id) -> script
+        static inline std::map<std::pair<int, std::uint32_t>, Script> s_scriptMap;
+
+        static CefRefPtr<CefV8Value> ReadArg(NL::IPC::PayloadReader& a_reader);
+        static bool Compile(Script& a_script, const CefRefPtr<CefV8Context>& a_context);
+
+      public:
+        static void SetScript(int a_browserId, std::uint32_t a_scriptId, std::string a_name, std::string a_source);
+        static void RemoveBrowser(int a_browserId);
+        static void RemoveContext(CefRefPtr<CefV8Context> a_context);
+
+        /// <summary>
+        /// Calls the script in the main frame. Payload: [u32 scriptId][u32 argCount][tagged value]...
+        /// Only scalar and string tags are accepted
+        /// </summary>
+        static void Call(CefRefPtr<CefBrowser> a_browser, const void* a_payload, size_t a_size);
+    };
+}
@@ -0,0 +1,84 @@
+#include "CEFStateAccessor.h"
+
+namespace NL::JS
+{
+    CEFStateAccessor::CEFStateAccessor(std::string_view a_mappingName, NL::IPC::StateLayout&& a_layout)
+    {
+        m_mappingName = a_mappingName;
+        m_layout = std::move(a_layout);
+        m_fieldIndexMap.reserve(m_layout.fields.size());
+        for (size_t i = 0; i < m_layout.fields.size(); ++i)
+        {
+            m_fieldIndexMap.try_emplace(m_layout.fields[i].name, i);
+        }
+    }
+
+    bool CEFStateAccessor::Open()
+    {
+        const auto blockSize = NL::IPC::StateBlock::GetBlockSize(m_layout.dataSize);
+        return m_mapping.Open(m_mappingName, blockSize, true) && m_block.Attach(m_mapping.GetMemory(), m_mapping.GetSize(), m_layout.dataSize);
+    }
+
+    const std::string& CEFStateAccessor::GetMappingName() const
+    {
+        return m_mappingName;
+    }
+
+    CefRefPtr<CefV8Value> CEFStateAccessor::CreateObject()
+    {
+        auto object = CefV8Value::CreateObject(this, nullptr);
+        for (const auto& field : m_layout.fields)
+        {
+            object->SetValue(field.name, V8_PROPERTY_ATTRIBUTE_READONLY);
+        }
+        return object;
+    }
+
+    bool CEFStateAccessor::Get(const CefString& name,
+                               const CefRefPtr<CefV8Value> object,
+                               CefRefPtr<CefV8Value>& retval,
+                               CefString& exception)
+    {
+        const auto it = m_fieldIndexMap.find(name.ToString());
+        if (it == m_fieldIndexMap.end())
+        {
+            return false;
+        }
+
+        const auto& field = m_layout.fields[it->second];
+        double value = 0;
+        if (!m_block.ReadValue(field, value))
+        {
+            exception = "can't read state field \"" + field.name + "\"";
+            return true;
+        }
+
+        switch (field.type)
+        {
+        case NL::IPC::EventFieldType::Int32:
+            retval = CefV8Value::CreateInt(static_cast<std::int32_t>(value));
+            break;
+        case NL::IPC::EventFieldType::Bool:
+            retval = CefV8Value::CreateBool(value != 0.0);
+            break;
+        default:
+            retval = CefV8Value::CreateDouble(value);
+            break;
+        }
+        return true;
+    }
+
+    bool CEFStateAccessor::Set(const CefString& name,
+                               const CefRefPtr<CefV8Value> object,
+                               const CefRefPtr<CefV8Value> value,
+                               CefString& exception)
+    {
+        if (!m_fieldIndexMap.contains(name.ToString()))
+        {
+            return false;
+        }
+
+        exception = "state field \"" + name.ToString() + "\" is read-only";
+        return true;
+    }
+}
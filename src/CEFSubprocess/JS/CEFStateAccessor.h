@@ -0,0 +1,48 @@
+#pragma once
+
+#include "PCH.h"
+#include "IPCStateBlock.h"
+#include "IPCSharedMapping.h"
+
+namespace NL::JS
+{
+    /// <summary>
+    /// Accessor of a state object, every property read copies the field out of the shared state block.
+    /// Owns the mapping, so it stays valid while a JS object still uses this accessor
+    /// </summary>
+    class CEFStateAccessor : public CefV8Accessor
+    {
+        IMPLEMENT_REFCOUNTING(CEFStateAccessor);
+
+    protected:
+        std::string m_mappingName;
+        NL::IPC::StateLayout m_layout;
+        std::unordered_map<std::string, size_t> m_fieldIndexMap;
+        NL::IPC::SharedMapping m_mapping;
+        NL::IPC::StateBlock m_block;
+
+    public:
+        CEFStateAccessor(std::string_view a_mappingName, NL::IPC::StateLayout&& a_layout);
+
+        /// <summary>
+        /// Opens the mapping read-only
+        /// </summary>
+        bool Open();
+        const std::string& GetMappingName() const;
+
+        /// <summary>
+        /// Creates an object with a read-only property per field, must be called in a context
+        /// </summary>
+        CefRefPtr<CefV8Value> CreateObject();
+
+        // CefV8Accessor
+        bool Get(const CefString& name,
+                 const CefRefPtr<CefV8Value> object,
+                 CefRefPtr<CefV8Value>& retval,
+                 CefString& exception) override;
+        bool Set(const CefString& name,
+                 const CefRefPtr<CefV8Value> object,
+                 const CefRefPtr<CefV8Value> value,
+                 CefString& exception) override;
+    };
+}
@@ -0,0 +1,66 @@
+#include "CEFStateRegistry.h"
+
+namespace NL::JS
+{
+    void CEFStateRegistry::Bind(const CefRefPtr<CefV8Context>& a_context, const std::string& a_objectName, const CefRefPtr<CEFStateAccessor>& a_accessor)
+    {
+        a_context->GetGlobal()->SetValue(a_objectName, a_accessor->CreateObject(), V8_PROPERTY_ATTRIBUTE_NONE);
+    }
+
+    void CEFStateRegistry::SetState(CefRefPtr<CefBrowser> a_browser, const std::string& a_objectName, const std::string& a_mappingName, const void* a_layout, size_t a_layoutSize)
+    {
+        const auto key = std::make_pair(a_browser->GetIdentifier(), a_objectName);
+        if (const auto it = s_stateMap.find(key); it != s_stateMap.end() && it->second->GetMappingName() == a_mappingName)
+        {
+            return;
+        }
+
+        NL::IPC::StateLayout layout;
+        if (!NL::IPC::StateLayout::Deserialize(a_layout, a_layoutSize, layout) || layout.fields.empty())
+        {
+            spdlog::error("{}[{}]: malformed layout of state object \"{}\"", NameOf(CEFStateRegistry::SetState), ::GetCurrentProcessId(), a_objectName);
+            return;
+        }
+
+        CefRefPtr<CEFStateAccessor> accessor = new CEFStateAccessor(a_mappingName, std::move(layout));
+        if (!accessor->Open())
+        {
+            spdlog::error("{}[{}]: can't open shared memory \"{}\" of state object \"{}\", error {}", NameOf(CEFStateRegistry::SetState), ::GetCurrentProcessId(), a_mappingName, a_objectName, ::GetLastError());
+            return;
+        }
+
+        // JS references to the replaced object keep its mapping open
+        s_stateMap[key] = accessor;
+
+        const auto context = a_browser->GetMainFrame()->GetV8Context();
+        if (context == nullptr)
+        {
+            return;
+        }
+
+        NL::CEF::CEFV8ContextGuard v8ContextGuard(context);
+        if (v8ContextGuard.IsEntered())
+        {
+            Bind(context, a_objectName, accessor);
+        }
+    }
+
+    std::uint32_t CEFStateRegistry::BindAll(int a_browserId, const CefRefPtr<CefV8Context>& a_context)
+    {
+        std::uint32_t boundCount = 0;
+        for (auto it = s_stateMap.lower_bound(std::make_pair(a_browserId, std::string())); it != s_stateMap.end() && it->first.first == a_browserId; ++it)
+        {
+            Bind(a_context, it->first.second, it->second);
+            ++boundCount;
+        }
+        return boundCount;
+    }
+
+    void CEFStateRegistry::RemoveBrowser(int a_browserId)
+    {
+        for (auto it = s_stateMap.begin(); it != s_stateMap.end();)
+        {
+            it = it->first.first == a_browserId ? s_stateMap.erase(it) : std::next(it);
+        }
+    }
+}
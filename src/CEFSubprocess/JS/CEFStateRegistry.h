@@ -0,0 +1,32 @@
+#pragma once
+
+#include "PCH.h"
+#include "CEF/CEFV8ContextGuard.h"
+#include "JS/CEFStateAccessor.h"
+
+namespace NL::JS
+{
+    /// <summary>
+    /// State objects set by IPC_JS_STATE_REGISTER_EVENT, bound as window[objectName] in the main frame of every new context.
+    /// Renderer thread only
+    /// </summary>
+    class CEFStateRegistry final
+    {
+      private:
+        // (browser id, object name) -> accessor
+        static inline std::map<std::pair<int, std::string>, CefRefPtr<CEFStateAccessor>> s_stateMap;
+
+        static void Bind(const CefRefPtr<CefV8Context>& a_context, const std::string& a_objectName, const CefRefPtr<CEFStateAccessor>& a_accessor);
+
+      public:
+        /// <summary>
+        /// Opens the mapping and binds the object in the current main frame context. Nothing changes if the mapping is already open
+        /// </summary>
+        static void SetState(CefRefPtr<CefBrowser> a_browser, const std::string& a_objectName, const std::string& a_mappingName, const void* a_layout, size_t a_layoutSize);
+        /// <summary>
+        /// Must be called in a_context
+        /// </summary>
+        static std::uint32_t BindAll(int a_browserId, const CefRefPtr<CefV8Context>& a_context);
+        static void RemoveBrowser(int a_browserId);
+    };
+}
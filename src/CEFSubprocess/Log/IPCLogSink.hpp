@@ -1,78 +1,54 @@
 #pragma once
 
 #include "PCH.h"
+#include "IPCLogRing.h"
+#include "IPCSharedMapping.h"
 
 namespace NL::Log
 {
+    /// <summary>
+    /// Writes log records into a shared memory ring that the browser process drains (see IPC_LOG_RING_EVENT).
+    /// Never blocks and never sends a message, records are dropped while the ring is full
+    /// </summary>
     template<class Mutex>
     class IPCLogSink : public spdlog::sinks::base_sink<Mutex>
     {
-        struct LogMsg
-        {
-            spdlog::level::level_enum level;
-            std::string msg;
-        };
-
     protected:
-        CefRefPtr<CefBrowser> m_browser = nullptr;
-        std::queue<LogMsg> m_delayedMsgQueue;
-
-        bool SendProcessMessage(const CefRefPtr<CefBrowser> browser, const spdlog::level::level_enum level, const char* msg)
-        {
-            if (browser != nullptr && browser->IsValid())
-            {
-                const auto mainFrame = browser->GetMainFrame();
-                if (mainFrame != nullptr && mainFrame->IsValid())
-                {
-                    auto message = CefProcessMessage::Create(IPC_LOG_EVENT);
-                    auto argList = message->GetArgumentList();
-                    argList->SetInt(0, level);
-                    argList->SetString(1, msg);
-                    mainFrame->SendProcessMessage(PID_BROWSER, message);
-
-                    return true;
-                }
-            }
-
-            return false;
-        }
+        std::string m_mappingName;
+        NL::IPC::SharedMapping m_mapping;
+        NL::IPC::LogRing m_ring;
 
         void sink_it_(const spdlog::details::log_msg& msg) override
         {
-            if (!SendProcessMessage(m_browser, msg.level, msg.payload.data()))
-            {
-                m_delayedMsgQueue.emplace(msg.level, msg.payload.data());
-            }
+            m_ring.Write(static_cast<std::uint8_t>(msg.level), std::string_view(msg.payload.data(), msg.payload.size()));
         }
 
-        void flush_() override
-        {
-            while (!m_delayedMsgQueue.empty())
-            {
-                const auto& msg = m_delayedMsgQueue.front();
-                if (!SendProcessMessage(m_browser, msg.level, msg.msg.data()))
-                {
-                    return;
-                }
-
-                m_delayedMsgQueue.pop();
-            }
-        };
-
+        void flush_() override {};
         void set_pattern_(const std::string& pattern) override {};
         void set_formatter_(std::unique_ptr<spdlog::formatter> sink_formatter) override {};
 
     public:
-        IPCLogSink(CefRefPtr<CefBrowser> a_browser)
+        /// <summary>
+        /// Creates the ring, check IsValid()
+        /// </summary>
+        IPCLogSink(std::string_view a_mappingName, std::uint32_t a_capacity = NL::IPC::LogRing::DEFAULT_CAPACITY)
         {
-            m_browser = a_browser;
+            m_mappingName = a_mappingName;
+            if (m_mapping.Create(m_mappingName, NL::IPC::LogRing::GetMappingSize(a_capacity)))
+            {
+                m_ring.Initialize(m_mapping.GetMemory(), m_mapping.GetSize(), a_capacity);
+            }
         }
         IPCLogSink(IPCLogSink&&) = delete;
 
-        void SetBrowser(CefRefPtr<CefBrowser> a_browser)
+        bool IsValid() const
+        {
+            return m_ring.IsValid();
+        }
+
+        const std::string& GetMappingName() const
         {
-            std::lock_guard locker(this->mutex_);
-            m_browser = a_browser;
+            return m_mappingName;
         }
     };
 
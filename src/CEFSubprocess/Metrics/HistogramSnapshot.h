@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+namespace NL::Metrics
+{
+    /// <summary>
+    /// Log2 histogram of microsecond samples, plain values. Live histograms (NL::Common::LatencyHistogram, MetricTable)
+    /// use its bucket layout and take snapshots for percentiles and reports
+    /// </summary>
+    struct HistogramSnapshot
+    {
+        // Bucket i holds samples in [2^i, 2^(i+1)) us, bucket 0 also holds zero
+        static constexpr size_t BUCKET_COUNT = 32;
+
+        std::array<std::uint64_t, BUCKET_COUNT> buckets{};
+        std::uint64_t count = 0;
+        std::uint64_t sum = 0;
+        std::uint64_t max = 0;
+
+        static size_t GetBucketIndex(std::uint64_t a_microseconds)
+        {
+            return a_microseconds == 0 ? 0 : std::min(static_cast<size_t>(std::bit_width(a_microseconds) - 1), BUCKET_COUNT - 1);
+        }
+
+        static std::uint64_t GetBucketUpperBound(size_t a_index)
+        {
+            return (std::uint64_t(1) << (a_index + 1)) - 1;
+        }
+
+        void Merge(const HistogramSnapshot& a_other)
+        {
+            for (size_t i = 0; i < BUCKET_COUNT; ++i)
+            {
+                buckets[i] += a_other.buckets[i];
+            }
+            count += a_other.count;
+            sum += a_other.sum;
+            max = std::max(max, a_other.max);
+        }
+
+        /// <summary>
+        /// Returns the upper bound (us) of the bucket containing the percentile, a_percentile is in [0, 1]
+        /// </summary>
+        std::uint64_t GetPercentile(double a_percentile) const
+        {
+            if (count == 0)
+            {
+                return 0;
+            }
+
+            const auto target = std::max<std::uint64_t>(static_cast<std::uint64_t>(std::ceil(std::clamp(a_percentile, 0.0, 1.0) * count)), 1);
+            std::uint64_t accumulated = 0;
+            for (size_t i = 0; i < BUCKET_COUNT; ++i)
+            {
+                accumulated += buckets[i];
+                if (accumulated >= target)
+                {
+                    return GetBucketUpperBound(i);
+                }
+            }
+
+            return GetBucketUpperBound(BUCKET_COUNT - 1);
+        }
+
+        std::string ToString() const
+        {
+            if (count == 0)
+            {
+                return "no samples";
+            }
+
+            return fmt::format("count {}, avg {}us, p50 <={}us, p90 <={}us, p99 <={}us, max {}us",
+                               count,
+                               sum / count,
+                               GetPercentile(0.5),
+                               GetPercentile(0.9),
+                               GetPercentile(0.99),
+                               max);
+        }
+    };
+}
@@ -0,0 +1,341 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include "IPCSharedPayload.h"
+#include "Metrics/HistogramSnapshot.h"
+
+namespace NL::Metrics
+{
+    /// <summary>
+    /// Counters of one function or message type, summed over all threads
+    /// </summary>
+    struct EntrySnapshot
+    {
+        static constexpr size_t TIMING_COUNT = 2;
+
+        std::uint64_t key = 0;
+        std::string name;
+        std::uint64_t count = 0;
+        std::uint64_t bytes = 0;
+        std::array<HistogramSnapshot, TIMING_COUNT> timings;
+    };
+
+    /// <summary>
+    /// Call counters, byte counters and up to two latency histograms per key.
+    /// Every thread writes only its own shard, so recording is a few relaxed stores without locks or read-modify-write.
+    /// Snapshots sum all shards. A shard and its entries are allocated on the first record of a thread and key
+    /// </summary>
+    class MetricTable
+    {
+      public:
+        static constexpr size_t TIMING_COUNT = EntrySnapshot::TIMING_COUNT;
+        static constexpr std::uint64_t NO_TIMING = std::numeric_limits<std::uint64_t>::max();
+        // Keys above this count per thread are summed into the overflow entry
+        static constexpr size_t SHARD_CAPACITY = 1024;
+        static constexpr std::uint64_t OVERFLOW_KEY = std::numeric_limits<std::uint64_t>::max();
+        // Tables above this count have no thread slot, their threads share one shard under a lock
+        static constexpr size_t MAX_TABLE_COUNT = 8;
+
+      protected:
+        // Written by the owner thread only
+        struct Counter
+        {
+            std::atomic_uint64_t value = 0;
+
+            void Add(std::uint64_t a_value)
+            {
+                value.store(value.load(std::memory_order_relaxed) + a_value, std::memory_order_relaxed);
+            }
+
+            std::uint64_t Get() const
+            {
+                return value.load(std::memory_order_relaxed);
+            }
+        };
+
+        struct Histogram
+        {
+            std::array<Counter, HistogramSnapshot::BUCKET_COUNT> buckets;
+            Counter count;
+            Counter sum;
+            Counter max;
+
+            void Add(std::uint64_t a_microseconds)
+            {
+                buckets[HistogramSnapshot::GetBucketIndex(a_microseconds)].Add(1);
+                count.Add(1);
+                sum.Add(a_microseconds);
+                if (max.Get() < a_microseconds)
+                {
+                    max.value.store(a_microseconds, std::memory_order_relaxed);
+                }
+            }
+
+            void AddTo(HistogramSnapshot& a_snapshot) const
+            {
+                HistogramSnapshot snapshot;
+                for (size_t i = 0; i < HistogramSnapshot::BUCKET_COUNT; ++i)
+                {
+                    snapshot.buckets[i] = buckets[i].Get();
+                }
+                snapshot.count = count.Get();
+                snapshot.sum = sum.Get();
+                snapshot.max = max.Get();
+                a_snapshot.Merge(snapshot);
+            }
+        };
+
+        struct Entry
+        {
+            std::uint64_t key = 0;
+            Counter count;
+            Counter bytes;
+            std::array<Histogram, TIMING_COUNT> timings;
+        };
+
+        struct Shard
+        {
+            // Open addressing by key, an entry is published once and never moves
+            std::array<std::atomic<Entry*>, SHARD_CAPACITY> entries{};
+            Entry overflowEntry{OVERFLOW_KEY};
+
+            ~Shard()
+            {
+                for (auto& entry : entries)
+                {
+                    delete entry.load(std::memory_order_relaxed);
+                }
+            }
+        };
+
+        static inline std::atomic<size_t> s_nextTableIndex = 0;
+
+        size_t m_tableIndex = 0;
+
+        // Shards outlive their threads, so counts of finished threads are kept
+        mutable std::mutex m_shardMutex;
+        std::vector<std::unique_ptr<Shard>> m_shards;
+
+        mutable std::mutex m_nameMutex;
+        std::map<std::uint64_t, std::string> m_nameMap;
+
+        static Shard*& GetThreadShard(size_t a_tableIndex)
+        {
+            thread_local std::array<Shard*, MAX_TABLE_COUNT> shards{};
+            return shards[a_tableIndex];
+        }
+
+        Shard& GetOrCreateThreadShard()
+        {
+            auto& shard = GetThreadShard(m_tableIndex);
+            if (shard == nullptr)
+            {
+                std::lock_guard locker(m_shardMutex);
+                shard = m_shards.emplace_back(std::make_unique<Shard>()).get();
+            }
+            return *shard;
+        }
+
+        bool HasThreadShards() const
+        {
+            return m_tableIndex < MAX_TABLE_COUNT;
+        }
+
+        void RecordEntry(Entry& a_entry, std::uint64_t a_bytes, std::uint64_t a_timing0Us, std::uint64_t a_timing1Us)
+        {
+            a_entry.count.Add(1);
+            a_entry.bytes.Add(a_bytes);
+            if (a_timing0Us != NO_TIMING)
+            {
+                a_entry.timings[0].Add(a_timing0Us);
+            }
+            if (a_timing1Us != NO_TIMING)
+            {
+                a_entry.timings[1].Add(a_timing1Us);
+            }
+        }
+
+        Entry& GetOrCreateEntry(Shard& a_shard, std::uint64_t a_key, std::string_view a_name)
+        {
+            auto index = static_cast<size_t>(a_key * 0x9E3779B97F4A7C15ull) % SHARD_CAPACITY;
+            for (size_t probe = 0; probe < SHARD_CAPACITY; ++probe, index = (index + 1) % SHARD_CAPACITY)
+            {
+                const auto entry = a_shard.entries[index].load(std::memory_order_relaxed);
+                if (entry == nullptr)
+                {
+                    if (!a_name.empty())
+                    {
+                        SetName(a_key, a_name);
+                    }
+
+                    const auto newEntry = new Entry{a_key};
+                    a_shard.entries[index].store(newEntry, std::memory_order_release);
+                    return *newEntry;
+                }
+
+                if (entry->key == a_key)
+                {
+                    return *entry;
+                }
+            }
+
+            return a_shard.overflowEntry;
+        }
+
+      public:
+        MetricTable()
+            : m_tableIndex(s_nextTableIndex.fetch_add(1))
+        {
+            if (!HasThreadShards())
+            {
+                m_shards.emplace_back(std::make_unique<Shard>());
+                spdlog::warn("{}: more than {} tables, recording of table {} is locked", NameOf(MetricTable), MAX_TABLE_COUNT, m_tableIndex);
+            }
+        }
+
+        MetricTable(const MetricTable&) = delete;
+        MetricTable& operator=(const MetricTable&) = delete;
+
+        /// <summary>
+        /// FNV-1a, the same in both processes
+        /// </summary>
+        static std::uint64_t MakeKey(std::string_view a_name)
+        {
+            std::uint64_t hash = 0xCBF29CE484222325ull;
+            for (const auto ch : a_name)
+            {
+                hash = (hash ^ static_cast<std::uint8_t>(ch)) * 0x100000001B3ull;
+            }
+            return hash;
+        }
+
+        void SetName(std::uint64_t a_key, std::string_view a_name)
+        {
+            std::lock_guard locker(m_nameMutex);
+            m_nameMap.insert_or_assign(a_key, std::string(a_name));
+        }
+
+        /// <summary>
+        /// a_name is only used when the key is recorded by this thread for the first time. Pass NO_TIMING to skip a timing
+        /// </summary>
+        void Record(std::uint64_t a_key, std::uint64_t a_bytes, std::uint64_t a_timing0Us, std::uint64_t a_timing1Us = NO_TIMING, std::string_view a_name = {})
+        {
+            if (!HasThreadShards())
+            {
+                std::lock_guard locker(m_shardMutex);
+                RecordEntry(GetOrCreateEntry(*m_shards.front(), a_key, a_name), a_bytes, a_timing0Us, a_timing1Us);
+                return;
+            }
+
+            RecordEntry(GetOrCreateEntry(GetOrCreateThreadShard(), a_key, a_name), a_bytes, a_timing0Us, a_timing1Us);
+        }
+
+        /// <summary>
+        /// Sums all shards, entries are sorted by key
+        /// </summary>
+        std::vector<EntrySnapshot> TakeSnapshot() const
+        {
+            std::map<std::uint64_t, EntrySnapshot> entryMap;
+            const auto addEntry = [&](const Entry& a_entry) {
+                auto& snapshot = entryMap[a_entry.key];
+                snapshot.key = a_entry.key;
+                snapshot.count += a_entry.count.Get();
+                snapshot.bytes += a_entry.bytes.Get();
+                for (size_t i = 0; i < TIMING_COUNT; ++i)
+                {
+                    a_entry.timings[i].AddTo(snapshot.timings[i]);
+                }
+            };
+
+            {
+                std::lock_guard locker(m_shardMutex);
+                for (const auto& shard : m_shards)
+                {
+                    for (const auto& entry : shard->entries)
+                    {
+                        if (const auto entryPtr = entry.load(std::memory_order_acquire); entryPtr != nullptr)
+                        {
+                            addEntry(*entryPtr);
+                        }
+                    }
+
+                    if (shard->overflowEntry.count.Get() > 0)
+                    {
+                        addEntry(shard->overflowEntry);
+                    }
+                }
+            }
+
+            std::vector<EntrySnapshot> result;
+            result.reserve(entryMap.size());
+            std::lock_guard locker(m_nameMutex);
+            for (auto& [key, snapshot] : entryMap)
+            {
+                const auto nameIt = m_nameMap.find(key);
+                snapshot.name = key == OVERFLOW_KEY ? "<other>" : nameIt != m_nameMap.end() ? nameIt->second : fmt::format("{:#x}", key);
+                result.push_back(std::move(snapshot));
+            }
+
+            return result;
+        }
+
+        /// <summary>
+        /// [u32 entryCount]([u64 key][string name][u64 count][u64 bytes]([u64 count][u64 sum][u64 max][u64 bucket]...)...)...
+        /// </summary>
+        static void Serialize(const std::vector<EntrySnapshot>& a_entries, std::string& a_out)
+        {
+            NL::IPC::AppendRaw(a_out, static_cast<std::uint32_t>(a_entries.size()));
+            for (const auto& entry : a_entries)
+            {
+                NL::IPC::AppendRaw(a_out, entry.key);
+                NL::IPC::AppendString(a_out, entry.name);
+                NL::IPC::AppendRaw(a_out, entry.count);
+                NL::IPC::AppendRaw(a_out, entry.bytes);
+                for (const auto& timing : entry.timings)
+                {
+                    NL::IPC::AppendRaw(a_out, timing.count);
+                    NL::IPC::AppendRaw(a_out, timing.sum);
+                    NL::IPC::AppendRaw(a_out, timing.max);
+                    for (const auto bucket : timing.buckets)
+                    {
+                        NL::IPC::AppendRaw(a_out, bucket);
+                    }
+                }
+            }
+        }
+
+        static bool Deserialize(NL::IPC::PayloadReader& a_reader, std::vector<EntrySnapshot>& a_outEntries)
+        {
+            std::uint32_t entryCount = 0;
+            if (!a_reader.ReadRaw(entryCount))
+            {
+                return false;
+            }
+
+            a_outEntries.clear();
+            for (std::uint32_t i = 0; i < entryCount && !a_reader.IsFailed(); ++i)
+            {
+                auto& entry = a_outEntries.emplace_back();
+                std::string_view name;
+                a_reader.ReadRaw(entry.key);
+                a_reader.ReadString(name);
+                entry.name = name;
+                a_reader.ReadRaw(entry.count);
+                a_reader.ReadRaw(entry.bytes);
+                for (auto& timing : entry.timings)
+                {
+                    a_reader.ReadRaw(timing.count);
+                    a_reader.ReadRaw(timing.sum);
+                    a_reader.ReadRaw(timing.max);
+                    for (auto& bucket : timing.buckets)
+                    {
+                        a_reader.ReadRaw(bucket);
+                    }
+                }
+            }
+
+            return !a_reader.IsFailed();
+        }
+    };
+}
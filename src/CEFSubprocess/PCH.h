@@ -14,6 +14,7 @@
 #include <functional>
 #include <iomanip>
 #include <map>
+#include <set>
 #include <mutex>
 #include <sstream>
 #include <thread>
@@ -22,6 +23,10 @@
 #include <deque>
 #include <type_traits>
 #include <queue>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <cmath>
 
 // spdlog
 #include <spdlog/spdlog.h>
@@ -15,17 +15,23 @@ namespace NL::CEF
         ThrowIfNullptr(DefaultBrowser, a_jsFuncStorage);
         m_jsFuncStorage = a_jsFuncStorage;
 
+        m_eventBatch = std::make_shared<JSEventBatch>(m_cefClient);
+
         ZeroMemory(&m_lastCefMouseEvent, sizeof(CefMouseEvent));
+        m_inputLatencyTracker = m_cefClient->GetInputLatencyTracker();
 
         m_keyInputConverter.OnKeyDown.connect([&](CefKeyEvent& a_keyEvent) {
+            m_inputLatencyTracker->OnInputForwarded();
             m_cefClient->GetBrowser()->GetHost()->SendKeyEvent(a_keyEvent);
         });
 
         m_keyInputConverter.OnKeyUp.connect([&](CefKeyEvent& a_keyEvent) {
+            m_inputLatencyTracker->OnInputForwarded();
             m_cefClient->GetBrowser()->GetHost()->SendKeyEvent(a_keyEvent);
         });
 
         m_keyInputConverter.OnChar.connect([&](CefKeyEvent& a_keyEvent) {
+            m_inputLatencyTracker->OnInputForwarded();
             m_cefClient->GetBrowser()->GetHost()->SendKeyEvent(a_keyEvent);
         });
 
@@ -36,24 +42,137 @@ namespace NL::CEF
             }
         });
 
+        m_onAsyncCallDropped_Connection = m_jsFuncStorage->OnAsyncCallDropped.connect([&](std::uint64_t a_token) {
+            SendAsyncCallResult(a_token, IPC_JS_ASYNC_RESULT_ERROR, "native callback queue is full");
+        });
+
         m_onIPCMessageReceived_Connection = m_cefClient->onIPCMessageReceived.connect([&, a_jsFuncStorage](CefRefPtr<CefProcessMessage> a_message) {
+            const auto receiveTime = std::chrono::steady_clock::now();
             if (a_message->GetName() == IPC_JS_FUNCTION_CALL_EVENT)
             {
                 const auto ipcArgs = a_message->GetArgumentList();
-                const auto objName = ipcArgs->GetString(0).ToString();
-                const auto funcName = ipcArgs->GetString(1).ToString();
-                const auto argList = ipcArgs->GetList(2);
+                auto callBuffer = NL::JS::JSCallBufferPool::GetSingleton().Acquire();
+                callBuffer->receiveTime = receiveTime;
+                callBuffer->funcId = static_cast<std::uint32_t>(ipcArgs->GetInt(0));
+                callBuffer->asyncCallId = ipcArgs->GetSize() > 2 ? static_cast<std::uint32_t>(ipcArgs->GetInt(2)) : 0;
+                callBuffer->asyncGeneration = m_asyncCallGeneration;
+                NL::Converters::CefValueToJSONConverter::WriteCallArgs(ipcArgs->GetList(1), *callBuffer);
+
+                m_jsFuncStorage->ExecuteFunctionCallback(std::move(callBuffer), a_jsFuncStorage);
+            }
+            else if (a_message->GetName() == IPC_JS_FUNCTION_CALL_SHARED_EVENT)
+            {
+                const auto region = a_message->GetSharedMemoryRegion();
+                if (region == nullptr || !region->IsValid())
+                {
+                    return;
+                }
+
+                auto callBuffer = NL::JS::JSCallBufferPool::GetSingleton().Acquire();
+                callBuffer->receiveTime = receiveTime;
+                callBuffer->SetSharedRegion(region);
+                if (!NL::Converters::IPCPayloadToJSONConverter::WriteCallArgs(region->Memory(), region->Size(), *callBuffer))
+                {
+                    m_logger->error("{}: malformed shared function call payload", NameOf(DefaultBrowser));
+                    NL::JS::JSCallBufferPool::GetSingleton().Release(std::move(callBuffer));
+                    return;
+                }
+                callBuffer->asyncGeneration = m_asyncCallGeneration;
+
+                m_jsFuncStorage->ExecuteFunctionCallback(std::move(callBuffer), a_jsFuncStorage);
+            }
+            else if (a_message->GetName() == IPC_JS_FUNCTION_CALL_BATCH_EVENT)
+            {
+                const void* payload = nullptr;
+                size_t payloadSize = 0;
+                CefRefPtr<CefBinaryValue> binaryPayload = nullptr;
+                const auto region = a_message->GetSharedMemoryRegion();
+                if (region != nullptr && region->IsValid())
+                {
+                    payload = region->Memory();
+                    payloadSize = region->Size();
+                }
+                else if (const auto ipcArgs = a_message->GetArgumentList(); ipcArgs != nullptr && ipcArgs->GetType(0) == VTYPE_BINARY)
+                {
+                    binaryPayload = ipcArgs->GetBinary(0);
+                    payload = binaryPayload->GetRawData();
+                    payloadSize = binaryPayload->GetSize();
+                }
+
+                // Calls are dispatched in order, game thread tasks keep it too
+                NL::IPC::PayloadReader reader(payload, payloadSize);
+                while (!reader.IsEnd())
+                {
+                    auto callBuffer = NL::JS::JSCallBufferPool::GetSingleton().Acquire();
+                    callBuffer->receiveTime = receiveTime;
+                    // Binary arguments of the argument list payload are copied, it is freed with the message
+                    if (binaryPayload == nullptr)
+                    {
+                        callBuffer->SetSharedRegion(region);
+                    }
+                    if (!NL::Converters::IPCPayloadToJSONConverter::ReadCall(reader, *callBuffer))
+                    {
+                        m_logger->error("{}: malformed function call batch payload", NameOf(DefaultBrowser));
+                        NL::JS::JSCallBufferPool::GetSingleton().Release(std::move(callBuffer));
+                        break;
+                    }
+                    callBuffer->asyncGeneration = m_asyncCallGeneration;
+
+                    m_jsFuncStorage->ExecuteFunctionCallback(std::move(callBuffer), a_jsFuncStorage);
+                }
+            }
+            else if (a_message->GetName() == IPC_METRICS_EVENT)
+            {
+                const auto browser = m_cefClient->GetBrowser();
+                if (browser == nullptr)
+                {
+                    return;
+                }
+
+                // Renderer counters are totals, the last snapshot replaces the previous one
+                const auto region = a_message->GetSharedMemoryRegion();
+                const auto ipcArgs = a_message->GetArgumentList();
+                auto isValid = false;
+                if (region != nullptr && region->IsValid())
+                {
+                    isValid = NL::Services::MetricsService::GetSingleton().SetRendererSnapshot(browser->GetIdentifier(), region->Memory(), region->Size());
+                }
+                else if (ipcArgs != nullptr && ipcArgs->GetType(0) == VTYPE_BINARY)
+                {
+                    const auto binaryPayload = ipcArgs->GetBinary(0);
+                    isValid = NL::Services::MetricsService::GetSingleton().SetRendererSnapshot(browser->GetIdentifier(), binaryPayload->GetRawData(), binaryPayload->GetSize());
+                }
 
-                const auto params = NL::Converters::CefValueToJSONConverter::ConvertToJSONStringArgs(argList);
-                m_jsFuncStorage->ExecuteFunctionCallback(objName, funcName, params, a_jsFuncStorage);
+                if (!isValid)
+                {
+                    m_logger->error("{}: malformed metrics payload", NameOf(DefaultBrowser));
+                }
+            }
+            else if (a_message->GetName() == IPC_JS_CONTEXT_CREATED)
+            {
+                // A new renderer process is seeded from the extra info of the browser, so its registry can be behind
+                const auto ipcArgs = a_message->GetArgumentList();
+                const auto rendererRevision = ipcArgs->GetType(0) == VTYPE_INT ? static_cast<std::uint32_t>(ipcArgs->GetInt(0)) : 0;
+                // Generation 0 is never used, a token with it is always stale
+                if (++m_asyncCallGeneration == 0)
+                {
+                    ++m_asyncCallGeneration;
+                }
+
+                std::lock_guard locker(m_urlMutex);
+                RemoveStaleFunctions();
+                if (rendererRevision != m_funcRegistryRevision)
+                {
+                    m_logger->info("{}: renderer function registry revision {} is not {}, sending all functions", NameOf(DefaultBrowser), rendererRevision, m_funcRegistryRevision);
+                    SendFunctionRegistry();
+                }
             }
-            else if (a_message->GetName() == IPC_LOG_EVENT)
+            else if (a_message->GetName() == IPC_LOG_RING_EVENT)
             {
-                const auto logger = spdlog::get(NL_UI_SUBPROC_NAME);
-                if (logger != nullptr)
+                const auto argList = a_message->GetArgumentList();
+                if (argList->GetType(0) == VTYPE_STRING && argList->GetType(1) == VTYPE_INT)
                 {
-                    auto argList = a_message->GetArgumentList();
-                    logger->log(static_cast<spdlog::level::level_enum>(argList->GetInt(0)), argList->GetString(1).ToString().c_str());
+                    NL::Services::SubprocessLogService::GetSingleton().AddRing(argList->GetString(0).ToString(), static_cast<DWORD>(argList->GetInt(1)));
                 }
             }
         });
@@ -61,54 +180,46 @@ namespace NL::CEF
         m_onAfterBrowserCreated_Connection = m_cefClient->onAfterBrowserCreated.connect([&](CefRefPtr<CefBrowser> a_cefBrowser) {
             std::lock_guard locker(m_urlMutex);
             // load url
-            if (m_isUrlCached)
+            if (const auto urlLoad = m_preloadOperationLog.TakeUrlLoad(); urlLoad.has_value())
             {
-                LoadBrowserURL(m_urlCache.c_str(), m_clearJSFunctions);
+                a_cefBrowser->GetMainFrame()->LoadURL(urlLoad->url);
             }
         });
 
         m_onMainFrameLoadStart_Connection = m_cefClient->onMainFrameLoadStart.connect([&]() {
             std::lock_guard locker(m_urlMutex);
             m_isPageLoaded = true;
+            RemoveStaleFunctions();
+            // Batched events belong to the previous page
+            m_eventBatch->Clear();
 
-            // Add js func callbacks
-            if (m_clearJSFunctions)
-            {
-                m_jsFuncStorage->ClearFunctionCallback();
-            }
-            else
+            // The page can be in a new renderer process
+            if (const auto browser = m_cefClient->GetBrowser(); browser != nullptr)
             {
-                const auto browser = m_cefClient->GetBrowser();
-                if (browser != nullptr && m_jsFuncStorage->GetSize() > 0)
+                std::lock_guard schemaLocker(m_eventSchemaMutex);
+                for (const auto& [eventName, schema] : m_eventSchemaMap)
                 {
-                    auto cefMessage = CefProcessMessage::Create(IPC_JS_FUNCION_ADD_EVENT);
-                    cefMessage->GetArgumentList()->SetDictionary(0, m_jsFuncStorage->ConvertToCefDictionary());
-                    browser->GetMainFrame()->SendProcessMessage(CefProcessId::PID_RENDERER, cefMessage);
+                    SendEventSchema(browser, eventName, schema);
                 }
-            }
 
-            for (auto& funcInfo : m_jsFuncCallbackInfoCache)
-            {
-                AddFunctionCallbackAndSendMessage(funcInfo);
-            }
-            m_jsFuncCallbackInfoCache.clear();
+                std::lock_guard scriptLocker(m_scriptMutex);
+                for (size_t i = 0; i < m_scripts.size(); ++i)
+                {
+                    SendScript(browser, static_cast<std::uint32_t>(i + 1), m_scripts[i]);
+                }
 
-            // Remove js func callbacks
-            for (auto& funcInfo : m_jsFuncRemoveCache)
-            {
-                RemoveFunctionCallbackAndSendMessage(std::get<0>(funcInfo).c_str(), std::get<1>(funcInfo).c_str());
+                std::lock_guard stateLocker(m_stateMutex);
+                for (const auto& state : m_states)
+                {
+                    SendState(browser, state);
+                }
             }
-            m_jsFuncRemoveCache.clear();
 
-            // JS exec scripts
-            if (!m_jsExecCache.empty())
+            // Registered functions are bound by the renderer registry when the main context is created (see IPC_JS_CONTEXT_CREATED).
+            // Scripts executed before the page was loaded
+            if (!m_preloadOperationLog.IsEmpty())
             {
-                for (auto& jsScript : m_jsExecCache)
-                {
-                    ExecuteJavaScript(std::get<0>(jsScript).c_str(), std::get<1>(jsScript).c_str());
-                }
-                m_jsExecCache.clear();
-                m_jsExecCache.shrink_to_fit();
+                SendPreloadOperations(m_preloadOperationLog.TakeOperations());
             }
 
             // Focus
@@ -121,6 +232,8 @@ namespace NL::CEF
 
     DefaultBrowser::~DefaultBrowser()
     {
+        NL::Services::HotkeyService::GetSingleton().UnbindAllChords(this);
+
         auto browser = m_cefClient->GetBrowser();
         if (browser != nullptr)
         {
@@ -130,40 +243,25 @@ namespace NL::CEF
         m_jsFuncStorage->ClearFunctionCallback();
     }
 
-    void DefaultBrowser::CheckToggleFocusKeys(const RE::ButtonEvent* a_event)
-    {
-        if (!a_event->IsDown() || m_toggleFocusKeyCode1 == 0 && m_toggleFocusKeyCode2 == 0)
-        {
-            return;
-        }
-
-        const auto keyboard = RE::BSInputDeviceManager::GetSingleton()->GetKeyboard();
-        const std::uint8_t* keyboardState = keyboard == nullptr ? nullptr : keyboard->curState;
-        if (
-            keyboardState != nullptr &&
-            (m_toggleFocusKeyCode1 == 0 || (keyboardState[m_toggleFocusKeyCode1] & 0x80) != 0) &&
-            (m_toggleFocusKeyCode2 == 0 || (keyboardState[m_toggleFocusKeyCode2] & 0x80) != 0))
-        {
-            SetBrowserFocused(!IsBrowserFocused());
-        }
-    }
-
-    void DefaultBrowser::CheckToggleVisibleKeys(const RE::ButtonEvent* a_event)
+    void DefaultBrowser::BindToggleHotkey(HotkeyAction a_action, const std::uint32_t a_keyCode1, const std::uint32_t a_keyCode2)
     {
-        if (!a_event->IsDown() || m_toggleVisibleKeyCode1 == 0 && m_toggleVisibleKeyCode2 == 0)
-        {
-            return;
-        }
+        auto& hotkeyService = NL::Services::HotkeyService::GetSingleton();
+        hotkeyService.UnbindChords(this, a_action);
 
-        const auto keyboard = RE::BSInputDeviceManager::GetSingleton()->GetKeyboard();
-        const std::uint8_t* keyboardState = keyboard == nullptr ? nullptr : keyboard->curState;
-        if (
-            keyboardState != nullptr &&
-            (m_toggleVisibleKeyCode1 == 0 || (keyboardState[m_toggleVisibleKeyCode1] & 0x80) != 0) &&
-            (m_toggleVisibleKeyCode2 == 0 || (keyboardState[m_toggleVisibleKeyCode2] & 0x80) != 0))
-        {
-            SetBrowserVisible(!IsBrowserVisible());
-        }
+        const std::array<std::uint32_t, 2> keyCodes{a_keyCode1, a_keyCode2};
+        hotkeyService.BindChord(this, a_action, keyCodes, [this, a_action]() {
+            switch (a_action)
+            {
+            case HotkeyAction::ToggleFocus:
+                SetBrowserFocused(!IsBrowserFocused());
+                break;
+            case HotkeyAction::ToggleVisible:
+                SetBrowserVisible(!IsBrowserVisible());
+                break;
+            default:
+                break;
+            }
+        });
     }
 
     CefRefPtr<NirnLabCefClient> DefaultBrowser::GetCefClient()
@@ -181,9 +279,37 @@ namespace NL::CEF
         return result;
     }
 
+    void DefaultBrowser::WriteFunctionRegistry(CefRefPtr<CefListValue> a_registry)
+    {
+        std::lock_guard locker(m_urlMutex);
+        a_registry->SetDictionary(0, m_jsFuncStorage->ConvertToCefDictionary());
+        a_registry->SetDictionary(1, m_jsFuncStorage->ConvertToCefDictionary(NL::JS::JSFunctionStorage::FunctionFilter::Batched));
+        a_registry->SetDictionary(2, m_jsFuncStorage->ConvertToCefDictionary(NL::JS::JSFunctionStorage::FunctionFilter::Async));
+        a_registry->SetDictionary(3, m_jsFuncStorage->ConvertToCefIdDictionary());
+        a_registry->SetDictionary(4, m_jsFuncStorage->ConvertToCefDictionary(NL::JS::JSFunctionStorage::FunctionFilter::Lazy));
+        a_registry->SetInt(IPC_JS_FUNCTION_ADD_REVISION_INDEX, static_cast<int>(m_funcRegistryRevision));
+    }
+
+    void DefaultBrowser::SendFunctionRegistry()
+    {
+        const auto browser = m_cefClient->GetBrowser();
+        if (browser != nullptr)
+        {
+            auto cefMessage = CefProcessMessage::Create(IPC_JS_FUNCION_ADD_EVENT);
+            WriteFunctionRegistry(cefMessage->GetArgumentList());
+            cefMessage->GetArgumentList()->SetBool(IPC_JS_FUNCTION_ADD_REPLACE_INDEX, true);
+            browser->GetMainFrame()->SendProcessMessage(CefProcessId::PID_RENDERER, cefMessage);
+        }
+    }
+
     void DefaultBrowser::AddFunctionCallbackAndSendMessage(const NL::JS::JSFuncInfo& a_callbackInfo)
     {
         m_jsFuncStorage->AddFunctionCallback(a_callbackInfo);
+        if (!m_staleFunctions.empty())
+        {
+            m_staleFunctions.erase({a_callbackInfo.objectName, a_callbackInfo.funcName});
+        }
+        ++m_funcRegistryRevision;
         const auto browser = m_cefClient->GetBrowser();
         if (browser != nullptr)
         {
@@ -193,6 +319,24 @@ namespace NL::CEF
             listValue->SetSize(1);
             listValue->SetString(0, a_callbackInfo.funcName);
             dictValue->SetList(a_callbackInfo.objectName, listValue);
+            if (a_callbackInfo.callbackData.batchCalls)
+            {
+                cefMessage->GetArgumentList()->SetDictionary(1, dictValue->Copy(false));
+            }
+            if (a_callbackInfo.callbackData.isAsync)
+            {
+                cefMessage->GetArgumentList()->SetDictionary(2, dictValue->Copy(false));
+            }
+            auto idDictValue = CefDictionaryValue::Create();
+            auto funcIdDictValue = CefDictionaryValue::Create();
+            funcIdDictValue->SetInt(a_callbackInfo.funcName, static_cast<int>(m_jsFuncStorage->GetFunctionId(a_callbackInfo.objectName, a_callbackInfo.funcName)));
+            idDictValue->SetDictionary(a_callbackInfo.objectName, funcIdDictValue);
+            cefMessage->GetArgumentList()->SetDictionary(3, idDictValue);
+            if (a_callbackInfo.callbackData.lazyBinding)
+            {
+                cefMessage->GetArgumentList()->SetDictionary(4, dictValue->Copy(false));
+            }
+            cefMessage->GetArgumentList()->SetInt(IPC_JS_FUNCTION_ADD_REVISION_INDEX, static_cast<int>(m_funcRegistryRevision));
             cefMessage->GetArgumentList()->SetDictionary(0, dictValue);
             browser->GetMainFrame()->SendProcessMessage(CefProcessId::PID_RENDERER, cefMessage);
         }
@@ -201,6 +345,16 @@ namespace NL::CEF
     void DefaultBrowser::RemoveFunctionCallbackAndSendMessage(const char* a_objectName, const char* a_funcName)
     {
         m_jsFuncStorage->RemoveFunctionCallback(a_objectName, a_funcName);
+        if (!m_staleFunctions.empty())
+        {
+            m_staleFunctions.erase({a_objectName, a_funcName});
+        }
+        SendFunctionRemoveMessage(a_objectName, a_funcName);
+    }
+
+    void DefaultBrowser::SendFunctionRemoveMessage(const char* a_objectName, const char* a_funcName)
+    {
+        ++m_funcRegistryRevision;
         const auto browser = m_cefClient->GetBrowser();
         if (browser != nullptr)
         {
@@ -208,13 +362,122 @@ namespace NL::CEF
             auto dictValue = CefDictionaryValue::Create();
             auto listValue = CefListValue::Create();
             listValue->SetSize(1);
-            listValue->SetString(0, a_objectName);
-            dictValue->SetList(a_funcName, listValue);
+            listValue->SetString(0, a_funcName);
+            dictValue->SetList(a_objectName, listValue);
             cefMessage->GetArgumentList()->SetDictionary(0, dictValue);
+            cefMessage->GetArgumentList()->SetInt(1, static_cast<int>(m_funcRegistryRevision));
             browser->GetMainFrame()->SendProcessMessage(CefProcessId::PID_RENDERER, cefMessage);
         }
     }
 
+    void DefaultBrowser::SendPreloadOperations(std::vector<PreloadOperationLog::ExecuteScriptOperation>&& a_operations)
+    {
+        const auto browser = m_cefClient->GetBrowser();
+        if (browser == nullptr)
+        {
+            return;
+        }
+
+        // [script, scriptUrl] per operation
+        const auto operationList = CefListValue::Create();
+        operationList->SetSize(a_operations.size());
+        for (size_t i = 0; i < a_operations.size(); ++i)
+        {
+            auto operationValue = CefListValue::Create();
+            operationValue->SetString(0, a_operations[i].script);
+            operationValue->SetString(1, a_operations[i].scriptUrl);
+            operationList->SetList(i, operationValue);
+        }
+
+        auto cefMessage = CefProcessMessage::Create(IPC_JS_PRELOAD_BATCH_EVENT);
+        cefMessage->GetArgumentList()->SetList(0, operationList);
+        browser->GetMainFrame()->SendProcessMessage(CefProcessId::PID_RENDERER, cefMessage);
+    }
+
+    void DefaultBrowser::RemoveStaleFunctions()
+    {
+        // The renderer has removed them from its registry on its own, the revision stays
+        for (const auto& [objectName, funcName] : m_staleFunctions)
+        {
+            m_jsFuncStorage->RemoveFunctionCallback(objectName, funcName);
+        }
+        m_staleFunctions.clear();
+    }
+
+    void DefaultBrowser::SendEventSchema(const CefRefPtr<CefBrowser>& a_browser, const std::string& a_eventName, const NL::IPC::EventSchema& a_schema)
+    {
+        auto cefMessage = CefProcessMessage::Create(IPC_JS_EVENT_SCHEMA_EVENT);
+        cefMessage->GetArgumentList()->SetString(0, a_eventName);
+        cefMessage->GetArgumentList()->SetList(1, a_schema.ToCefList());
+        a_browser->GetMainFrame()->SendProcessMessage(CefProcessId::PID_RENDERER, cefMessage);
+    }
+
+    void DefaultBrowser::SendScript(const CefRefPtr<CefBrowser>& a_browser, std::uint32_t a_scriptId, const ScriptInfo& a_script)
+    {
+        auto cefMessage = CefProcessMessage::Create(IPC_JS_SCRIPT_REGISTER_EVENT);
+        cefMessage->GetArgumentList()->SetInt(0, static_cast<int>(a_scriptId));
+        cefMessage->GetArgumentList()->SetString(1, a_script.name);
+        cefMessage->GetArgumentList()->SetString(2, a_script.source);
+        a_browser->GetMainFrame()->SendProcessMessage(CefProcessId::PID_RENDERER, cefMessage);
+    }
+
+    void DefaultBrowser::SendState(const CefRefPtr<CefBrowser>& a_browser, const StateInfo& a_state)
+    {
+        auto cefMessage = CefProcessMessage::Create(IPC_JS_STATE_REGISTER_EVENT);
+        cefMessage->GetArgumentList()->SetString(0, a_state.objectName);
+        cefMessage->GetArgumentList()->SetString(1, a_state.mappingName);
+        cefMessage->GetArgumentList()->SetBinary(2, CefBinaryValue::Create(a_state.layoutPayload.data(), a_state.layoutPayload.size()));
+        a_browser->GetMainFrame()->SendProcessMessage(CefProcessId::PID_RENDERER, cefMessage);
+    }
+
+    void DefaultBrowser::SendAsyncCallResult(std::uint64_t a_token, std::uint8_t a_resultType, std::string_view a_result)
+    {
+        const auto browser = m_cefClient->GetBrowser();
+        const auto asyncCallId = static_cast<std::uint32_t>(a_token);
+        const auto generation = static_cast<std::uint32_t>(a_token >> 32);
+        if (browser == nullptr || asyncCallId == 0 || generation == 0)
+        {
+            m_logger->warn("{}: can't complete async call {}", NameOf(DefaultBrowser), a_token);
+            return;
+        }
+
+        if (generation != m_asyncCallGeneration)
+        {
+            // The page that made the call is gone, its promise is already dropped
+            m_logger->debug("{}: async call {} belongs to a previous page", NameOf(DefaultBrowser), a_token);
+            return;
+        }
+
+        // [u32 asyncCallId][u8 resultType][string result]
+        thread_local std::string payload;
+        payload.clear();
+        NL::IPC::AppendRaw(payload, asyncCallId);
+        NL::IPC::AppendRaw(payload, a_resultType);
+        NL::IPC::AppendString(payload, a_result);
+
+        CefRefPtr<CefProcessMessage> message = nullptr;
+        if (payload.size() >= IPC_SHARED_PAYLOAD_THRESHOLD)
+        {
+            message = NL::IPC::CreateSharedMessage(IPC_JS_ASYNC_RESULT_EVENT, payload);
+        }
+
+        if (message == nullptr)
+        {
+            message = CefProcessMessage::Create(IPC_JS_ASYNC_RESULT_EVENT);
+            message->GetArgumentList()->SetBinary(0, CefBinaryValue::Create(payload.data(), payload.size()));
+        }
+
+        browser->GetMainFrame()->SendProcessMessage(CefProcessId::PID_RENDERER, message);
+    }
+
+    void DefaultBrowser::FlushEventBatch()
+    {
+        if (m_isEventBatching)
+        {
+            m_eventBatch->Flush();
+        }
+    }
+
 #pragma region IBrowser
 
     bool __cdecl DefaultBrowser::IsBrowserReady()
@@ -243,8 +506,7 @@ namespace NL::CEF
 
     void __cdecl DefaultBrowser::ToggleBrowserVisibleByKeys(const std::uint32_t a_keyCode1, const std::uint32_t a_keyCode2)
     {
-        m_toggleVisibleKeyCode1 = a_keyCode1 < sizeof(RE::BSInputDeviceManager::GetSingleton()->GetKeyboard()->curState) ? a_keyCode1 : 0;
-        m_toggleVisibleKeyCode2 = a_keyCode2 < sizeof(RE::BSInputDeviceManager::GetSingleton()->GetKeyboard()->curState) ? a_keyCode2 : 0;
+        BindToggleHotkey(HotkeyAction::ToggleVisible, a_keyCode1, a_keyCode2);
     }
 
     void __cdecl DefaultBrowser::SetBrowserFocused(bool a_value)
@@ -304,18 +566,31 @@ namespace NL::CEF
 
     void __cdecl DefaultBrowser::ToggleBrowserFocusByKeys(const std::uint32_t a_keyCode1, const std::uint32_t a_keyCode2)
     {
-        m_toggleFocusKeyCode1 = a_keyCode1 < sizeof(RE::BSInputDeviceManager::GetSingleton()->GetKeyboard()->curState) ? a_keyCode1 : 0;
-        m_toggleFocusKeyCode2 = a_keyCode2 < sizeof(RE::BSInputDeviceManager::GetSingleton()->GetKeyboard()->curState) ? a_keyCode2 : 0;
+        BindToggleHotkey(HotkeyAction::ToggleFocus, a_keyCode1, a_keyCode2);
     }
 
     void __cdecl DefaultBrowser::LoadBrowserURL(const char* a_url, bool a_clearJSFunctions)
     {
         std::lock_guard locker(m_urlMutex);
-        m_clearJSFunctions = a_clearJSFunctions;
+        // No page yet means no previous functions, the ones added before the first page are for it
+        const auto browser = m_cefClient->GetBrowser();
+        if (a_clearJSFunctions && browser != nullptr)
+        {
+            ++m_funcRegistryRevision;
+            // The live page keeps its functions until the new one commits. Functions added after this call are not stale
+            for (auto& funcName : m_jsFuncStorage->GetFunctionNames())
+            {
+                m_staleFunctions.insert(std::move(funcName));
+            }
+
+            auto cefMessage = CefProcessMessage::Create(IPC_JS_FUNCTION_CLEAR_EVENT);
+            cefMessage->GetArgumentList()->SetInt(0, static_cast<int>(m_funcRegistryRevision));
+            browser->GetMainFrame()->SendProcessMessage(CefProcessId::PID_RENDERER, cefMessage);
+        }
+
         if (!IsPageLoaded())
         {
-            m_isUrlCached = true;
-            m_urlCache = a_url;
+            m_preloadOperationLog.LoadUrl(a_url);
             return;
         }
 
@@ -329,7 +604,6 @@ namespace NL::CEF
         {
             m_logger->error("{}: can't get main frame to load url \"{}\"", NameOf(DefaultBrowser), a_url);
         }
-        m_isUrlCached = false;
     }
 
     void __cdecl DefaultBrowser::ExecuteJavaScript(const char* a_script, const char* a_scriptUrl)
@@ -337,18 +611,11 @@ namespace NL::CEF
         std::lock_guard locker(m_urlMutex);
         if (!IsPageLoaded())
         {
-            m_jsExecCache.push_back({a_script, a_scriptUrl});
-            return;
-        }
-
-        if (!m_jsExecCache.empty())
-        {
-            for (auto& jsScript : m_jsExecCache)
+            if (a_script != nullptr && !m_preloadOperationLog.ExecuteScript(a_script, a_scriptUrl != nullptr ? a_scriptUrl : ""))
             {
-                m_cefClient->GetBrowser()->GetMainFrame()->ExecuteJavaScript(std::get<0>(jsScript).c_str(), std::get<1>(jsScript).c_str(), 0);
+                m_logger->warn("{}: too many scripts before the page is loaded, script is dropped", NameOf(DefaultBrowser::ExecuteJavaScript));
             }
-            m_jsExecCache.clear();
-            m_jsExecCache.shrink_to_fit();
+            return;
         }
 
         if (a_script != nullptr)
@@ -358,64 +625,364 @@ namespace NL::CEF
     }
 
     void __cdecl DefaultBrowser::AddFunctionCallback(const NL::JS::JSFuncInfo& a_callbackInfo)
+    {
+        if (!NL::JS::JSFunctionStorage::IsValidFunctionName(a_callbackInfo.objectName, a_callbackInfo.funcName))
+        {
+            m_logger->error("{}: function name {}.{} is not valid, names can't be null or contain '.'",
+                            NameOf(DefaultBrowser::AddFunctionCallback),
+                            a_callbackInfo.objectName == nullptr ? "null" : a_callbackInfo.objectName,
+                            a_callbackInfo.funcName == nullptr ? "null" : a_callbackInfo.funcName);
+            return;
+        }
+
+        auto callbackInfo = a_callbackInfo;
+        callbackInfo.callbackData = NL::JS::JSFunctionStorage::GetSupportedCallbackData(a_callbackInfo.callbackData);
+
+        // Also before the page is loaded: the renderer registry binds it when the main context is created, before any page script runs
+        std::lock_guard locker(m_urlMutex);
+        AddFunctionCallbackAndSendMessage(callbackInfo);
+    }
+
+    void __cdecl DefaultBrowser::RemoveFunctionCallback(const char* a_objectName, const char* a_funcName)
     {
         std::lock_guard locker(m_urlMutex);
-        if (!IsPageLoaded())
+        RemoveFunctionCallbackAndSendMessage(a_objectName, a_funcName);
+    }
+
+    void __cdecl DefaultBrowser::RemoveFunctionCallback(const NL::JS::JSFuncInfo& a_callbackInfo)
+    {
+        RemoveFunctionCallback(a_callbackInfo.objectName, a_callbackInfo.funcName);
+    }
+
+    void __cdecl DefaultBrowser::ExecEventFunction(const char* a_eventName, const char* a_data)
+    {
+        const auto browser = m_cefClient->GetBrowser();
+        if (IsPageLoaded() && browser != nullptr)
         {
-            for (auto it = m_jsFuncRemoveCache.begin(); it != m_jsFuncRemoveCache.end(); ++it)
+            const std::string_view eventData = a_data != nullptr ? a_data : "";
+            if (m_isEventBatching)
+            {
+                m_eventBatch->Add(a_eventName != nullptr ? a_eventName : "", eventData);
+                return;
+            }
+
+            if (eventData.size() >= IPC_SHARED_PAYLOAD_THRESHOLD)
             {
-                if (std::get<0>(*it) == a_callbackInfo.objectName && std::get<1>(*it) == a_callbackInfo.funcName)
+                // [string eventName][string data], sized first, then written straight into the region
+                const std::string_view eventName = a_eventName != nullptr ? a_eventName : "";
+                const auto sharedMessage = NL::IPC::CreateSharedMessage(IPC_JS_EVENT_FUNCTION_CALL_SHARED_EVENT, [&](auto& a_out) {
+                    NL::IPC::WriteString(a_out, eventName);
+                    NL::IPC::WriteString(a_out, eventData);
+                });
+                if (sharedMessage != nullptr)
                 {
-                    m_jsFuncRemoveCache.erase(it);
+                    browser->GetMainFrame()->SendProcessMessage(CefProcessId::PID_RENDERER, sharedMessage);
+                    return;
                 }
+
+                m_logger->warn("{}: can't allocate shared memory for {} bytes of event data, using the argument list", NameOf(DefaultBrowser::ExecEventFunction), eventData.size());
             }
 
-            m_jsFuncCallbackInfoCache.push_back(a_callbackInfo);
-            return;
+            auto cefMessage = CefProcessMessage::Create(IPC_JS_EVENT_FUNCTION_CALL_EVENT);
+            cefMessage->GetArgumentList()->SetString(0, a_eventName);
+            cefMessage->GetArgumentList()->SetString(1, a_data);
+
+            browser->GetMainFrame()->SendProcessMessage(CefProcessId::PID_RENDERER, cefMessage);
         }
+    }
 
-        AddFunctionCallbackAndSendMessage(a_callbackInfo);
+    void __cdecl DefaultBrowser::SetEventBatching(bool a_enable, std::uint32_t a_maxDelayMs)
+    {
+        m_eventBatch->SetMaxDelay(a_maxDelayMs);
+        m_isEventBatching = a_enable;
+        if (!a_enable)
+        {
+            m_eventBatch->Flush();
+        }
     }
 
-    void __cdecl DefaultBrowser::RemoveFunctionCallback(const char* a_objectName, const char* a_funcName)
+    void __cdecl DefaultBrowser::ResolveAsyncCall(std::uint64_t a_token, const char* a_json)
     {
-        std::lock_guard locker(m_urlMutex);
-        if (!IsPageLoaded())
+        SendAsyncCallResult(a_token, IPC_JS_ASYNC_RESULT_JSON, a_json != nullptr ? a_json : "null");
+    }
+
+    void __cdecl DefaultBrowser::ResolveAsyncCallBinary(std::uint64_t a_token, const void* a_data, std::uint32_t a_size)
+    {
+        SendAsyncCallResult(a_token, IPC_JS_ASYNC_RESULT_BINARY, std::string_view(static_cast<const char*>(a_data), a_data != nullptr ? a_size : 0));
+    }
+
+    void __cdecl DefaultBrowser::RejectAsyncCall(std::uint64_t a_token, const char* a_message)
+    {
+        SendAsyncCallResult(a_token, IPC_JS_ASYNC_RESULT_ERROR, a_message != nullptr ? a_message : "");
+    }
+
+    void __cdecl DefaultBrowser::RegisterEventSchema(const char* a_eventName, const NL::JS::JSEventField* a_fields, std::uint32_t a_fieldCount)
+    {
+        static_assert(static_cast<std::uint8_t>(NL::JS::JSEventFieldType::Bool) == static_cast<std::uint8_t>(NL::IPC::EventFieldType::Bool));
+
+        if (a_eventName == nullptr || (a_fields == nullptr && a_fieldCount > 0))
         {
-            for (auto it = m_jsFuncCallbackInfoCache.begin(); it != m_jsFuncCallbackInfoCache.end(); ++it)
+            m_logger->error("{}: invalid event schema", NameOf(DefaultBrowser::RegisterEventSchema));
+            return;
+        }
+
+        NL::IPC::EventSchema schema;
+        for (std::uint32_t i = 0; i < a_fieldCount; ++i)
+        {
+            if (a_fields[i].name == nullptr || !schema.AddField(a_fields[i].name, static_cast<std::uint8_t>(a_fields[i].type)))
             {
-                if (it->objectNameString == a_objectName && it->funcNameString == a_funcName)
-                {
-                    m_jsFuncCallbackInfoCache.erase(it);
-                }
+                m_logger->error("{}: invalid field {} in schema of event \"{}\"", NameOf(DefaultBrowser::RegisterEventSchema), i, a_eventName);
+                return;
             }
+        }
+
+        std::lock_guard schemaLocker(m_eventSchemaMutex);
+        const auto& storedSchema = m_eventSchemaMap[a_eventName] = std::move(schema);
+
+        const auto browser = m_cefClient->GetBrowser();
+        if (IsPageLoaded() && browser != nullptr)
+        {
+            SendEventSchema(browser, a_eventName, storedSchema);
+        }
+    }
+
+    void __cdecl DefaultBrowser::ExecEventFunctionValues(const char* a_eventName, const double* a_values, std::uint32_t a_valueCount)
+    {
+        const auto browser = m_cefClient->GetBrowser();
+        if (a_eventName == nullptr || !IsPageLoaded() || browser == nullptr)
+        {
+            return;
+        }
 
-            if (!m_jsFuncStorage->RemoveFunctionCallback(a_objectName, a_funcName))
+        thread_local std::string payload;
+        payload.clear();
+        {
+            std::lock_guard schemaLocker(m_eventSchemaMutex);
+            const auto it = m_eventSchemaMap.find(std::string_view(a_eventName));
+            if (it == m_eventSchemaMap.end())
             {
-                m_jsFuncRemoveCache.push_back({a_objectName, a_funcName});
+                m_logger->error("{}: event \"{}\" has no schema", NameOf(DefaultBrowser::ExecEventFunctionValues), a_eventName);
+                return;
             }
+
+            it->second.Encode(a_values, a_valueCount, payload);
+        }
+
+        // Earlier batched events must arrive first
+        FlushEventBatch();
+
+        auto cefMessage = CefProcessMessage::Create(IPC_JS_EVENT_PACKED_EVENT);
+        cefMessage->GetArgumentList()->SetString(0, a_eventName);
+        cefMessage->GetArgumentList()->SetBinary(1, CefBinaryValue::Create(payload.data(), payload.size()));
+        browser->GetMainFrame()->SendProcessMessage(CefProcessId::PID_RENDERER, cefMessage);
+    }
+
+    std::uint32_t __cdecl DefaultBrowser::RegisterScript(const char* a_name, const char* a_source)
+    {
+        if (a_name == nullptr || a_source == nullptr)
+        {
+            m_logger->error("{}: script name and source must not be null", NameOf(DefaultBrowser::RegisterScript));
+            return 0;
+        }
+
+        std::lock_guard scriptLocker(m_scriptMutex);
+        auto it = std::find_if(m_scripts.begin(), m_scripts.end(), [&](const ScriptInfo& a_script) { return a_script.name == a_name; });
+        if (it == m_scripts.end())
+        {
+            it = m_scripts.insert(m_scripts.end(), ScriptInfo{a_name, a_source});
+        }
+        else
+        {
+            it->source = a_source;
+        }
+
+        const auto scriptId = static_cast<std::uint32_t>(std::distance(m_scripts.begin(), it) + 1);
+        const auto browser = m_cefClient->GetBrowser();
+        if (IsPageLoaded() && browser != nullptr)
+        {
+            SendScript(browser, scriptId, *it);
+        }
+
+        return scriptId;
+    }
+
+    void __cdecl DefaultBrowser::ExecuteScript(std::uint32_t a_scriptId, const NL::JS::JSScriptArg* a_args, std::uint32_t a_argCount)
+    {
+        const auto browser = m_cefClient->GetBrowser();
+        if (a_scriptId == 0 || (a_args == nullptr && a_argCount > 0) || !IsPageLoaded() || browser == nullptr)
+        {
             return;
         }
 
-        RemoveFunctionCallbackAndSendMessage(a_objectName, a_funcName);
+        // [u32 scriptId][u32 argCount][tagged value]...
+        thread_local std::string payload;
+        payload.clear();
+        NL::IPC::AppendRaw(payload, a_scriptId);
+        NL::IPC::AppendRaw(payload, a_argCount);
+        for (std::uint32_t i = 0; i < a_argCount; ++i)
+        {
+            const auto& arg = a_args[i];
+            switch (arg.type)
+            {
+            case NL::JS::JSScriptArgType::Bool:
+                NL::IPC::AppendTag(payload, NL::IPC::PayloadTag::Bool);
+                NL::IPC::AppendRaw(payload, static_cast<std::uint8_t>(arg.number != 0.0));
+                break;
+            case NL::JS::JSScriptArgType::Int:
+                NL::IPC::AppendTag(payload, NL::IPC::PayloadTag::Int);
+                NL::IPC::AppendRaw(payload, NL::IPC::ToInt32(arg.number));
+                break;
+            case NL::JS::JSScriptArgType::Double:
+                NL::IPC::AppendTag(payload, NL::IPC::PayloadTag::Double);
+                NL::IPC::AppendRaw(payload, arg.number);
+                break;
+            case NL::JS::JSScriptArgType::String:
+                if (arg.string != nullptr)
+                {
+                    NL::IPC::AppendTag(payload, NL::IPC::PayloadTag::String);
+                    NL::IPC::AppendString(payload, arg.string);
+                    break;
+                }
+                [[fallthrough]];
+            case NL::JS::JSScriptArgType::Null:
+            default:
+                NL::IPC::AppendTag(payload, NL::IPC::PayloadTag::Null);
+                break;
+            }
+        }
+
+        CefRefPtr<CefProcessMessage> message = nullptr;
+        if (payload.size() >= IPC_SHARED_PAYLOAD_THRESHOLD)
+        {
+            message = NL::IPC::CreateSharedMessage(IPC_JS_SCRIPT_CALL_EVENT, payload);
+        }
+
+        if (message == nullptr)
+        {
+            message = CefProcessMessage::Create(IPC_JS_SCRIPT_CALL_EVENT);
+            message->GetArgumentList()->SetBinary(0, CefBinaryValue::Create(payload.data(), payload.size()));
+        }
+
+        browser->GetMainFrame()->SendProcessMessage(CefProcessId::PID_RENDERER, message);
     }
 
-    void __cdecl DefaultBrowser::RemoveFunctionCallback(const NL::JS::JSFuncInfo& a_callbackInfo)
+    void __cdecl DefaultBrowser::ExecEventFunctionBinary(const char* a_eventName, const void* a_data, std::uint32_t a_size)
     {
-        RemoveFunctionCallback(a_callbackInfo.objectName, a_callbackInfo.funcName);
+        const auto browser = m_cefClient->GetBrowser();
+        if (a_eventName == nullptr || !IsPageLoaded() || browser == nullptr)
+        {
+            return;
+        }
+
+        const std::string_view eventName(a_eventName);
+        const auto size = a_data != nullptr ? a_size : 0;
+
+        // Earlier batched events must arrive first
+        FlushEventBatch();
+
+        if (size >= IPC_SHARED_PAYLOAD_THRESHOLD)
+        {
+            // [string eventName][string data], written straight into the region
+            const auto sharedMessage = NL::IPC::CreateSharedMessage(IPC_JS_EVENT_BINARY_EVENT, [&](auto& a_out) {
+                NL::IPC::WriteString(a_out, eventName);
+                NL::IPC::WriteString(a_out, std::string_view(static_cast<const char*>(a_data), size));
+            });
+            if (sharedMessage != nullptr)
+            {
+                browser->GetMainFrame()->SendProcessMessage(CefProcessId::PID_RENDERER, sharedMessage);
+                return;
+            }
+
+            m_logger->warn("{}: can't allocate shared memory for {} bytes of event data, using the argument list", NameOf(DefaultBrowser::ExecEventFunctionBinary), size);
+        }
+
+        auto cefMessage = CefProcessMessage::Create(IPC_JS_EVENT_BINARY_EVENT);
+        cefMessage->GetArgumentList()->SetString(0, a_eventName);
+        if (size > 0)
+        {
+            cefMessage->GetArgumentList()->SetBinary(1, CefBinaryValue::Create(a_data, size));
+        }
+        browser->GetMainFrame()->SendProcessMessage(CefProcessId::PID_RENDERER, cefMessage);
     }
 
-    void __cdecl DefaultBrowser::ExecEventFunction(const char* a_eventName, const char* a_data)
+    std::uint32_t __cdecl DefaultBrowser::RegisterStateObject(const char* a_objectName, const NL::JS::JSEventField* a_fields, std::uint32_t a_fieldCount)
     {
+        if (a_objectName == nullptr || *a_objectName == '\0' || a_fields == nullptr || a_fieldCount == 0)
+        {
+            m_logger->error("{}: invalid state object", NameOf(DefaultBrowser::RegisterStateObject));
+            return 0;
+        }
+
+        NL::IPC::StateLayout layout;
+        for (std::uint32_t i = 0; i < a_fieldCount; ++i)
+        {
+            if (a_fields[i].name == nullptr || !layout.AddField(a_fields[i].name, static_cast<std::uint8_t>(a_fields[i].type)))
+            {
+                m_logger->error("{}: invalid field {} of state object \"{}\"", NameOf(DefaultBrowser::RegisterStateObject), i, a_objectName);
+                return 0;
+            }
+        }
+
+        std::string layoutPayload;
+        layout.Serialize(layoutPayload);
+
+        std::lock_guard stateLocker(m_stateMutex);
+        auto it = std::find_if(m_states.begin(), m_states.end(), [&](const StateInfo& a_state) { return a_state.objectName == a_objectName; });
+        const auto stateId = static_cast<std::uint32_t>(std::distance(m_states.begin(), it) + 1);
+        if (it != m_states.end() && it->layoutPayload == layoutPayload)
+        {
+            return stateId;
+        }
+
+        // A new layout gets a new mapping, the renderer may still read the old one
+        static std::atomic_uint32_t mappingCounter = 0;
+        StateInfo state;
+        state.objectName = a_objectName;
+        state.mappingName = std::format("Local\\NirnLabUIState_{}_{}", ::GetCurrentProcessId(), ++mappingCounter);
+        const auto blockSize = NL::IPC::StateBlock::GetBlockSize(layout.dataSize);
+        if (!state.mapping.Create(state.mappingName, blockSize) || !state.block.Initialize(state.mapping.GetMemory(), state.mapping.GetSize(), layout.dataSize))
+        {
+            m_logger->error("{}: can't create shared memory of {} bytes for state object \"{}\", error {}", NameOf(DefaultBrowser::RegisterStateObject), blockSize, a_objectName, ::GetLastError());
+            return 0;
+        }
+        state.layout = std::move(layout);
+        state.layoutPayload = std::move(layoutPayload);
+
+        if (it == m_states.end())
+        {
+            it = m_states.insert(m_states.end(), std::move(state));
+        }
+        else
+        {
+            *it = std::move(state);
+        }
+
         const auto browser = m_cefClient->GetBrowser();
         if (IsPageLoaded() && browser != nullptr)
         {
-            auto cefMessage = CefProcessMessage::Create(IPC_JS_EVENT_FUNCTION_CALL_EVENT);
-            cefMessage->GetArgumentList()->SetString(0, a_eventName);
-            cefMessage->GetArgumentList()->SetString(1, a_data);
+            SendState(browser, *it);
+        }
 
-            browser->GetMainFrame()->SendProcessMessage(CefProcessId::PID_RENDERER, cefMessage);
+        return stateId;
+    }
+
+    void __cdecl DefaultBrowser::SetStateValues(std::uint32_t a_stateId, const double* a_values, std::uint32_t a_valueCount, std::uint32_t a_firstField)
+    {
+        if (a_values == nullptr || a_valueCount == 0)
+        {
+            return;
+        }
+
+        // One writer per block
+        std::lock_guard stateLocker(m_stateMutex);
+        if (a_stateId == 0 || a_stateId > m_states.size())
+        {
+            m_logger->error("{}: unknown state id {}", NameOf(DefaultBrowser::SetStateValues), a_stateId);
+            return;
         }
+
+        auto& state = m_states[a_stateId - 1];
+        state.block.WriteValues(state.layout, a_firstField, a_values, a_valueCount);
     }
 
 #pragma endregion
@@ -442,6 +1009,7 @@ namespace NL::CEF
 
         m_lastCefMouseEvent.x = static_cast<int>(m_currentMousePosX);
         m_lastCefMouseEvent.y = static_cast<int>(m_currentMousePosY);
+        m_inputLatencyTracker->OnInputForwarded();
         m_cefClient->GetBrowser()->GetHost()->SendMouseMoveEvent(m_lastCefMouseEvent, false);
 
         return true;
@@ -449,9 +1017,6 @@ namespace NL::CEF
 
     bool DefaultBrowser::ProcessButton(RE::ButtonEvent* a_event)
     {
-        CheckToggleFocusKeys(a_event);
-        CheckToggleVisibleKeys(a_event);
-
         if (!IsBrowserFocused())
         {
             return false;
@@ -467,6 +1032,8 @@ namespace NL::CEF
                 return true;
             }
 
+            m_inputLatencyTracker->OnInputForwarded();
+
             switch (scanCode)
             {
             case RE::BSWin32MouseDevice::Keys::kWheelUp:
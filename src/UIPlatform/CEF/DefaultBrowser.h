@@ -3,12 +3,20 @@
 #include "PCH.h"
 #include "Render/CEFRenderLayer.h"
 #include "CEF/NirnLabCefClient.h"
+#include "CEF/JSEventBatch.h"
+#include "CEF/PreloadOperationLog.h"
 #include "Services/CEFService.h"
+#include "Services/HotkeyService.h"
+#include "Services/SubprocessLogService.h"
 #include "Hooks/WinProcHook.h"
 #include "JS/JSFunctionStorage.h"
 #include "JS/JSEventFuncInfo.h"
 #include "Converters/CefValueToJSONConverter.h"
+#include "Converters/IPCPayloadToJSONConverter.h"
 #include "Converters/KeyInputConverter.h"
+#include "IPCEventSchema.h"
+#include "IPCStateBlock.h"
+#include "IPCSharedMapping.h"
 
 namespace NL::CEF
 {
@@ -24,38 +32,88 @@ namespace NL::CEF
 
         // Url
         std::recursive_mutex m_urlMutex;
-        bool m_isUrlCached = false;
         bool m_isPageLoaded = false;
-        bool m_clearJSFunctions = false;
-        std::string m_urlCache = "";
+
+        // Revision of the function storage, renderer registries report the one they match when a main context is created
+        std::uint32_t m_funcRegistryRevision = 1;
+        // Bumped when a main context is created, the renderer drops the promises of the old one.
+        // Async call tokens carry it, so a late result can't complete a call of another page or renderer process
+        std::atomic_uint32_t m_asyncCallGeneration = 1;
+
+        // Url loads and js execution made before the page is loaded
+        PreloadOperationLog m_preloadOperationLog;
+        // Functions cleared by LoadBrowserURL while a page is live. They stay callable until the new page commits,
+        // the renderer drops them before the new main context is bound
+        std::set<std::pair<std::string, std::string>> m_staleFunctions;
 
         // Focus
         bool m_isFocused = false;
         bool m_isFocusedCached = false;
 
-        // JS execution
-        std::vector<std::tuple<std::string, std::string>> m_jsExecCache;
-
-        // JS function callback
-        std::list<NL::JS::JSFuncInfoString> m_jsFuncCallbackInfoCache;
-        std::list<std::tuple<std::string, std::string>> m_jsFuncRemoveCache;
+        // JS event batching
+        std::atomic_bool m_isEventBatching = false;
+        std::shared_ptr<JSEventBatch> m_eventBatch = nullptr;
+
+        // JS event schemas, sent again when a page is loaded
+        std::mutex m_eventSchemaMutex;
+        std::map<std::string, NL::IPC::EventSchema, std::less<>> m_eventSchemaMap;
+
+        // Registered scripts, script id is index + 1. Sent again when a page is loaded
+        struct ScriptInfo
+        {
+            std::string name;
+            std::string source;
+        };
+        std::mutex m_scriptMutex;
+        std::vector<ScriptInfo> m_scripts;
+
+        // State objects, state id is index + 1. Values live in shared memory, the mapping name is sent again when a page is loaded
+        struct StateInfo
+        {
+            std::string objectName;
+            std::string mappingName;
+            NL::IPC::StateLayout layout;
+            std::string layoutPayload;
+            NL::IPC::SharedMapping mapping;
+            NL::IPC::StateBlock block;
+        };
+        std::mutex m_stateMutex;
+        std::vector<StateInfo> m_states;
 
         RE::CursorMenu* m_cursorMenu = nullptr;
         float& m_currentMousePosX = RE::MenuCursor::GetSingleton()->cursorPosX;
         float& m_currentMousePosY = RE::MenuCursor::GetSingleton()->cursorPosY;
         CefMouseEvent m_lastCefMouseEvent;
         NL::Converters::KeyInputConverter m_keyInputConverter;
-
-        std::uint32_t m_toggleFocusKeyCode1 = 0;
-        std::uint32_t m_toggleFocusKeyCode2 = 0;
-
-        std::uint32_t m_toggleVisibleKeyCode1 = 0;
-        std::uint32_t m_toggleVisibleKeyCode2 = 0;
+        NL::Render::InputLatencyTracker* m_inputLatencyTracker = nullptr;
+
+        enum HotkeyAction : std::uint32_t
+        {
+            ToggleFocus = 0,
+            ToggleVisible,
+        };
+
+        void SendPreloadOperations(std::vector<PreloadOperationLog::ExecuteScriptOperation>&& a_operations);
+        /// <summary>
+        /// Removes functions cleared by LoadBrowserURL once the new page has committed
+        /// </summary>
+        void RemoveStaleFunctions();
+        void SendFunctionRemoveMessage(const char* a_objectName, const char* a_funcName);
+        /// <summary>
+        /// Replaces the renderer registry with the whole function storage
+        /// </summary>
+        void SendFunctionRegistry();
+        void SendEventSchema(const CefRefPtr<CefBrowser>& a_browser, const std::string& a_eventName, const NL::IPC::EventSchema& a_schema);
+        void SendScript(const CefRefPtr<CefBrowser>& a_browser, std::uint32_t a_scriptId, const ScriptInfo& a_script);
+        void SendState(const CefRefPtr<CefBrowser>& a_browser, const StateInfo& a_state);
+        void SendAsyncCallResult(std::uint64_t a_token, std::uint8_t a_resultType, std::string_view a_result);
+        void BindToggleHotkey(HotkeyAction a_action, const std::uint32_t a_keyCode1, const std::uint32_t a_keyCode2);
 
         bool m_wasCursorOpen = false;
 
         sigslot::scoped_connection m_onWndInactive_Connection;
         sigslot::scoped_connection m_onIPCMessageReceived_Connection;
+        sigslot::scoped_connection m_onAsyncCallDropped_Connection;
         sigslot::scoped_connection m_onAfterBrowserCreated_Connection;
         sigslot::scoped_connection m_onMainFrameLoadStart_Connection;
         sigslot::scoped_connection m_onMainFrameLoadEnd_Connection;
@@ -66,14 +124,19 @@ namespace NL::CEF
                        std::shared_ptr<NL::JS::JSFunctionStorage> a_jsFuncStorage);
         ~DefaultBrowser() override;
 
-        void CheckToggleFocusKeys(const RE::ButtonEvent* a_event);
-        void CheckToggleVisibleKeys(const RE::ButtonEvent* a_event);
-
         CefRefPtr<NirnLabCefClient> GetCefClient();
         bool IsReadyAndLog();
 
+        /// <summary>
+        /// Writes the function storage in the IPC_JS_FUNCION_ADD_EVENT layout, also seeds the renderer registry in the browser extra info
+        /// </summary>
+        void WriteFunctionRegistry(CefRefPtr<CefListValue> a_registry);
         void AddFunctionCallbackAndSendMessage(const NL::JS::JSFuncInfo& a_callbackInfo);
         void RemoveFunctionCallbackAndSendMessage(const char* a_objectName, const char* a_funcName);
+        /// <summary>
+        /// Sends batched events, called once per frame
+        /// </summary>
+        void FlushEventBatch();
 
         // IBrowser
         bool __cdecl IsBrowserReady() override;
@@ -93,6 +156,17 @@ namespace NL::CEF
         void __cdecl RemoveFunctionCallback(const char* a_objectName, const char* a_funcName) override;
         void __cdecl RemoveFunctionCallback(const NL::JS::JSFuncInfo& a_callbackInfo) override;
         void __cdecl ExecEventFunction(const char* a_eventName, const char* a_data) override;
+        void __cdecl SetEventBatching(bool a_enable, std::uint32_t a_maxDelayMs = 50) override;
+        void __cdecl ResolveAsyncCall(std::uint64_t a_token, const char* a_json) override;
+        void __cdecl ResolveAsyncCallBinary(std::uint64_t a_token, const void* a_data, std::uint32_t a_size) override;
+        void __cdecl RejectAsyncCall(std::uint64_t a_token, const char* a_message) override;
+        void __cdecl RegisterEventSchema(const char* a_eventName, const NL::JS::JSEventField* a_fields, std::uint32_t a_fieldCount) override;
+        void __cdecl ExecEventFunctionValues(const char* a_eventName, const double* a_values, std::uint32_t a_valueCount) override;
+        std::uint32_t __cdecl RegisterScript(const char* a_name, const char* a_source) override;
+        void __cdecl ExecuteScript(std::uint32_t a_scriptId, const NL::JS::JSScriptArg* a_args, std::uint32_t a_argCount) override;
+        void __cdecl ExecEventFunctionBinary(const char* a_eventName, const void* a_data, std::uint32_t a_size) override;
+        std::uint32_t __cdecl RegisterStateObject(const char* a_objectName, const NL::JS::JSEventField* a_fields, std::uint32_t a_fieldCount) override;
+        void __cdecl SetStateValues(std::uint32_t a_stateId, const double* a_values, std::uint32_t a_valueCount, std::uint32_t a_firstField = 0) override;
 
         // RE::MenuEventHandler
         bool CanProcess(RE::InputEvent* a_event) override;
@@ -0,0 +1,132 @@
+#include "JSEventBatch.h"
+
+namespace NL::CEF
+{
+    class JSEventBatch::FlushTask : public CefTask
+    {
+        IMPLEMENT_REFCOUNTING(FlushTask);
+
+      protected:
+        std::weak_ptr<JSEventBatch> m_batch;
+
+      public:
+        FlushTask(std::weak_ptr<JSEventBatch> a_batch)
+            : m_batch(std::move(a_batch))
+        {
+        }
+
+        void Execute() override
+        {
+            if (const auto batch = m_batch.lock())
+            {
+                batch->OnFlushTask();
+            }
+        }
+    };
+
+    JSEventBatch::JSEventBatch(CefRefPtr<NirnLabCefClient> a_cefClient)
+    {
+        ThrowIfNullptr(JSEventBatch, a_cefClient);
+        m_cefClient = a_cefClient;
+    }
+
+    void JSEventBatch::PostFlushTask(std::int64_t a_delayMs)
+    {
+        m_isFlushTaskPosted = CefPostDelayedTask(TID_UI, new FlushTask(weak_from_this()), a_delayMs);
+    }
+
+    void JSEventBatch::OnFlushTask()
+    {
+        {
+            std::lock_guard lock(m_batchMutex);
+            m_isFlushTaskPosted = false;
+            if (m_payload.empty())
+            {
+                return;
+            }
+
+            // The pending batch is newer than the one the task was posted for
+            const auto ageMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_batchStartTime).count();
+            const auto maxDelayMs = static_cast<std::int64_t>(m_maxDelayMs.load());
+            if (ageMs < maxDelayMs)
+            {
+                PostFlushTask(maxDelayMs - ageMs);
+                return;
+            }
+        }
+
+        Flush();
+    }
+
+    void JSEventBatch::SetMaxDelay(std::uint32_t a_maxDelayMs)
+    {
+        m_maxDelayMs = a_maxDelayMs;
+    }
+
+    void JSEventBatch::Add(std::string_view a_eventName, std::string_view a_data)
+    {
+        auto isExpired = false;
+        {
+            std::lock_guard lock(m_batchMutex);
+            if (m_payload.empty())
+            {
+                m_batchStartTime = std::chrono::steady_clock::now();
+                if (!m_isFlushTaskPosted)
+                {
+                    PostFlushTask(m_maxDelayMs);
+                }
+            }
+            else
+            {
+                isExpired = std::chrono::steady_clock::now() - m_batchStartTime >= std::chrono::milliseconds(m_maxDelayMs.load());
+            }
+
+            NL::IPC::AppendString(m_payload, a_eventName);
+            NL::IPC::AppendString(m_payload, a_data);
+        }
+
+        if (isExpired)
+        {
+            Flush();
+        }
+    }
+
+    void JSEventBatch::Flush()
+    {
+        // Serializes senders, so batches arrive in order
+        std::lock_guard lock(m_batchMutex);
+        if (m_payload.empty())
+        {
+            return;
+        }
+
+        m_sendPayload.swap(m_payload);
+        m_payload.clear();
+
+        const auto browser = m_cefClient->GetBrowser();
+        if (browser == nullptr)
+        {
+            return;
+        }
+
+        CefRefPtr<CefProcessMessage> message = nullptr;
+        if (m_sendPayload.size() >= IPC_SHARED_PAYLOAD_THRESHOLD)
+        {
+            message = NL::IPC::CreateSharedMessage(IPC_JS_EVENT_FUNCTION_BATCH_EVENT, m_sendPayload);
+        }
+
+        if (message == nullptr)
+        {
+            message = CefProcessMessage::Create(IPC_JS_EVENT_FUNCTION_BATCH_EVENT);
+            message->GetArgumentList()->SetBinary(0, CefBinaryValue::Create(m_sendPayload.data(), m_sendPayload.size()));
+        }
+
+        browser->GetMainFrame()->SendProcessMessage(CefProcessId::PID_RENDERER, message);
+    }
+
+    void JSEventBatch::Clear()
+    {
+        std::lock_guard lock(m_batchMutex);
+        m_payload.clear();
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "PCH.h"
+#include "IPCSharedPayload.h"
+#include "CEF/NirnLabCefClient.h"
+
+namespace NL::CEF
+{
+    /// <summary>
+    /// Buffers event function calls of one browser and sends them as a single message.
+    /// Flushed once per frame, a delayed CEF task flushes the batch if no frame does it within the max delay
+    /// </summary>
+    class JSEventBatch : public std::enable_shared_from_this<JSEventBatch>
+    {
+      protected:
+        class FlushTask;
+
+        CefRefPtr<NirnLabCefClient> m_cefClient = nullptr;
+
+        std::mutex m_batchMutex;
+        // [string eventName][string data]... (see IPCSharedPayload.h)
+        std::string m_payload;
+        std::string m_sendPayload;
+        std::chrono::steady_clock::time_point m_batchStartTime;
+        bool m_isFlushTaskPosted = false;
+        std::atomic<std::uint32_t> m_maxDelayMs = 50;
+
+        void PostFlushTask(std::int64_t a_delayMs);
+        void OnFlushTask();
+
+      public:
+        JSEventBatch(CefRefPtr<NirnLabCefClient> a_cefClient);
+
+        void SetMaxDelay(std::uint32_t a_maxDelayMs);
+        void Add(std::string_view a_eventName, std::string_view a_data);
+        void Flush();
+        /// <summary>
+        /// Drops pending events, e.g. when a new page starts loading
+        /// </summary>
+        void Clear();
+    };
+}
@@ -12,6 +12,11 @@ namespace NL::CEF
         return m_cefRenderLayer;
     }
 
+    NL::Render::InputLatencyTracker* NirnLabCefClient::GetInputLatencyTracker()
+    {
+        return m_cefRenderLayer->GetInputLatencyTracker();
+    }
+
     CefRefPtr<CefBrowser> NirnLabCefClient::GetBrowser()
     {
         return m_cefBrowser;
@@ -47,7 +52,18 @@ namespace NL::CEF
                                                     CefProcessId source_process,
                                                     CefRefPtr<CefProcessMessage> message)
     {
+        const auto startTime = std::chrono::steady_clock::now();
         onIPCMessageReceived(message);
+        const auto endTime = std::chrono::steady_clock::now();
+
+        // Reuses the buffer, names are only copied when a thread records a message type for the first time
+        thread_local std::string messageName;
+        NL::IPC::AssignUTF8(messageName, message->GetName());
+        NL::Services::MetricsService::GetSingleton().GetMessageTable().Record(NL::Metrics::MetricTable::MakeKey(messageName),
+                                                                              NL::IPC::GetMessageSize(message),
+                                                                              NL::Services::MetricsService::GetMicroseconds(endTime - startTime),
+                                                                              NL::Metrics::MetricTable::NO_TIMING,
+                                                                              messageName);
         return true;
     }
 
@@ -60,6 +76,7 @@ namespace NL::CEF
     void NirnLabCefClient::OnBeforeClose(CefRefPtr<CefBrowser> browser)
     {
         onBeforeBrowserClose(browser);
+        NL::Services::MetricsService::GetSingleton().RemoveRenderer(browser->GetIdentifier());
         m_cefBrowser = nullptr;
     }
 
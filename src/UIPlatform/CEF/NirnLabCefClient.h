@@ -3,6 +3,8 @@
 #include "PCH.h"
 #include "Render/CEFCopyRenderLayer.h"
 #include "Render/CEFRenderLayer.h"
+#include "Services/MetricsService.h"
+#include "IPCSharedPayload.h"
 
 namespace NL::CEF
 {
@@ -22,6 +24,7 @@ namespace NL::CEF
         virtual ~NirnLabCefClient() override = default;
 
         std::shared_ptr<NL::Render::IRenderLayer> GetRenderLayer();
+        NL::Render::InputLatencyTracker* GetInputLatencyTracker();
         CefRefPtr<CefBrowser> GetBrowser();
         bool IsBrowserReady();
 
@@ -0,0 +1,122 @@
+#include "PreloadOperationLog.h"
+
+namespace NL::CEF
+{
+    PreloadOperationLog::PreloadOperationLog(size_t a_maxScriptCount, size_t a_maxScriptBytes, OverflowPolicy a_overflowPolicy)
+        : m_maxScriptCount(a_maxScriptCount),
+          m_maxScriptBytes(a_maxScriptBytes),
+          m_overflowPolicy(a_overflowPolicy)
+    {
+    }
+
+    bool PreloadOperationLog::DropOldestScript()
+    {
+        for (; m_oldestScriptSlot < m_operations.size(); ++m_oldestScriptSlot)
+        {
+            auto& operation = m_operations[m_oldestScriptSlot];
+            if (operation.has_value())
+            {
+                m_scriptBytes -= operation->script.size();
+                --m_scriptCount;
+                ++m_droppedCount;
+                operation.reset();
+                ++m_oldestScriptSlot;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void PreloadOperationLog::Compact()
+    {
+        // Dropped scripts leave empty slots, don't let them grow without bound
+        if (m_operations.size() < 64 || m_scriptCount * 2 > m_operations.size())
+        {
+            return;
+        }
+
+        std::vector<std::optional<ExecuteScriptOperation>> operations;
+        operations.reserve(m_scriptCount);
+        m_oldestScriptSlot = 0;
+        for (auto& operation : m_operations)
+        {
+            if (operation.has_value())
+            {
+                operations.push_back(std::move(operation));
+            }
+        }
+
+        m_operations = std::move(operations);
+    }
+
+    bool PreloadOperationLog::ExecuteScript(std::string_view a_script, std::string_view a_scriptUrl)
+    {
+        if (a_script.size() > m_maxScriptBytes || m_maxScriptCount == 0)
+        {
+            ++m_droppedCount;
+            return false;
+        }
+
+        while (m_scriptCount + 1 > m_maxScriptCount || m_scriptBytes + a_script.size() > m_maxScriptBytes)
+        {
+            if (m_overflowPolicy == OverflowPolicy::DropNewest || !DropOldestScript())
+            {
+                ++m_droppedCount;
+                return false;
+            }
+        }
+
+        m_operations.emplace_back(ExecuteScriptOperation{std::string(a_script), std::string(a_scriptUrl)});
+        m_scriptBytes += a_script.size();
+        ++m_scriptCount;
+        Compact();
+        return true;
+    }
+
+    void PreloadOperationLog::LoadUrl(std::string_view a_url)
+    {
+        m_urlLoad = UrlLoad{std::string(a_url)};
+    }
+
+    std::optional<PreloadOperationLog::UrlLoad> PreloadOperationLog::TakeUrlLoad()
+    {
+        auto urlLoad = std::move(m_urlLoad);
+        m_urlLoad.reset();
+        return urlLoad;
+    }
+
+    std::vector<PreloadOperationLog::ExecuteScriptOperation> PreloadOperationLog::TakeOperations()
+    {
+        std::vector<ExecuteScriptOperation> operations;
+        operations.reserve(m_scriptCount);
+        for (auto& operation : m_operations)
+        {
+            if (operation.has_value())
+            {
+                operations.push_back(std::move(*operation));
+            }
+        }
+
+        m_operations.clear();
+        m_scriptCount = 0;
+        m_scriptBytes = 0;
+        m_oldestScriptSlot = 0;
+        return operations;
+    }
+
+    size_t PreloadOperationLog::GetSize() const
+    {
+        return m_scriptCount;
+    }
+
+    bool PreloadOperationLog::IsEmpty() const
+    {
+        return m_scriptCount == 0;
+    }
+
+    size_t PreloadOperationLog::GetDroppedCount() const
+    {
+        return m_droppedCount;
+    }
+}
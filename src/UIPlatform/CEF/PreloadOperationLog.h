@@ -0,0 +1,79 @@
+#pragma once
+
+#include "PCH.h"
+
+namespace NL::CEF
+{
+    /// <summary>
+    /// Browser operations made before the page is loaded: scripts are kept in call order and replayed on load start, only the last url load is kept.
+    /// Function changes don't wait for the page, they go to the renderer registry right away.
+    /// Not thread safe, DefaultBrowser guards it with its url mutex
+    /// </summary>
+    class PreloadOperationLog
+    {
+      public:
+        /// <summary>
+        /// What happens to scripts when the script limits are reached
+        /// </summary>
+        enum class OverflowPolicy : std::uint8_t
+        {
+            DropNewest = 0,
+            DropOldest,
+        };
+
+        struct ExecuteScriptOperation
+        {
+            std::string script;
+            std::string scriptUrl;
+        };
+
+        struct UrlLoad
+        {
+            std::string url;
+        };
+
+        static constexpr size_t DEFAULT_MAX_SCRIPT_COUNT = 1024;
+        static constexpr size_t DEFAULT_MAX_SCRIPT_BYTES = 4 * 1024 * 1024;
+
+      protected:
+        // Dropped scripts leave an empty slot until the log is compacted or taken
+        std::vector<std::optional<ExecuteScriptOperation>> m_operations;
+        std::optional<UrlLoad> m_urlLoad;
+
+        size_t m_maxScriptCount = DEFAULT_MAX_SCRIPT_COUNT;
+        size_t m_maxScriptBytes = DEFAULT_MAX_SCRIPT_BYTES;
+        OverflowPolicy m_overflowPolicy = OverflowPolicy::DropNewest;
+
+        size_t m_scriptCount = 0;
+        size_t m_scriptBytes = 0;
+        // Scripts before this slot are already dropped
+        size_t m_oldestScriptSlot = 0;
+        size_t m_droppedCount = 0;
+
+        bool DropOldestScript();
+        void Compact();
+
+      public:
+        PreloadOperationLog() = default;
+        PreloadOperationLog(size_t a_maxScriptCount, size_t a_maxScriptBytes, OverflowPolicy a_overflowPolicy);
+
+        /// <summary>
+        /// Returns false if the script was dropped by the overflow policy
+        /// </summary>
+        bool ExecuteScript(std::string_view a_script, std::string_view a_scriptUrl);
+        void LoadUrl(std::string_view a_url);
+
+        std::optional<UrlLoad> TakeUrlLoad();
+        /// <summary>
+        /// Returns pending scripts in call order and clears them, the url load is kept
+        /// </summary>
+        std::vector<ExecuteScriptOperation> TakeOperations();
+
+        size_t GetSize() const;
+        bool IsEmpty() const;
+        /// <summary>
+        /// Scripts dropped by the overflow policy since the log was created
+        /// </summary>
+        size_t GetDroppedCount() const;
+    };
+}
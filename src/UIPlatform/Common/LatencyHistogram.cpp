@@ -0,0 +1,77 @@
+#include "LatencyHistogram.h"
+
+namespace NL::Common
+{
+    void LatencyHistogram::Add(std::uint64_t a_microseconds)
+    {
+        m_buckets[Metrics::HistogramSnapshot::GetBucketIndex(a_microseconds)].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(a_microseconds, std::memory_order_relaxed);
+
+        auto currentMax = m_max.load(std::memory_order_relaxed);
+        while (currentMax < a_microseconds && !m_max.compare_exchange_weak(currentMax, a_microseconds, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void LatencyHistogram::Add(std::chrono::steady_clock::duration a_duration)
+    {
+        const auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(a_duration).count();
+        Add(static_cast<std::uint64_t>(std::max<std::int64_t>(microseconds, 0)));
+    }
+
+    void LatencyHistogram::Reset()
+    {
+        for (auto& bucket : m_buckets)
+        {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        m_count.store(0, std::memory_order_relaxed);
+        m_sum.store(0, std::memory_order_relaxed);
+        m_max.store(0, std::memory_order_relaxed);
+    }
+
+    std::uint64_t LatencyHistogram::GetCount() const
+    {
+        return m_count.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t LatencyHistogram::GetSum() const
+    {
+        return m_sum.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t LatencyHistogram::GetMax() const
+    {
+        return m_max.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t LatencyHistogram::GetBucketCount(std::size_t a_index) const
+    {
+        return a_index < BUCKET_COUNT ? m_buckets[a_index].load(std::memory_order_relaxed) : 0;
+    }
+
+    Metrics::HistogramSnapshot LatencyHistogram::GetSnapshot() const
+    {
+        // Add() bumps the bucket first, so reading the count first keeps it within the bucket total
+        Metrics::HistogramSnapshot snapshot;
+        snapshot.count = GetCount();
+        snapshot.sum = GetSum();
+        snapshot.max = GetMax();
+        for (std::size_t i = 0; i < BUCKET_COUNT; ++i)
+        {
+            snapshot.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+        }
+        return snapshot;
+    }
+
+    std::uint64_t LatencyHistogram::GetPercentile(double a_percentile) const
+    {
+        return GetSnapshot().GetPercentile(a_percentile);
+    }
+
+    std::string LatencyHistogram::ToString() const
+    {
+        return GetSnapshot().ToString();
+    }
+}
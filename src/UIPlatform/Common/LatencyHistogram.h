@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Metrics/HistogramSnapshot.h"
+
+namespace NL::Common
+{
+    /// <summary>
+    /// Lock-free log2 histogram of microsecond samples, percentiles and reports come from its snapshot
+    /// </summary>
+    class LatencyHistogram
+    {
+      public:
+        static constexpr std::size_t BUCKET_COUNT = Metrics::HistogramSnapshot::BUCKET_COUNT;
+
+      protected:
+        std::array<std::atomic_uint64_t, BUCKET_COUNT> m_buckets{};
+        std::atomic_uint64_t m_count = 0;
+        std::atomic_uint64_t m_sum = 0;
+        std::atomic_uint64_t m_max = 0;
+
+      public:
+        void Add(std::uint64_t a_microseconds);
+        void Add(std::chrono::steady_clock::duration a_duration);
+        void Reset();
+
+        std::uint64_t GetCount() const;
+        std::uint64_t GetSum() const;
+        std::uint64_t GetMax() const;
+        std::uint64_t GetBucketCount(std::size_t a_index) const;
+        Metrics::HistogramSnapshot GetSnapshot() const;
+        /// <summary>
+        /// Returns the upper bound (us) of the bucket containing the percentile, a_percentile is in [0, 1]
+        /// </summary>
+        std::uint64_t GetPercentile(double a_percentile) const;
+        std::string ToString() const;
+    };
+}
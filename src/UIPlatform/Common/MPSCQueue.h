@@ -0,0 +1,86 @@
+#pragma once
+
+namespace NL::Common
+{
+    /// <summary>
+    /// Lock-free multi producer single consumer FIFO.
+    /// Producers push onto an atomic stack, the consumer takes the whole stack at once and reverses it, so there is no ABA
+    /// </summary>
+    template <class T>
+    class MPSCQueue
+    {
+      protected:
+        struct Node
+        {
+            T value;
+            Node* next = nullptr;
+        };
+
+        // Newest first, shared with producers
+        std::atomic<Node*> m_pushHead = nullptr;
+        // Oldest first, consumer only
+        Node* m_popHead = nullptr;
+
+      public:
+        MPSCQueue() = default;
+        MPSCQueue(const MPSCQueue&) = delete;
+        MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+        ~MPSCQueue()
+        {
+            T value;
+            while (TryPop(value))
+            {
+            }
+        }
+
+        /// <summary>
+        /// Any thread
+        /// </summary>
+        void Push(T&& a_value)
+        {
+            auto node = new Node{std::move(a_value)};
+            node->next = m_pushHead.load(std::memory_order_relaxed);
+            while (!m_pushHead.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        /// <summary>
+        /// Consumer thread only
+        /// </summary>
+        bool TryPop(T& a_outValue)
+        {
+            if (m_popHead == nullptr)
+            {
+                auto node = m_pushHead.exchange(nullptr, std::memory_order_acquire);
+                while (node != nullptr)
+                {
+                    const auto next = node->next;
+                    node->next = m_popHead;
+                    m_popHead = node;
+                    node = next;
+                }
+
+                if (m_popHead == nullptr)
+                {
+                    return false;
+                }
+            }
+
+            const auto node = m_popHead;
+            m_popHead = node->next;
+            a_outValue = std::move(node->value);
+            delete node;
+            return true;
+        }
+
+        /// <summary>
+        /// Consumer thread only
+        /// </summary>
+        bool IsEmpty() const
+        {
+            return m_popHead == nullptr && m_pushHead.load(std::memory_order_acquire) == nullptr;
+        }
+    };
+}
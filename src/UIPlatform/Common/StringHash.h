@@ -0,0 +1,21 @@
+#pragma once
+
+namespace NL::Common
+{
+    /// <summary>
+    /// Transparent hash for unordered containers with std::string keys, use with std::equal_to<>.
+    /// Lookups by std::string_view or const char* don't create a temporary std::string
+    /// </summary>
+    struct StringHash
+    {
+        using is_transparent = void;
+
+        size_t operator()(std::string_view a_value) const noexcept
+        {
+            return std::hash<std::string_view>{}(a_value);
+        }
+    };
+
+    template <class TValue>
+    using StringMap = std::unordered_map<std::string, TValue, StringHash, std::equal_to<>>;
+}
@@ -0,0 +1,290 @@
+#include "WorkerPool.h"
+
+namespace NL::Common
+{
+    WorkerPool::WorkerPool(std::uint32_t a_threadCount, std::uint32_t a_maxQueuedCount)
+    {
+        m_maxQueuedCount = std::max(a_maxQueuedCount, 1u);
+
+        const auto threadCount = std::max(a_threadCount, 1u);
+        m_workers.reserve(threadCount);
+        for (std::uint32_t i = 0; i < threadCount; ++i)
+        {
+            m_workers.push_back(std::make_unique<Worker>());
+        }
+
+        // All workers exist before any of them tries to steal
+        for (std::size_t i = 0; i < m_workers.size(); ++i)
+        {
+            m_workers[i]->thread = std::thread(&WorkerPool::WorkerLoop, this, i);
+        }
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+        Stop();
+    }
+
+    bool WorkerPool::TryReserve()
+    {
+        // Sequentially consistent with OnTaskTaken(), so a waiting Submit() can't miss the free space
+        auto queuedCount = m_queuedCount.load();
+        do
+        {
+            if (queuedCount >= m_maxQueuedCount)
+            {
+                return false;
+            }
+        } while (!m_queuedCount.compare_exchange_weak(queuedCount, queuedCount + 1));
+
+        auto peakQueuedCount = m_peakQueuedCount.load(std::memory_order_relaxed);
+        while (peakQueuedCount <= queuedCount && !m_peakQueuedCount.compare_exchange_weak(peakQueuedCount, queuedCount + 1, std::memory_order_relaxed))
+        {
+        }
+        return true;
+    }
+
+    void WorkerPool::Push(Task&& a_task, std::uint64_t a_orderKey)
+    {
+        std::size_t workerIndex = 0;
+        if (a_orderKey != NO_ORDER_KEY)
+        {
+            workerIndex = static_cast<std::size_t>(a_orderKey % m_workers.size());
+        }
+        else
+        {
+            // Prefer an idle worker, stealing balances the rest
+            workerIndex = m_nextWorkerIndex.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+            for (std::size_t i = 0; i < m_workers.size(); ++i)
+            {
+                const auto index = (workerIndex + i) % m_workers.size();
+                if (m_workers[index]->isIdle.load(std::memory_order_relaxed))
+                {
+                    workerIndex = index;
+                    break;
+                }
+            }
+        }
+
+        auto& worker = *m_workers[workerIndex];
+        {
+            std::lock_guard lock(worker.mutex);
+            if (a_orderKey != NO_ORDER_KEY)
+            {
+                worker.orderedTasks.push_back(std::move(a_task));
+            }
+            else
+            {
+                worker.tasks.push_back(std::move(a_task));
+                m_stealableCount.fetch_add(1);
+            }
+        }
+        worker.wakeCondition.notify_one();
+
+        // The owner is busy, let an idle worker steal the task
+        if (a_orderKey == NO_ORDER_KEY && !worker.isIdle.load())
+        {
+            WakeIdleWorker(workerIndex);
+        }
+    }
+
+    bool WorkerPool::TryPopOwn(Worker& a_worker, Task& a_outTask)
+    {
+        std::lock_guard lock(a_worker.mutex);
+        if (!a_worker.orderedTasks.empty())
+        {
+            a_outTask = std::move(a_worker.orderedTasks.front());
+            a_worker.orderedTasks.pop_front();
+            return true;
+        }
+
+        if (a_worker.tasks.empty())
+        {
+            return false;
+        }
+
+        a_outTask = std::move(a_worker.tasks.front());
+        a_worker.tasks.pop_front();
+        m_stealableCount.fetch_sub(1);
+        return true;
+    }
+
+    bool WorkerPool::TrySteal(std::size_t a_thiefIndex, Task& a_outTask)
+    {
+        for (std::size_t i = 1; i < m_workers.size(); ++i)
+        {
+            auto& victim = *m_workers[(a_thiefIndex + i) % m_workers.size()];
+            std::lock_guard lock(victim.mutex);
+            if (!victim.tasks.empty())
+            {
+                a_outTask = std::move(victim.tasks.back());
+                victim.tasks.pop_back();
+                m_stealableCount.fetch_sub(1);
+                m_stolenCount.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void WorkerPool::WakeIdleWorker(std::size_t a_skipIndex)
+    {
+        // Sequentially consistent with the idle flag and the predicate in WorkerLoop(), so a worker going to sleep can't miss the task
+        for (std::size_t i = 1; i < m_workers.size(); ++i)
+        {
+            auto& worker = *m_workers[(a_skipIndex + i) % m_workers.size()];
+            if (worker.isIdle.load())
+            {
+                {
+                    std::lock_guard lock(worker.mutex);
+                }
+                worker.wakeCondition.notify_one();
+                return;
+            }
+        }
+    }
+
+    void WorkerPool::OnTaskTaken()
+    {
+        m_queuedCount.fetch_sub(1);
+        if (m_waitingSubmitCount.load() > 0)
+        {
+            std::lock_guard lock(m_spaceMutex);
+            m_spaceCondition.notify_all();
+        }
+    }
+
+    void WorkerPool::WorkerLoop(std::size_t a_index)
+    {
+        auto& worker = *m_workers[a_index];
+        while (!m_isStopped.load())
+        {
+            Task task;
+            if (!TryPopOwn(worker, task))
+            {
+                if (!TrySteal(a_index, task))
+                {
+                    std::unique_lock lock(worker.mutex);
+                    worker.isIdle.store(true);
+                    worker.wakeCondition.wait(lock, [&]() {
+                        return m_isStopped.load() || !worker.orderedTasks.empty() || m_stealableCount.load() > 0;
+                    });
+                    worker.isIdle.store(false);
+                    continue;
+                }
+
+                // One wake-up per push may leave more tasks behind a busy worker, pass it on
+                if (m_stealableCount.load() > 0)
+                {
+                    WakeIdleWorker(a_index);
+                }
+            }
+
+            OnTaskTaken();
+            try
+            {
+                task();
+            }
+            catch (const std::exception& e)
+            {
+                spdlog::error("{}: task failed, {}", NameOf(WorkerPool), e.what());
+            }
+            m_executedCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    bool WorkerPool::TrySubmit(Task&& a_task, std::uint64_t a_orderKey)
+    {
+        if (m_isStopped.load())
+        {
+            return false;
+        }
+
+        if (!TryReserve())
+        {
+            m_rejectedCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        Push(std::move(a_task), a_orderKey);
+        return true;
+    }
+
+    bool WorkerPool::Submit(Task&& a_task, std::uint64_t a_orderKey)
+    {
+        if (m_isStopped.load())
+        {
+            return false;
+        }
+
+        if (!TryReserve())
+        {
+            m_waitCount.fetch_add(1, std::memory_order_relaxed);
+            m_waitingSubmitCount.fetch_add(1);
+            {
+                std::unique_lock lock(m_spaceMutex);
+                m_spaceCondition.wait(lock, [&]() {
+                    return m_isStopped.load() || TryReserve();
+                });
+            }
+            m_waitingSubmitCount.fetch_sub(1);
+
+            if (m_isStopped.load())
+            {
+                return false;
+            }
+        }
+
+        Push(std::move(a_task), a_orderKey);
+        return true;
+    }
+
+    void WorkerPool::Stop()
+    {
+        if (m_isStopped.exchange(true))
+        {
+            return;
+        }
+
+        for (auto& worker : m_workers)
+        {
+            {
+                std::lock_guard lock(worker->mutex);
+            }
+            worker->wakeCondition.notify_all();
+        }
+
+        {
+            std::lock_guard lock(m_spaceMutex);
+            m_spaceCondition.notify_all();
+        }
+
+        for (auto& worker : m_workers)
+        {
+            if (worker->thread.joinable())
+            {
+                worker->thread.join();
+            }
+
+            std::lock_guard lock(worker->mutex);
+            worker->tasks.clear();
+            worker->orderedTasks.clear();
+        }
+        m_queuedCount.store(0);
+        m_stealableCount.store(0);
+    }
+
+    WorkerPool::Stats WorkerPool::GetStats() const
+    {
+        Stats stats;
+        stats.threadCount = static_cast<std::uint32_t>(m_workers.size());
+        stats.queuedCount = m_queuedCount.load(std::memory_order_relaxed);
+        stats.maxQueuedCount = m_maxQueuedCount;
+        stats.peakQueuedCount = m_peakQueuedCount.load(std::memory_order_relaxed);
+        stats.executedCount = m_executedCount.load(std::memory_order_relaxed);
+        stats.stolenCount = m_stolenCount.load(std::memory_order_relaxed);
+        stats.rejectedCount = m_rejectedCount.load(std::memory_order_relaxed);
+        stats.waitCount = m_waitCount.load(std::memory_order_relaxed);
+        return stats;
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+namespace NL::Common
+{
+    /// <summary>
+    /// Bounded work-stealing thread pool.
+    /// Every worker owns a deque, idle workers steal from the back of others and sleep while nothing can be taken. Tasks with an order key are bound to one worker
+    /// and are never stolen, so tasks with the same key run one at a time in submit order
+    /// </summary>
+    class WorkerPool
+    {
+      public:
+        using Task = std::function<void()>;
+
+        static constexpr std::uint64_t NO_ORDER_KEY = std::numeric_limits<std::uint64_t>::max();
+
+        struct Stats
+        {
+            std::uint32_t threadCount = 0;
+            // Submitted, not started yet
+            std::uint32_t queuedCount = 0;
+            std::uint32_t maxQueuedCount = 0;
+            std::uint32_t peakQueuedCount = 0;
+            std::uint64_t executedCount = 0;
+            std::uint64_t stolenCount = 0;
+            // TrySubmit() calls refused because the queue was full
+            std::uint64_t rejectedCount = 0;
+            // Submit() calls that had to wait for space
+            std::uint64_t waitCount = 0;
+        };
+
+      protected:
+        struct Worker
+        {
+            std::mutex mutex;
+            std::condition_variable wakeCondition;
+            std::deque<Task> tasks;
+            std::deque<Task> orderedTasks;
+            std::atomic_bool isIdle = false;
+            std::thread thread;
+        };
+
+        std::vector<std::unique_ptr<Worker>> m_workers;
+        std::uint32_t m_maxQueuedCount = 0;
+        std::atomic_uint32_t m_queuedCount = 0;
+        std::atomic_uint32_t m_nextWorkerIndex = 0;
+        // Tasks without an order key in all deques, idle workers sleep while it is zero
+        std::atomic_uint32_t m_stealableCount = 0;
+        std::atomic_bool m_isStopped = false;
+
+        std::mutex m_spaceMutex;
+        std::condition_variable m_spaceCondition;
+        std::atomic_uint32_t m_waitingSubmitCount = 0;
+
+        std::atomic_uint32_t m_peakQueuedCount = 0;
+        std::atomic_uint64_t m_executedCount = 0;
+        std::atomic_uint64_t m_stolenCount = 0;
+        std::atomic_uint64_t m_rejectedCount = 0;
+        std::atomic_uint64_t m_waitCount = 0;
+
+        bool TryReserve();
+        void Push(Task&& a_task, std::uint64_t a_orderKey);
+        bool TryPopOwn(Worker& a_worker, Task& a_outTask);
+        bool TrySteal(std::size_t a_thiefIndex, Task& a_outTask);
+        void WakeIdleWorker(std::size_t a_skipIndex);
+        void OnTaskTaken();
+        void WorkerLoop(std::size_t a_index);
+
+      public:
+        WorkerPool(std::uint32_t a_threadCount, std::uint32_t a_maxQueuedCount);
+        virtual ~WorkerPool();
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        /// <summary>
+        /// Never blocks. Returns false if the queue is full or the pool is stopped, a_task is left untouched then
+        /// </summary>
+        bool TrySubmit(Task&& a_task, std::uint64_t a_orderKey = NO_ORDER_KEY);
+        /// <summary>
+        /// Waits while the queue is full. Returns false only if the pool is stopped, a_task is left untouched then
+        /// </summary>
+        bool Submit(Task&& a_task, std::uint64_t a_orderKey = NO_ORDER_KEY);
+        /// <summary>
+        /// Joins the workers, queued tasks are dropped
+        /// </summary>
+        void Stop();
+
+        Stats GetStats() const;
+    };
+}
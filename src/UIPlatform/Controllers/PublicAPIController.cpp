@@ -215,11 +215,8 @@ namespace NL::Controllers
                     {
                         a_eventFuncInfo = NL::JS::JSEventFuncInfo::CreateFromFuncInfo(*a_funcInfoArr[i]);
                     }
-                    else
-                    {
-                        jsFuncStorage->AddFunctionCallback(*a_funcInfoArr[i]);
-                    }
                 }
+                jsFuncStorage->AddFunctionCallbacks(a_funcInfoArr, a_funcInfoArrSize);
             }
 
             auto newCefMenu = NL::Services::UIPlatformService::GetSingleton().CreateCefMenu(jsFuncStorage, a_eventFuncInfo);
@@ -272,5 +269,16 @@ namespace NL::Controllers
         m_onShutdownFuncs.push(a_callback);
     }
 
+    void __cdecl PublicAPIController::GetMetrics(OnMetricsFunc_t a_callback)
+    {
+        if (a_callback == nullptr)
+        {
+            return;
+        }
+
+        const auto report = NL::Services::MetricsService::GetSingleton().GetReportJSON();
+        a_callback(report.c_str());
+    }
+
 #pragma endregion
 }
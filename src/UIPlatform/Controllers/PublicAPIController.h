@@ -4,6 +4,7 @@
 #include "Hooks/ShutdownHook.hpp"
 #include "Common/Singleton.h"
 #include "Services/UIPlatformService.h"
+#include "Services/MetricsService.h"
 #include "Providers/CustomCEFSettingsProvider.h"
 
 namespace NL::Controllers
@@ -43,6 +44,8 @@ namespace NL::Controllers
 
         void RegisterOnShutdown(OnShutdownFunc_t a_callback) override;
 
+        void __cdecl GetMetrics(OnMetricsFunc_t a_callback) override;
+
     protected:
         NL::UI::ResponseVersionMessage m_rvMessage{NL::UI::LibVersion::AS_INT, NL::UI::APIVersion::AS_INT};
         NL::UI::ResponseAPIMessage m_rAPIMessage{this};
@@ -2,161 +2,189 @@
 
 namespace NL::Converters
 {
-    void CefValueToJSONConverter::WriteJsonArray(nlohmann::json& a_json, const CefRefPtr<CefListValue>& a_value)
+    void CefValueToJSONConverter::WriteString(std::string& a_out, const CefString& a_value)
     {
-        using namespace nlohmann::literals;
+        // Used up before any nested value is written
+        thread_local std::string utf8Value;
+        NL::IPC::AssignUTF8(utf8Value, a_value);
+        JSONStreamWriter::WriteString(a_out, utf8Value);
+    }
+
+    bool CefValueToJSONConverter::WriteListItem(std::string& a_out, const CefRefPtr<CefListValue>& a_list, size_t a_index)
+    {
+        switch (a_list->GetType(a_index))
+        {
+        case CefValueType::VTYPE_NULL:
+            JSONStreamWriter::WriteNull(a_out);
+            return true;
+        case CefValueType::VTYPE_BOOL:
+            JSONStreamWriter::WriteBool(a_out, a_list->GetBool(a_index));
+            return true;
+        case CefValueType::VTYPE_INT:
+            JSONStreamWriter::WriteInt(a_out, a_list->GetInt(a_index));
+            return true;
+        case CefValueType::VTYPE_DOUBLE:
+            JSONStreamWriter::WriteDouble(a_out, a_list->GetDouble(a_index));
+            return true;
+        case CefValueType::VTYPE_STRING:
+            WriteString(a_out, a_list->GetString(a_index));
+            return true;
+        case CefValueType::VTYPE_DICTIONARY:
+            WriteDictionary(a_out, a_list->GetDictionary(a_index));
+            return true;
+        case CefValueType::VTYPE_LIST:
+            WriteList(a_out, a_list->GetList(a_index));
+            return true;
+        case CefValueType::VTYPE_BINARY:
+            // Only top-level binary arguments are kept (see WriteCallArgs), nested ones are null so item positions don't move
+            JSONStreamWriter::WriteNull(a_out);
+            return true;
+        case CefValueType::VTYPE_INVALID:
+        default:
+            return false;
+        }
+    }
 
-        a_json = nlohmann::json::array();
+    void CefValueToJSONConverter::WriteList(std::string& a_out, const CefRefPtr<CefListValue>& a_value)
+    {
+        a_out += '[';
 
+        auto isFirst = true;
         for (size_t i = 0; i < a_value->GetSize(); ++i)
         {
-            switch (a_value->GetType(i))
+            const auto itemStart = a_out.size();
+            if (!isFirst)
             {
-            case CefValueType::VTYPE_NULL:
-                a_json += nullptr;
-                break;
-            case CefValueType::VTYPE_BOOL:
-                a_json += a_value->GetBool(i);
-                break;
-            case CefValueType::VTYPE_INT:
-                a_json += a_value->GetInt(i);
-                break;
-            case CefValueType::VTYPE_DOUBLE:
-                a_json += a_value->GetDouble(i);
-                break;
-            case CefValueType::VTYPE_STRING:
-                a_json += a_value->GetString(i);
-                break;
-            case CefValueType::VTYPE_DICTIONARY: {
-                nlohmann::json object;
-                WriteJsonObject(object, a_value->GetDictionary(i));
-                a_json += object;
-                break;
+                a_out += ',';
             }
-            case CefValueType::VTYPE_LIST: {
-                nlohmann::json list;
-                WriteJsonArray(list, a_value->GetList(i));
-                a_json += list;
-                break;
+
+            if (WriteListItem(a_out, a_value, i))
+            {
+                isFirst = false;
             }
-            case CefValueType::VTYPE_INVALID:
-            case CefValueType::VTYPE_BINARY:
-                break;
-            default:
-                break;
+            else
+            {
+                a_out.resize(itemStart);
             }
         }
+
+        a_out += ']';
     }
 
-    void CefValueToJSONConverter::WriteJsonObject(nlohmann::json& a_json, const CefRefPtr<CefDictionaryValue>& a_value)
+    void CefValueToJSONConverter::WriteDictionary(std::string& a_out, const CefRefPtr<CefDictionaryValue>& a_value)
     {
-        using namespace nlohmann::literals;
-
-        a_json = nlohmann::json::object();
+        a_out += '{';
 
         CefDictionaryValue::KeyList keys;
         if (!a_value->GetKeys(keys))
         {
+            a_out += '}';
             return;
         }
 
+        // All keys are converted into one block: [(key view, key index)] instead of a string per key
+        std::string keyBlock;
+        size_t keyBlockSize = 0;
         for (const auto& key : keys)
         {
-            switch (a_value->GetType(key))
-            {
-            case CefValueType::VTYPE_NULL:
-                a_json[key] = nullptr;
-                break;
-            case CefValueType::VTYPE_BOOL:
-                a_json[key] = a_value->GetBool(key);
-                break;
-            case CefValueType::VTYPE_INT:
-                a_json[key] = a_value->GetInt(key);
-                break;
-            case CefValueType::VTYPE_DOUBLE:
-                a_json[key] = a_value->GetDouble(key);
-                break;
-            case CefValueType::VTYPE_STRING:
-                a_json[key] = a_value->GetString(key);
-                break;
-            case CefValueType::VTYPE_DICTIONARY: {
-                nlohmann::json object;
-                WriteJsonObject(object, a_value->GetDictionary(key));
-                a_json[key] = object;
-                break;
-            }
-            case CefValueType::VTYPE_LIST: {
-                nlohmann::json list;
-                WriteJsonArray(list, a_value->GetList(key));
-                a_json[key] = list;
-                break;
-            }
-            case CefValueType::VTYPE_INVALID:
-            case CefValueType::VTYPE_BINARY:
-                break;
-            default:
-                break;
-            }
+            keyBlockSize += NL::IPC::GetUTF8Size(key);
         }
-    }
+        keyBlock.resize(keyBlockSize);
 
-    std::shared_ptr<std::vector<std::string>> CefValueToJSONConverter::ConvertToJSONStringArgs(const CefRefPtr<CefListValue>& a_value)
-    {
-        auto result = std::make_shared<std::vector<std::string>>();
-        result->reserve(a_value->GetSize());
+        std::vector<std::pair<std::string_view, size_t>> sortedKeys;
+        sortedKeys.reserve(keys.size());
+        auto keyEnd = keyBlock.data();
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            const auto keyStart = keyEnd;
+            keyEnd = NL::IPC::WriteUTF8(keys[i], keyStart);
+            sortedKeys.emplace_back(std::string_view(keyStart, static_cast<size_t>(keyEnd - keyStart)), i);
+        }
 
-        nlohmann::json json;
-        for (size_t i = 0; i < a_value->GetSize(); ++i)
+        // CEF usually returns sorted keys already
+        if (!std::is_sorted(sortedKeys.begin(), sortedKeys.end()))
         {
-            json.clear();
-            switch (a_value->GetType(i))
+            std::sort(sortedKeys.begin(), sortedKeys.end());
+        }
+
+        auto isFirst = true;
+        for (const auto& [keyString, keyIdx] : sortedKeys)
+        {
+            const auto& key = keys[keyIdx];
+            const auto itemStart = a_out.size();
+            if (!isFirst)
+            {
+                a_out += ',';
+            }
+
+            JSONStreamWriter::WriteString(a_out, keyString);
+            a_out += ':';
+
+            auto isWritten = true;
+            switch (a_value->GetType(key))
             {
             case CefValueType::VTYPE_NULL:
-                json = nullptr;
+                JSONStreamWriter::WriteNull(a_out);
                 break;
             case CefValueType::VTYPE_BOOL:
-                json = a_value->GetBool(i);
+                JSONStreamWriter::WriteBool(a_out, a_value->GetBool(key));
                 break;
             case CefValueType::VTYPE_INT:
-                json = a_value->GetInt(i);
+                JSONStreamWriter::WriteInt(a_out, a_value->GetInt(key));
                 break;
             case CefValueType::VTYPE_DOUBLE:
-                json = a_value->GetDouble(i);
+                JSONStreamWriter::WriteDouble(a_out, a_value->GetDouble(key));
                 break;
             case CefValueType::VTYPE_STRING:
-                json = a_value->GetString(i);
+                WriteString(a_out, a_value->GetString(key));
                 break;
-            case CefValueType::VTYPE_DICTIONARY: {
-                WriteJsonObject(json, a_value->GetDictionary(i));
+            case CefValueType::VTYPE_DICTIONARY:
+                WriteDictionary(a_out, a_value->GetDictionary(key));
                 break;
-            }
-            case CefValueType::VTYPE_LIST: {
-                WriteJsonArray(json, a_value->GetList(i));
+            case CefValueType::VTYPE_LIST:
+                WriteList(a_out, a_value->GetList(key));
                 break;
-            }
-            case CefValueType::VTYPE_INVALID:
             case CefValueType::VTYPE_BINARY:
+                JSONStreamWriter::WriteNull(a_out);
                 break;
+            case CefValueType::VTYPE_INVALID:
             default:
+                isWritten = false;
                 break;
             }
 
-            result->push_back(json.dump());
+            if (isWritten)
+            {
+                isFirst = false;
+            }
+            else
+            {
+                a_out.resize(itemStart);
+            }
         }
 
-        return result;
+        a_out += '}';
     }
 
-    std::vector<const char*> CefValueToJSONConverter::ConvertToCharArray(const std::shared_ptr<std::vector<std::string>>& a_strings)
+    void CefValueToJSONConverter::WriteCallArgs(const CefRefPtr<CefListValue>& a_value, NL::JS::JSCallBuffer& a_outBuffer)
     {
-        std::vector<const char*> result;
-        result.reserve(a_strings->size());
-
-        for (const auto& str : *a_strings.get())
+        for (size_t i = 0; i < a_value->GetSize(); ++i)
         {
-            result.push_back(str.data());
+            if (a_value->GetType(i) == CefValueType::VTYPE_BINARY)
+            {
+                const auto binary = a_value->GetBinary(i);
+                a_outBuffer.AddBinaryArg(binary->GetRawData(), binary->GetSize());
+                continue;
+            }
+
+            auto& arg = a_outBuffer.BeginArg();
+            if (!WriteListItem(arg, a_value, i))
+            {
+                JSONStreamWriter::WriteNull(arg);
+            }
+            a_outBuffer.EndArg();
         }
-        
-        return result;
+
+        a_outBuffer.Finish();
     }
 }
@@ -1,15 +1,33 @@
 #pragma once
 
 #include "PCH.h"
+#include "Converters/JSONStreamWriter.h"
+#include "IPCSharedPayload.h"
+#include "JS/JSCallBuffer.h"
 
 namespace NL::Converters
 {
     class CefValueToJSONConverter final
     {
+      private:
+        /// <summary>
+        /// Strings are converted to UTF-8 in a reused buffer instead of a CefString::ToString() temporary
+        /// </summary>
+        static void WriteString(std::string& a_out, const CefString& a_value);
+
       public:
-        static void WriteJsonArray(nlohmann::json& a_json, const CefRefPtr<CefListValue>& a_value);
-        static void WriteJsonObject(nlohmann::json& a_json, const CefRefPtr<CefDictionaryValue>& a_value);
-        static std::shared_ptr<std::vector<std::string>> ConvertToJSONStringArgs(const CefRefPtr<CefListValue>& a_value);
-        static std::vector<const char*> ConvertToCharArray(const std::shared_ptr<std::vector<std::string>>& a_strings);
+        /// <summary>
+        /// Appends the list item as JSON, binary items are written as null. Returns false for invalid items
+        /// </summary>
+        static bool WriteListItem(std::string& a_out, const CefRefPtr<CefListValue>& a_list, size_t a_index);
+        static void WriteList(std::string& a_out, const CefRefPtr<CefListValue>& a_value);
+        /// <summary>
+        /// Keys are written in byte-wise order
+        /// </summary>
+        static void WriteDictionary(std::string& a_out, const CefRefPtr<CefDictionaryValue>& a_value);
+        /// <summary>
+        /// Writes every list item as a separate JSON argument, binary items are copied as binary arguments
+        /// </summary>
+        static void WriteCallArgs(const CefRefPtr<CefListValue>& a_value, NL::JS::JSCallBuffer& a_outBuffer);
     };
 }
@@ -0,0 +1,197 @@
+#include "IPCPayloadToJSONConverter.h"
+
+namespace NL::Converters
+{
+    bool IPCPayloadToJSONConverter::WriteValue(NL::IPC::PayloadReader& a_reader, std::string& a_out, std::uint32_t a_depth, bool& a_isWritten)
+    {
+        a_isWritten = true;
+
+        NL::IPC::PayloadTag tag;
+        if (a_depth > MAX_DEPTH || !a_reader.ReadTag(tag))
+        {
+            return false;
+        }
+
+        switch (tag)
+        {
+        case NL::IPC::PayloadTag::Null:
+            JSONStreamWriter::WriteNull(a_out);
+            return true;
+        case NL::IPC::PayloadTag::Bool: {
+            std::uint8_t value = 0;
+            if (!a_reader.ReadRaw(value))
+            {
+                return false;
+            }
+            JSONStreamWriter::WriteBool(a_out, value != 0);
+            return true;
+        }
+        case NL::IPC::PayloadTag::Int: {
+            std::int32_t value = 0;
+            if (!a_reader.ReadRaw(value))
+            {
+                return false;
+            }
+            JSONStreamWriter::WriteInt(a_out, value);
+            return true;
+        }
+        case NL::IPC::PayloadTag::Double: {
+            double value = 0;
+            if (!a_reader.ReadRaw(value))
+            {
+                return false;
+            }
+            JSONStreamWriter::WriteDouble(a_out, value);
+            return true;
+        }
+        case NL::IPC::PayloadTag::String: {
+            std::string_view value;
+            if (!a_reader.ReadString(value))
+            {
+                return false;
+            }
+            JSONStreamWriter::WriteString(a_out, value);
+            return true;
+        }
+        case NL::IPC::PayloadTag::List: {
+            std::uint32_t size = 0;
+            if (!a_reader.ReadRaw(size))
+            {
+                return false;
+            }
+
+            a_out += '[';
+            auto isFirst = true;
+            for (std::uint32_t i = 0; i < size; ++i)
+            {
+                const auto itemStart = a_out.size();
+                if (!isFirst)
+                {
+                    a_out += ',';
+                }
+
+                bool isItemWritten;
+                if (!WriteValue(a_reader, a_out, a_depth + 1, isItemWritten))
+                {
+                    return false;
+                }
+
+                if (isItemWritten)
+                {
+                    isFirst = false;
+                }
+                else
+                {
+                    a_out.resize(itemStart);
+                }
+            }
+            a_out += ']';
+            return true;
+        }
+        case NL::IPC::PayloadTag::Dictionary: {
+            std::uint32_t size = 0;
+            if (!a_reader.ReadRaw(size))
+            {
+                return false;
+            }
+
+            // Keys are sorted by the writer
+            a_out += '{';
+            auto isFirst = true;
+            for (std::uint32_t i = 0; i < size; ++i)
+            {
+                const auto itemStart = a_out.size();
+                if (!isFirst)
+                {
+                    a_out += ',';
+                }
+
+                std::string_view key;
+                if (!a_reader.ReadString(key))
+                {
+                    return false;
+                }
+                JSONStreamWriter::WriteString(a_out, key);
+                a_out += ':';
+
+                bool isItemWritten;
+                if (!WriteValue(a_reader, a_out, a_depth + 1, isItemWritten))
+                {
+                    return false;
+                }
+
+                if (isItemWritten)
+                {
+                    isFirst = false;
+                }
+                else
+                {
+                    a_out.resize(itemStart);
+                }
+            }
+            a_out += '}';
+            return true;
+        }
+        case NL::IPC::PayloadTag::Binary: {
+            // Only top-level binary arguments are kept (see ReadCall), nested ones are null so item positions don't move
+            std::string_view value;
+            JSONStreamWriter::WriteNull(a_out);
+            return a_reader.ReadString(value);
+        }
+        case NL::IPC::PayloadTag::Invalid:
+        default:
+            a_isWritten = false;
+            return true;
+        }
+    }
+
+    bool IPCPayloadToJSONConverter::ReadCall(NL::IPC::PayloadReader& a_reader, NL::JS::JSCallBuffer& a_outBuffer)
+    {
+        std::uint32_t argCount = 0;
+        if (!a_reader.ReadRaw(a_outBuffer.funcId) || !a_reader.ReadRaw(a_outBuffer.asyncCallId) || !a_reader.ReadRaw(argCount))
+        {
+            return false;
+        }
+
+        for (std::uint32_t i = 0; i < argCount; ++i)
+        {
+            if (a_reader.PeekTag() == NL::IPC::PayloadTag::Binary)
+            {
+                NL::IPC::PayloadTag tag;
+                std::string_view value;
+                if (!a_reader.ReadTag(tag) || !a_reader.ReadString(value))
+                {
+                    return false;
+                }
+
+                a_outBuffer.AddBinaryArg(value.data(), value.size());
+                continue;
+            }
+
+            auto& arg = a_outBuffer.BeginArg();
+            const auto argStart = arg.size();
+
+            bool isWritten;
+            if (!WriteValue(a_reader, arg, 0, isWritten))
+            {
+                return false;
+            }
+
+            if (!isWritten)
+            {
+                arg.resize(argStart);
+                JSONStreamWriter::WriteNull(arg);
+            }
+            a_outBuffer.EndArg();
+        }
+
+        a_outBuffer.Finish();
+        return true;
+    }
+
+    bool IPCPayloadToJSONConverter::WriteCallArgs(const void* a_payload, size_t a_size, NL::JS::JSCallBuffer& a_outBuffer)
+    {
+        NL::IPC::PayloadReader reader(a_payload, a_size);
+        return ReadCall(reader, a_outBuffer) && reader.IsEnd();
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "PCH.h"
+#include "IPCSharedPayload.h"
+#include "Converters/JSONStreamWriter.h"
+#include "JS/JSCallBuffer.h"
+
+namespace NL::Converters
+{
+    /// <summary>
+    /// Decodes the shared memory call payload straight into JSON call arguments.
+    /// Output matches CefValueToJSONConverter for the same values
+    /// </summary>
+    class IPCPayloadToJSONConverter final
+    {
+      private:
+        static constexpr std::uint32_t MAX_DEPTH = 1024;
+
+        /// <summary>
+        /// a_isWritten is false for invalid values, binary values are written as null. Returns false if the payload is malformed
+        /// </summary>
+        static bool WriteValue(NL::IPC::PayloadReader& a_reader, std::string& a_out, std::uint32_t a_depth, bool& a_isWritten);
+
+      public:
+        /// <summary>
+        /// Reads one call of the payload, returns false if the payload is malformed.
+        /// Top-level binary values become binary arguments, referenced in place if the buffer has a shared region
+        /// </summary>
+        static bool ReadCall(NL::IPC::PayloadReader& a_reader, NL::JS::JSCallBuffer& a_outBuffer);
+        /// <summary>
+        /// The payload must contain exactly one call
+        /// </summary>
+        static bool WriteCallArgs(const void* a_payload, size_t a_size, NL::JS::JSCallBuffer& a_outBuffer);
+    };
+}
@@ -0,0 +1,594 @@
+#include "JSONStreamWriter.h"
+
+#include <intrin.h>
+#include <immintrin.h>
+
+namespace NL::Converters
+{
+    namespace
+    {
+        // Same as nlohmann::detail::to_chars, printf("%g") like switch between fixed and exponent notation
+        constexpr int DOUBLE_MIN_EXP = -4;
+        constexpr int DOUBLE_MAX_EXP = std::numeric_limits<double>::digits10;
+
+        void AppendExponent(std::string& a_out, int a_exponent)
+        {
+            if (a_exponent < 0)
+            {
+                a_out += '-';
+                a_exponent = -a_exponent;
+            }
+            else
+            {
+                a_out += '+';
+            }
+
+            if (a_exponent < 10)
+            {
+                a_out += '0';
+            }
+
+            char buffer[8];
+            const auto result = std::to_chars(buffer, buffer + sizeof(buffer), a_exponent);
+            a_out.append(buffer, result.ptr);
+        }
+
+        constexpr char HEX_DIGITS[] = "0123456789abcdef";
+        constexpr auto REPLACEMENT_CHARACTER = "\xEF\xBF\xBD"sv;
+
+        bool IsEscaped(unsigned char a_ch)
+        {
+            return a_ch < 0x20 || a_ch == '"' || a_ch == '\\';
+        }
+
+        void AppendEscaped(std::string& a_out, unsigned char a_ch)
+        {
+            switch (a_ch)
+            {
+            case '"':
+                a_out += "\\\""sv;
+                break;
+            case '\\':
+                a_out += "\\\\"sv;
+                break;
+            case '\b':
+                a_out += "\\b"sv;
+                break;
+            case '\f':
+                a_out += "\\f"sv;
+                break;
+            case '\n':
+                a_out += "\\n"sv;
+                break;
+            case '\r':
+                a_out += "\\r"sv;
+                break;
+            case '\t':
+                a_out += "\\t"sv;
+                break;
+            default:
+                a_out += "\\u00"sv;
+                a_out += HEX_DIGITS[a_ch >> 4];
+                a_out += HEX_DIGITS[a_ch & 0x0F];
+                break;
+            }
+        }
+
+        /// <summary>
+        /// Length of the well-formed sequence at a_data (Unicode table 3-7), or 0 and the length of its maximal subpart
+        /// </summary>
+        std::size_t GetUTF8SequenceLength(const unsigned char* a_data, std::size_t a_size, std::size_t& a_outInvalidLength)
+        {
+            const auto lead = a_data[0];
+            std::size_t length = 0;
+            unsigned char secondMin = 0x80;
+            unsigned char secondMax = 0xBF;
+            if (lead >= 0xC2 && lead <= 0xDF)
+            {
+                length = 2;
+            }
+            else if (lead >= 0xE0 && lead <= 0xEF)
+            {
+                length = 3;
+                secondMin = lead == 0xE0 ? 0xA0 : secondMin;
+                // Surrogates
+                secondMax = lead == 0xED ? 0x9F : secondMax;
+            }
+            else if (lead >= 0xF0 && lead <= 0xF4)
+            {
+                length = 4;
+                secondMin = lead == 0xF0 ? 0x90 : secondMin;
+                secondMax = lead == 0xF4 ? 0x8F : secondMax;
+            }
+            else
+            {
+                a_outInvalidLength = 1;
+                return 0;
+            }
+
+            for (std::size_t i = 1; i < length; ++i)
+            {
+                const auto min = i == 1 ? secondMin : 0x80;
+                const auto max = i == 1 ? secondMax : 0xBF;
+                if (i >= a_size || a_data[i] < min || a_data[i] > max)
+                {
+                    a_outInvalidLength = i;
+                    return 0;
+                }
+            }
+
+            return length;
+        }
+
+        /// <summary>
+        /// Writes characters from a_pos until a_end, a character starting before a_end is written whole.
+        /// Returns the position after the last written character
+        /// </summary>
+        std::size_t WriteStringScalar(std::string& a_out, const unsigned char* a_data, std::size_t a_size, std::size_t a_pos, std::size_t a_end)
+        {
+            auto runStart = a_pos;
+            while (a_pos < a_end)
+            {
+                const auto ch = a_data[a_pos];
+                if (ch < 0x80)
+                {
+                    if (IsEscaped(ch))
+                    {
+                        a_out.append(reinterpret_cast<const char*>(a_data) + runStart, a_pos - runStart);
+                        AppendEscaped(a_out, ch);
+                        runStart = a_pos + 1;
+                    }
+                    ++a_pos;
+                    continue;
+                }
+
+                std::size_t invalidLength = 0;
+                const auto length = GetUTF8SequenceLength(a_data + a_pos, a_size - a_pos, invalidLength);
+                if (length != 0)
+                {
+                    a_pos += length;
+                    continue;
+                }
+
+                a_out.append(reinterpret_cast<const char*>(a_data) + runStart, a_pos - runStart);
+                a_out += REPLACEMENT_CHARACTER;
+                a_pos += invalidLength;
+                runStart = a_pos;
+            }
+            a_out.append(reinterpret_cast<const char*>(a_data) + runStart, a_pos - runStart);
+
+            return a_pos;
+        }
+
+        void WriteStringScalar(std::string& a_out, const unsigned char* a_data, std::size_t a_size)
+        {
+            WriteStringScalar(a_out, a_data, a_size, 0, a_size);
+        }
+
+        // UTF-8 validation tables of "Validating UTF-8 In Less Than One Instruction Per Byte" (Keiser, Lemire).
+        // An error bit is set in all three lookups of a byte pair only if the pair is ill-formed
+        constexpr std::uint8_t TOO_SHORT = 1 << 0;
+        constexpr std::uint8_t TOO_LONG = 1 << 1;
+        constexpr std::uint8_t OVERLONG_3 = 1 << 2;
+        constexpr std::uint8_t TOO_LARGE = 1 << 3;
+        constexpr std::uint8_t SURROGATE = 1 << 4;
+        constexpr std::uint8_t OVERLONG_2 = 1 << 5;
+        // Shared bit: F0 80..8F is overlong, F5.. 80..8F is too large
+        constexpr std::uint8_t TOO_LARGE_1000 = 1 << 6;
+        constexpr std::uint8_t OVERLONG_4 = 1 << 6;
+        constexpr std::uint8_t TWO_CONTS = 1 << 7;
+        constexpr std::uint8_t CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+        // By the high nibble of the first byte
+        alignas(16) constexpr std::uint8_t BYTE_1_HIGH[16] = {
+            TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+            TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+            TOO_SHORT | OVERLONG_2,
+            TOO_SHORT,
+            TOO_SHORT | OVERLONG_3 | SURROGATE,
+            TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4};
+
+        // By the low nibble of the first byte
+        alignas(16) constexpr std::uint8_t BYTE_1_LOW[16] = {
+            CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+            CARRY | OVERLONG_2,
+            CARRY,
+            CARRY,
+            CARRY | TOO_LARGE,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000};
+
+        // By the high nibble of the second byte
+        alignas(16) constexpr std::uint8_t BYTE_2_HIGH[16] = {
+            TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+            TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT};
+
+        struct SimdSSSE3
+        {
+            using Vector = __m128i;
+            static constexpr std::size_t WIDTH = 16;
+
+            static Vector Load(const unsigned char* a_data)
+            {
+                return _mm_loadu_si128(reinterpret_cast<const __m128i*>(a_data));
+            }
+
+            static Vector Set(std::uint8_t a_value)
+            {
+                return _mm_set1_epi8(static_cast<char>(a_value));
+            }
+
+            static Vector Lookup(const std::uint8_t (&a_table)[16], Vector a_index)
+            {
+                return _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(a_table)), a_index);
+            }
+
+            static Vector GetHighNibble(Vector a_value)
+            {
+                return _mm_and_si128(_mm_srli_epi16(a_value, 4), Set(0x0F));
+            }
+
+            static Vector GetLowNibble(Vector a_value)
+            {
+                return _mm_and_si128(a_value, Set(0x0F));
+            }
+
+            // Bytes of the previous block are treated as ASCII
+            template <int N>
+            static Vector GetPrevious(Vector a_value)
+            {
+                return _mm_slli_si128(a_value, N);
+            }
+
+            static Vector And(Vector a_left, Vector a_right)
+            {
+                return _mm_and_si128(a_left, a_right);
+            }
+
+            static Vector Or(Vector a_left, Vector a_right)
+            {
+                return _mm_or_si128(a_left, a_right);
+            }
+
+            static Vector Xor(Vector a_left, Vector a_right)
+            {
+                return _mm_xor_si128(a_left, a_right);
+            }
+
+            static Vector SubtractSaturated(Vector a_left, Vector a_right)
+            {
+                return _mm_subs_epu8(a_left, a_right);
+            }
+
+            static bool IsZero(Vector a_value)
+            {
+                return _mm_movemask_epi8(_mm_cmpeq_epi8(a_value, _mm_setzero_si128())) == 0xFFFF;
+            }
+
+            static std::uint32_t GetEscapeMask(Vector a_value)
+            {
+                const auto isControl = _mm_cmpeq_epi8(_mm_min_epu8(a_value, Set(0x1F)), a_value);
+                const auto isQuote = _mm_cmpeq_epi8(a_value, Set('"'));
+                const auto isBackslash = _mm_cmpeq_epi8(a_value, Set('\\'));
+                return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_or_si128(isControl, _mm_or_si128(isQuote, isBackslash))));
+            }
+
+            static std::uint32_t GetNonASCIIMask(Vector a_value)
+            {
+                return static_cast<std::uint32_t>(_mm_movemask_epi8(a_value));
+            }
+        };
+
+        struct SimdAVX2
+        {
+            using Vector = __m256i;
+            static constexpr std::size_t WIDTH = 32;
+
+            static Vector Load(const unsigned char* a_data)
+            {
+                return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a_data));
+            }
+
+            static Vector Set(std::uint8_t a_value)
+            {
+                return _mm256_set1_epi8(static_cast<char>(a_value));
+            }
+
+            static Vector Lookup(const std::uint8_t (&a_table)[16], Vector a_index)
+            {
+                return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(a_table))), a_index);
+            }
+
+            static Vector GetHighNibble(Vector a_value)
+            {
+                return _mm256_and_si256(_mm256_srli_epi16(a_value, 4), Set(0x0F));
+            }
+
+            static Vector GetLowNibble(Vector a_value)
+            {
+                return _mm256_and_si256(a_value, Set(0x0F));
+            }
+
+            // Bytes of the previous block are treated as ASCII. Shifts across the 128-bit lanes: [0, low lane] is the source of the high lane
+            template <int N>
+            static Vector GetPrevious(Vector a_value)
+            {
+                return _mm256_alignr_epi8(a_value, _mm256_permute2x128_si256(a_value, a_value, 0x08), 16 - N);
+            }
+
+            static Vector And(Vector a_left, Vector a_right)
+            {
+                return _mm256_and_si256(a_left, a_right);
+            }
+
+            static Vector Or(Vector a_left, Vector a_right)
+            {
+                return _mm256_or_si256(a_left, a_right);
+            }
+
+            static Vector Xor(Vector a_left, Vector a_right)
+            {
+                return _mm256_xor_si256(a_left, a_right);
+            }
+
+            static Vector SubtractSaturated(Vector a_left, Vector a_right)
+            {
+                return _mm256_subs_epu8(a_left, a_right);
+            }
+
+            static bool IsZero(Vector a_value)
+            {
+                return _mm256_testz_si256(a_value, a_value) != 0;
+            }
+
+            static std::uint32_t GetEscapeMask(Vector a_value)
+            {
+                const auto isControl = _mm256_cmpeq_epi8(_mm256_min_epu8(a_value, Set(0x1F)), a_value);
+                const auto isQuote = _mm256_cmpeq_epi8(a_value, Set('"'));
+                const auto isBackslash = _mm256_cmpeq_epi8(a_value, Set('\\'));
+                return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(isControl, _mm256_or_si256(isQuote, isBackslash))));
+            }
+
+            static std::uint32_t GetNonASCIIMask(Vector a_value)
+            {
+                return static_cast<std::uint32_t>(_mm256_movemask_epi8(a_value));
+            }
+        };
+
+        /// <summary>
+        /// Block must start at a character boundary. A sequence cut by the block end is not an error
+        /// </summary>
+        template <class Simd>
+        bool HasUTF8Error(typename Simd::Vector a_block)
+        {
+            const auto prev1 = Simd::template GetPrevious<1>(a_block);
+            const auto specialCases = Simd::And(Simd::And(Simd::Lookup(BYTE_1_HIGH, Simd::GetHighNibble(prev1)),
+                                                          Simd::Lookup(BYTE_1_LOW, Simd::GetLowNibble(prev1))),
+                                                Simd::Lookup(BYTE_2_HIGH, Simd::GetHighNibble(a_block)));
+
+            // Third and fourth bytes of a sequence must be continuations, only 111_____ and 1111____ get the high bit
+            const auto isThirdByte = Simd::SubtractSaturated(Simd::template GetPrevious<2>(a_block), Simd::Set(0xE0 - 0x80));
+            const auto isFourthByte = Simd::SubtractSaturated(Simd::template GetPrevious<3>(a_block), Simd::Set(0xF0 - 0x80));
+            const auto mustBeContinuation = Simd::And(Simd::Or(isThirdByte, isFourthByte), Simd::Set(0x80));
+
+            return !Simd::IsZero(Simd::Xor(mustBeContinuation, specialCases));
+        }
+
+        /// <summary>
+        /// Length of the unfinished sequence at the end of a well-formed block
+        /// </summary>
+        std::size_t GetIncompleteTailLength(const unsigned char* a_blockEnd)
+        {
+            if (a_blockEnd[-1] >= 0xC0)
+            {
+                return 1;
+            }
+            if (a_blockEnd[-2] >= 0xE0)
+            {
+                return 2;
+            }
+            if (a_blockEnd[-3] >= 0xF0)
+            {
+                return 3;
+            }
+            return 0;
+        }
+
+        /// <summary>
+        /// Clean runs are copied in bulk. Blocks with an escape after non-ASCII text or with ill-formed UTF-8 are written by the scalar path
+        /// </summary>
+        template <class Simd>
+        void WriteStringSimd(std::string& a_out, const unsigned char* a_data, std::size_t a_size)
+        {
+            const auto appendRun = [&](std::size_t a_start, std::size_t a_end) {
+                a_out.append(reinterpret_cast<const char*>(a_data) + a_start, a_end - a_start);
+            };
+
+            std::size_t pos = 0;
+            std::size_t runStart = 0;
+            while (a_size - pos >= Simd::WIDTH)
+            {
+                const auto block = Simd::Load(a_data + pos);
+                const auto escapeMask = Simd::GetEscapeMask(block);
+                const auto nonASCIIMask = Simd::GetNonASCIIMask(block);
+                if ((escapeMask | nonASCIIMask) == 0)
+                {
+                    pos += Simd::WIDTH;
+                    continue;
+                }
+
+                if (nonASCIIMask == 0 || !HasUTF8Error<Simd>(block))
+                {
+                    // An escaped byte can't be a part of a well-formed sequence
+                    for (auto mask = escapeMask; mask != 0; mask &= mask - 1)
+                    {
+                        const auto escapePos = pos + std::countr_zero(mask);
+                        appendRun(runStart, escapePos);
+                        AppendEscaped(a_out, a_data[escapePos]);
+                        runStart = escapePos + 1;
+                    }
+
+                    // A sequence cut by the block end is checked with the next block
+                    pos += Simd::WIDTH - (nonASCIIMask != 0 ? GetIncompleteTailLength(a_data + pos + Simd::WIDTH) : 0);
+                    continue;
+                }
+
+                appendRun(runStart, pos);
+                pos = WriteStringScalar(a_out, a_data, a_size, pos, pos + Simd::WIDTH);
+                runStart = pos;
+            }
+
+            appendRun(runStart, pos);
+            WriteStringScalar(a_out, a_data, a_size, pos, a_size);
+        }
+
+        using WriteStringFunc = void (*)(std::string&, const unsigned char*, std::size_t);
+
+        WriteStringFunc SelectWriteString()
+        {
+            int cpuInfo[4];
+            __cpuid(cpuInfo, 0);
+            const auto maxLeaf = cpuInfo[0];
+
+            __cpuid(cpuInfo, 1);
+            const auto hasSSSE3 = (cpuInfo[2] & (1 << 9)) != 0;
+            // AVX registers must be saved by the OS too
+            const auto hasOSAVX = (cpuInfo[2] & (1 << 27)) != 0 && (cpuInfo[2] & (1 << 28)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+            if (hasOSAVX && maxLeaf >= 7)
+            {
+                __cpuidex(cpuInfo, 7, 0);
+                if ((cpuInfo[1] & (1 << 5)) != 0)
+                {
+                    return WriteStringSimd<SimdAVX2>;
+                }
+            }
+
+            return hasSSSE3 ? WriteStringSimd<SimdSSSE3> : static_cast<WriteStringFunc>(WriteStringScalar);
+        }
+    }
+
+    void JSONStreamWriter::WriteNull(std::string& a_out)
+    {
+        a_out += "null"sv;
+    }
+
+    void JSONStreamWriter::WriteBool(std::string& a_out, bool a_value)
+    {
+        a_out += a_value ? "true"sv : "false"sv;
+    }
+
+    void JSONStreamWriter::WriteInt(std::string& a_out, std::int64_t a_value)
+    {
+        char buffer[24];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), a_value);
+        a_out.append(buffer, result.ptr);
+    }
+
+    void JSONStreamWriter::WriteDouble(std::string& a_out, double a_value)
+    {
+        if (!std::isfinite(a_value))
+        {
+            WriteNull(a_out);
+            return;
+        }
+
+        if (std::signbit(a_value))
+        {
+            a_out += '-';
+            a_value = -a_value;
+        }
+
+        if (a_value == 0)
+        {
+            a_out += "0.0"sv;
+            return;
+        }
+
+        // Shortest round-trip digits as "d.ddde+XX"
+        char scientific[32];
+        const auto result = std::to_chars(scientific, scientific + sizeof(scientific), a_value, std::chars_format::scientific);
+
+        char digits[24];
+        int digitCount = 0;
+        const char* it = scientific;
+        for (; it != result.ptr && *it != 'e'; ++it)
+        {
+            if (*it != '.')
+            {
+                digits[digitCount++] = *it;
+            }
+        }
+
+        int exponent = 0;
+        if (it != result.ptr)
+        {
+            ++it;
+            const auto isNegative = *it == '-';
+            if (*it == '-' || *it == '+')
+            {
+                ++it;
+            }
+            std::from_chars(it, result.ptr, exponent);
+            exponent = isNegative ? -exponent : exponent;
+        }
+
+        // value = 0.digits * 10^pointPos
+        const int pointPos = exponent + 1;
+        if (digitCount <= pointPos && pointPos <= DOUBLE_MAX_EXP)
+        {
+            // digits[000].0
+            a_out.append(digits, digitCount);
+            a_out.append(static_cast<std::size_t>(pointPos - digitCount), '0');
+            a_out += ".0"sv;
+        }
+        else if (0 < pointPos && pointPos <= DOUBLE_MAX_EXP)
+        {
+            // dig.its
+            a_out.append(digits, pointPos);
+            a_out += '.';
+            a_out.append(digits + pointPos, digitCount - pointPos);
+        }
+        else if (DOUBLE_MIN_EXP < pointPos && pointPos <= 0)
+        {
+            // 0.[000]digits
+            a_out += "0."sv;
+            a_out.append(static_cast<std::size_t>(-pointPos), '0');
+            a_out.append(digits, digitCount);
+        }
+        else
+        {
+            // d.igitse+XX
+            a_out += digits[0];
+            if (digitCount > 1)
+            {
+                a_out += '.';
+                a_out.append(digits + 1, digitCount - 1);
+            }
+            a_out += 'e';
+            AppendExponent(a_out, pointPos - 1);
+        }
+    }
+
+    void JSONStreamWriter::WriteString(std::string& a_out, std::string_view a_value)
+    {
+        static const auto writeString = SelectWriteString();
+
+        a_out.reserve(a_out.size() + a_value.size() + 2);
+        a_out += '"';
+        writeString(a_out, reinterpret_cast<const unsigned char*>(a_value.data()), a_value.size());
+        a_out += '"';
+    }
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "PCH.h"
+
+namespace NL::Converters
+{
+    /// <summary>
+    /// Appends JSON tokens to a caller owned buffer.
+    /// Output matches nlohmann::json::dump() without indentation
+    /// </summary>
+    class JSONStreamWriter final
+    {
+      public:
+        static void WriteNull(std::string& a_out);
+        static void WriteBool(std::string& a_out, bool a_value);
+        static void WriteInt(std::string& a_out, std::int64_t a_value);
+        /// <summary>
+        /// Shortest round-trip representation, non-finite values are written as null
+        /// </summary>
+        static void WriteDouble(std::string& a_out, double a_value);
+        /// <summary>
+        /// Writes quoted and escaped UTF-8 string, ill-formed UTF-8 sequences are replaced with U+FFFD.
+        /// Uses AVX2 or SSSE3 if the CPU supports it
+        /// </summary>
+        static void WriteString(std::string& a_out, std::string_view a_value);
+    };
+}
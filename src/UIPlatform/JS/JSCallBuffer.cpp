@@ -0,0 +1,144 @@
+#include "JSCallBuffer.h"
+
+namespace NL::JS
+{
+    void JSCallBuffer::Clear()
+    {
+        m_data.clear();
+        m_argOffsets.clear();
+        m_argSizes.clear();
+        m_args.clear();
+        m_binaryArgs.clear();
+        m_typedArgs.clear();
+        m_externalSize = 0;
+        m_sharedRegion = nullptr;
+        funcId = 0;
+        asyncCallId = 0;
+        asyncGeneration = 0;
+        metricKey = 0;
+        receiveTime = {};
+    }
+
+    std::uint64_t JSCallBuffer::GetAsyncToken() const
+    {
+        return asyncCallId != 0 ? (static_cast<std::uint64_t>(asyncGeneration) << 32) | asyncCallId : 0;
+    }
+
+    std::string& JSCallBuffer::BeginArg()
+    {
+        m_argOffsets.push_back(static_cast<std::uint32_t>(m_data.size()));
+        return m_data;
+    }
+
+    void JSCallBuffer::EndArg()
+    {
+        m_argSizes.push_back(static_cast<std::uint32_t>(m_data.size() - m_argOffsets.back()));
+        m_data += '\0';
+    }
+
+    void JSCallBuffer::SetSharedRegion(CefRefPtr<CefSharedMemoryRegion> a_region)
+    {
+        m_sharedRegion = a_region;
+    }
+
+    void JSCallBuffer::AddBinaryArg(const void* a_data, size_t a_size)
+    {
+        auto& binaryArg = m_binaryArgs.emplace_back();
+        binaryArg.argIndex = static_cast<std::uint32_t>(m_argOffsets.size());
+        binaryArg.size = static_cast<std::uint32_t>(a_size);
+
+        BeginArg() += "null";
+        EndArg();
+
+        // The region stays mapped while this buffer holds it
+        if (m_sharedRegion != nullptr)
+        {
+            binaryArg.external = static_cast<const char*>(a_data);
+            m_externalSize += a_size;
+        }
+        else
+        {
+            binaryArg.offset = static_cast<std::uint32_t>(m_data.size());
+            m_data.append(static_cast<const char*>(a_data), a_size);
+        }
+    }
+
+    void JSCallBuffer::Finish()
+    {
+        // m_data doesn't reallocate anymore, pointers stay valid
+        m_args.clear();
+        m_typedArgs.clear();
+        for (size_t i = 0; i < m_argOffsets.size(); ++i)
+        {
+            const auto arg = m_data.data() + m_argOffsets[i];
+            m_args.push_back(arg);
+            m_typedArgs.push_back({NL::JS::JSArgType::JSON, arg, m_argSizes[i]});
+        }
+
+        for (const auto& binaryArg : m_binaryArgs)
+        {
+            auto& typedArg = m_typedArgs[binaryArg.argIndex];
+            typedArg.type = NL::JS::JSArgType::Binary;
+            typedArg.data = binaryArg.external != nullptr ? binaryArg.external : m_data.data() + binaryArg.offset;
+            typedArg.size = binaryArg.size;
+        }
+    }
+
+    const char** JSCallBuffer::GetArgs()
+    {
+        return m_args.data();
+    }
+
+    const NL::JS::JSArg* JSCallBuffer::GetTypedArgs()
+    {
+        return m_typedArgs.data();
+    }
+
+    int JSCallBuffer::GetArgsCount() const
+    {
+        return static_cast<int>(m_args.size());
+    }
+
+    size_t JSCallBuffer::GetCapacity() const
+    {
+        return m_data.capacity();
+    }
+
+    size_t JSCallBuffer::GetDataSize() const
+    {
+        return m_data.size() + m_externalSize;
+    }
+
+    std::shared_ptr<JSCallBuffer> JSCallBufferPool::Acquire()
+    {
+        m_poolLock.Lock();
+        if (!m_pool.empty())
+        {
+            auto buffer = std::move(m_pool.back());
+            m_pool.pop_back();
+            m_poolLock.Unlock();
+            return buffer;
+        }
+        m_poolLock.Unlock();
+
+        return std::make_shared<JSCallBuffer>();
+    }
+
+    void JSCallBufferPool::Release(std::shared_ptr<JSCallBuffer>&& a_buffer)
+    {
+        auto buffer = std::move(a_buffer);
+        if (buffer == nullptr || buffer.use_count() != 1 || buffer->GetCapacity() > MAX_POOLED_CAPACITY)
+        {
+            return;
+        }
+
+        buffer->Clear();
+
+        m_poolLock.Lock();
+        if (m_pool.size() < MAX_POOL_SIZE)
+        {
+            m_pool.push_back(std::move(buffer));
+        }
+        m_poolLock.Unlock();
+    }
+}
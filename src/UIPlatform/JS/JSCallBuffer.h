@@ -0,0 +1,106 @@
+#pragma once
+
+#include "PCH.h"
+#include "Common/Singleton.h"
+#include "Common/SpinLock.h"
+
+namespace NL::JS
+{
+    /// <summary>
+    /// One JS to native call: function id and all JSON arguments in a single null separated block with an offset table.
+    /// Binary arguments are "null" in the JSON view, their bytes follow the JSON in the block or stay in the shared memory region (see SetSharedRegion)
+    /// </summary>
+    class JSCallBuffer
+    {
+      protected:
+        struct BinaryArg
+        {
+            std::uint32_t argIndex = 0;
+            // Offset in m_data if external is nullptr
+            std::uint32_t offset = 0;
+            std::uint32_t size = 0;
+            const char* external = nullptr;
+        };
+
+        std::string m_data;
+        std::vector<std::uint32_t> m_argOffsets;
+        std::vector<std::uint32_t> m_argSizes;
+        std::vector<const char*> m_args;
+        std::vector<BinaryArg> m_binaryArgs;
+        std::vector<NL::JS::JSArg> m_typedArgs;
+        size_t m_externalSize = 0;
+        CefRefPtr<CefSharedMemoryRegion> m_sharedRegion = nullptr;
+
+      public:
+        // See JSFunctionStorage::FuncId
+        std::uint32_t funcId = 0;
+        // Not 0 if the JS side waits for a result (see JSFuncAsyncCallback)
+        std::uint32_t asyncCallId = 0;
+        // Page generation of the browser when the call arrived, see GetAsyncToken()
+        std::uint32_t asyncGeneration = 0;
+        // Set by JSFunctionStorage, see MetricsService
+        std::uint64_t metricKey = 0;
+        // When the IPC message arrived, the queue wait is measured from here
+        std::chrono::steady_clock::time_point receiveTime;
+
+        void Clear();
+
+        /// <summary>
+        /// [asyncGeneration:32][asyncCallId:32], 0 if the JS side doesn't wait for a result
+        /// </summary>
+        std::uint64_t GetAsyncToken() const;
+
+        /// <summary>
+        /// Starts a new argument, append its content to the returned string and call EndArg()
+        /// </summary>
+        std::string& BeginArg();
+        void EndArg();
+        /// <summary>
+        /// The payload memory of the following binary arguments, they are referenced instead of copied while the region is set
+        /// </summary>
+        void SetSharedRegion(CefRefPtr<CefSharedMemoryRegion> a_region);
+        /// <summary>
+        /// Adds an argument that is "null" in the JSON view
+        /// </summary>
+        void AddBinaryArg(const void* a_data, size_t a_size);
+        /// <summary>
+        /// Must be called after the last argument, builds the pointer tables for GetArgs() and GetTypedArgs()
+        /// </summary>
+        void Finish();
+
+        const char** GetArgs();
+        /// <summary>
+        /// See JSFuncBinaryCallback
+        /// </summary>
+        const NL::JS::JSArg* GetTypedArgs();
+        int GetArgsCount() const;
+        size_t GetCapacity() const;
+        /// <summary>
+        /// Size of all JSON and binary arguments
+        /// </summary>
+        size_t GetDataSize() const;
+    };
+
+    /// <summary>
+    /// Recycles call buffers, so a call allocates only while the pool is warming up
+    /// </summary>
+    class JSCallBufferPool : public NL::Common::Singleton<JSCallBufferPool>
+    {
+      protected:
+        friend class NL::Common::Singleton<JSCallBufferPool>;
+
+        static constexpr size_t MAX_POOL_SIZE = 64;
+        // Bigger buffers are freed instead of being kept around
+        static constexpr size_t MAX_POOLED_CAPACITY = 64 * 1024;
+
+        NL::Common::SpinLock m_poolLock;
+        std::vector<std::shared_ptr<JSCallBuffer>> m_pool;
+
+      public:
+        std::shared_ptr<JSCallBuffer> Acquire();
+        /// <summary>
+        /// Returns the buffer to the pool if the caller is the last owner
+        /// </summary>
+        void Release(std::shared_ptr<JSCallBuffer>&& a_buffer);
+    };
+}
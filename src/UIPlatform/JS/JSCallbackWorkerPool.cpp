@@ -0,0 +1,9 @@
+#include "JSCallbackWorkerPool.h"
+
+namespace NL::JS
+{
+    JSCallbackWorkerPool::JSCallbackWorkerPool()
+        : NL::Common::WorkerPool(std::clamp(std::thread::hardware_concurrency() / 4, 2u, MAX_THREAD_COUNT), MAX_QUEUED_COUNT)
+    {
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "PCH.h"
+#include "Common/Singleton.h"
+#include "Common/WorkerPool.h"
+
+namespace NL::JS
+{
+    /// <summary>
+    /// Runs callbacks of functions with executeInGameThread = false, so slow callbacks don't block the CEF UI thread
+    /// </summary>
+    class JSCallbackWorkerPool : public NL::Common::Singleton<JSCallbackWorkerPool>,
+                                 public NL::Common::WorkerPool
+    {
+      protected:
+        friend class NL::Common::Singleton<JSCallbackWorkerPool>;
+
+        static constexpr std::uint32_t MAX_THREAD_COUNT = 4;
+        static constexpr std::uint32_t MAX_QUEUED_COUNT = 4096;
+
+        JSCallbackWorkerPool();
+
+      public:
+        ~JSCallbackWorkerPool() override = default;
+    };
+}
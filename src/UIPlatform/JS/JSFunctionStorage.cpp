@@ -2,142 +2,497 @@
 
 namespace NL::JS
 {
-    std::recursive_mutex& JSFunctionStorage::GetCallbackMutex()
+    const JSFunctionStorage::FunctionSlot* JSFunctionStorage::Snapshot::FindSlot(FuncId a_funcId) const
     {
-        return m_funcCallbackMapMutex;
+        const auto slotIndex = a_funcId & SLOT_INDEX_MASK;
+        if (a_funcId == INVALID_FUNC_ID || slotIndex >= funcSlots.size() || funcSlots[slotIndex].id != a_funcId)
+        {
+            return nullptr;
+        }
+
+        return &funcSlots[slotIndex];
     }
 
-    bool JSFunctionStorage::AddFunctionCallback(const NL::JS::JSFuncInfo& a_funcInfo)
+    JSFunctionStorage::SnapshotReadGuard::SnapshotReadGuard(const JSFunctionStorage& a_storage)
+        : m_stripe(a_storage.m_readerStripes[GetReaderStripeIndex()])
+    {
+        // Seq-cst pairs with PublishSnapshot and ReclaimRetiredSnapshots: a reclaimer that doesn't see this count
+        // has replaced the snapshot before this load
+        m_stripe.count.fetch_add(1, std::memory_order_seq_cst);
+        m_snapshot = a_storage.m_snapshot.load(std::memory_order_seq_cst);
+    }
+
+    JSFunctionStorage::SnapshotReadGuard::~SnapshotReadGuard()
+    {
+        m_stripe.count.fetch_sub(1, std::memory_order_release);
+    }
+
+    const JSFunctionStorage::Snapshot* JSFunctionStorage::SnapshotReadGuard::operator->() const
+    {
+        return m_snapshot;
+    }
+
+    JSFunctionStorage::JSFunctionStorage()
+    {
+        m_snapshot.store(new Snapshot());
+    }
+
+    JSFunctionStorage::~JSFunctionStorage()
+    {
+        delete m_snapshot.load(std::memory_order_relaxed);
+    }
+
+    size_t JSFunctionStorage::GetReaderStripeIndex()
+    {
+        static std::atomic<size_t> s_nextStripeIndex = 0;
+        thread_local const size_t stripeIndex = s_nextStripeIndex.fetch_add(1, std::memory_order_relaxed) % READER_STRIPE_COUNT;
+        return stripeIndex;
+    }
+
+    std::unique_ptr<JSFunctionStorage::Snapshot> JSFunctionStorage::CopySnapshot() const
     {
-        if (a_funcInfo.objectName == nullptr || a_funcInfo.funcName == nullptr)
+        // Only writers replace the current snapshot, it can't be freed while m_writeMutex is locked
+        return std::make_unique<Snapshot>(*m_snapshot.load(std::memory_order_relaxed));
+    }
+
+    void JSFunctionStorage::PublishSnapshot(std::unique_ptr<Snapshot> a_snapshot)
+    {
+        m_retiredSnapshots.emplace_back(m_snapshot.exchange(a_snapshot.release(), std::memory_order_seq_cst));
+        ReclaimRetiredSnapshots();
+    }
+
+    void JSFunctionStorage::ReclaimRetiredSnapshots()
+    {
+        if (m_retiredSnapshots.empty())
         {
-            return false;
+            return;
+        }
+
+        // Readers hold a snapshot only for a lookup, so usually all stripes are zero. Otherwise it is retried on the next write or frame
+        for (const auto& stripe : m_readerStripes)
+        {
+            if (stripe.count.load(std::memory_order_seq_cst) != 0)
+            {
+                return;
+            }
+        }
+
+        m_retiredSnapshots.clear();
+    }
+
+    JSFunctionStorage::FuncIdMap& JSFunctionStorage::GetWritableFuncIdMap(Snapshot& a_snapshot, std::string_view a_objectName, std::vector<const FuncIdMap*>& a_copiedMaps)
+    {
+        auto objIt = a_snapshot.funcIdMap.find(a_objectName);
+        if (objIt == a_snapshot.funcIdMap.end())
+        {
+            objIt = a_snapshot.funcIdMap.emplace(std::string(a_objectName), std::make_shared<FuncIdMap>()).first;
+            a_copiedMaps.push_back(objIt->second.get());
+        }
+        else if (std::find(a_copiedMaps.cbegin(), a_copiedMaps.cend(), objIt->second.get()) == a_copiedMaps.cend())
+        {
+            // Still shared with the published snapshot
+            objIt->second = std::make_shared<FuncIdMap>(*objIt->second);
+            a_copiedMaps.push_back(objIt->second.get());
         }
 
-        std::lock_guard lock(m_funcCallbackMapMutex);
-        const auto objIt = m_funcCallbackMap.find(a_funcInfo.objectName);
-        if (objIt == m_funcCallbackMap.cend())
+        return *objIt->second;
+    }
+
+    JSFunctionStorage::FuncId JSFunctionStorage::AllocateSlot(Snapshot& a_snapshot, const NL::JS::JSFuncCallbackData& a_callbackData, std::uint64_t a_metricKey)
+    {
+        std::uint32_t slotIndex = 0;
+        if (!a_snapshot.freeSlotIndices.empty())
+        {
+            slotIndex = a_snapshot.freeSlotIndices.back();
+            a_snapshot.freeSlotIndices.pop_back();
+        }
+        else if (a_snapshot.funcSlots.size() <= SLOT_INDEX_MASK)
+        {
+            slotIndex = static_cast<std::uint32_t>(a_snapshot.funcSlots.size());
+            a_snapshot.funcSlots.push_back({INVALID_FUNC_ID, 1});
+        }
+        else
+        {
+            spdlog::error("{}: function limit is reached", NameOf(JSFunctionStorage));
+            return INVALID_FUNC_ID;
+        }
+
+        auto& slot = a_snapshot.funcSlots[slotIndex];
+        slot.id = (slot.generation << SLOT_INDEX_BITS) | slotIndex;
+        slot.metricKey = a_metricKey;
+        slot.callbackData = a_callbackData;
+        return slot.id;
+    }
+
+    void JSFunctionStorage::FreeSlot(Snapshot& a_snapshot, FuncId a_funcId)
+    {
+        const auto slotIndex = a_funcId & SLOT_INDEX_MASK;
+        auto& slot = a_snapshot.funcSlots[slotIndex];
+        slot.id = INVALID_FUNC_ID;
+        slot.metricKey = 0;
+        slot.callbackData = {};
+        // A wrapped generation would let a stale id reach a later function, so the slot is retired instead
+        if (slot.generation == MAX_GENERATION)
         {
-            m_funcCallbackMap.insert({a_funcInfo.objectName, {{a_funcInfo.funcName, a_funcInfo.callbackData}}});
-            return true;
+            return;
         }
 
-        const auto funcIt = objIt->second.find(a_funcInfo.funcName);
-        if (funcIt == objIt->second.cend())
+        ++slot.generation;
+        a_snapshot.freeSlotIndices.push_back(slotIndex);
+    }
+
+    JSFuncCallbackData JSFunctionStorage::GetSupportedCallbackData(const JSFuncCallbackData& a_callbackData)
+    {
+        if (a_callbackData.version == JSFuncCallbackData::VERSION)
         {
-            objIt->second.insert({a_funcInfo.funcName, a_funcInfo.callbackData});
-            return true;
+            return a_callbackData;
         }
 
-        funcIt->second = a_funcInfo.callbackData;
-        return false;
+        JSFuncCallbackData callbackData;
+        callbackData.callback = a_callbackData.callback;
+        callbackData.executeInGameThread = a_callbackData.executeInGameThread;
+        callbackData.isEventFunction = a_callbackData.isEventFunction;
+        return callbackData;
     }
 
-    bool JSFunctionStorage::RemoveFunctionCallback(const std::string& a_objectName, const std::string& a_funcName)
+    bool JSFunctionStorage::IsValidFunctionName(const char* a_objectName, const char* a_funcName)
     {
-        std::lock_guard lock(m_funcCallbackMapMutex);
-        const auto objIt = m_funcCallbackMap.find(a_objectName);
-        if (objIt == m_funcCallbackMap.end())
+        return a_objectName != nullptr && a_funcName != nullptr && std::string_view(a_objectName).find('.') == std::string_view::npos &&
+               std::string_view(a_funcName).find('.') == std::string_view::npos;
+    }
+
+    int JSFunctionStorage::AddToSnapshot(Snapshot& a_snapshot, const NL::JS::JSFuncInfo& a_funcInfo, std::vector<const FuncIdMap*>& a_copiedMaps)
+    {
+        if (!IsValidFunctionName(a_funcInfo.objectName, a_funcInfo.funcName))
+        {
+            spdlog::error("{}: function name {}.{} is not valid, names can't be null or contain '.'",
+                          NameOf(JSFunctionStorage),
+                          a_funcInfo.objectName == nullptr ? "null" : a_funcInfo.objectName,
+                          a_funcInfo.funcName == nullptr ? "null" : a_funcInfo.funcName);
+            return -1;
+        }
+
+        const auto metricName = fmt::format("{}.{}", a_funcInfo.objectName, a_funcInfo.funcName);
+        const auto metricKey = NL::Metrics::MetricTable::MakeKey(metricName);
+        NL::Services::MetricsService::GetSingleton().GetFunctionTable().SetName(metricKey, metricName);
+
+        auto& objectFuncs = GetWritableFuncIdMap(a_snapshot, a_funcInfo.objectName, a_copiedMaps);
+        const auto funcIt = objectFuncs.find(std::string_view(a_funcInfo.funcName));
+        if (funcIt != objectFuncs.cend())
+        {
+            a_snapshot.funcSlots[funcIt->second & SLOT_INDEX_MASK].callbackData = GetSupportedCallbackData(a_funcInfo.callbackData);
+            return 0;
+        }
+
+        const auto funcId = AllocateSlot(a_snapshot, GetSupportedCallbackData(a_funcInfo.callbackData), metricKey);
+        if (funcId == INVALID_FUNC_ID)
+        {
+            return -1;
+        }
+
+        objectFuncs.insert({a_funcInfo.funcName, funcId});
+        return 1;
+    }
+
+    bool JSFunctionStorage::AddFunctionCallback(const NL::JS::JSFuncInfo& a_funcInfo)
+    {
+        std::lock_guard lock(m_writeMutex);
+        auto snapshot = CopySnapshot();
+        std::vector<const FuncIdMap*> copiedMaps;
+        const auto result = AddToSnapshot(*snapshot, a_funcInfo, copiedMaps);
+        if (result < 0)
         {
             return false;
         }
 
-        const auto funcIt = objIt->second.find(a_funcName);
-        if (funcIt == objIt->second.end())
+        PublishSnapshot(std::move(snapshot));
+        return result > 0;
+    }
+
+    std::uint32_t JSFunctionStorage::AddFunctionCallbacks(NL::JS::JSFuncInfo* const* a_funcInfoArr, std::uint32_t a_funcInfoArrSize)
+    {
+        if (a_funcInfoArr == nullptr || a_funcInfoArrSize == 0)
+        {
+            return 0;
+        }
+
+        std::lock_guard lock(m_writeMutex);
+        auto snapshot = CopySnapshot();
+        std::vector<const FuncIdMap*> copiedMaps;
+        std::uint32_t addedCount = 0;
+        for (std::uint32_t i = 0; i < a_funcInfoArrSize; ++i)
+        {
+            if (a_funcInfoArr[i] != nullptr && !a_funcInfoArr[i]->callbackData.isEventFunction && AddToSnapshot(*snapshot, *a_funcInfoArr[i], copiedMaps) > 0)
+            {
+                ++addedCount;
+            }
+        }
+
+        PublishSnapshot(std::move(snapshot));
+        return addedCount;
+    }
+
+    bool JSFunctionStorage::RemoveFunctionCallback(std::string_view a_objectName, std::string_view a_funcName)
+    {
+        std::lock_guard lock(m_writeMutex);
+        const auto current = m_snapshot.load(std::memory_order_relaxed);
+        const auto objIt = current->funcIdMap.find(a_objectName);
+        if (objIt == current->funcIdMap.end() || !objIt->second->contains(a_funcName))
         {
             return false;
         }
 
-        objIt->second.erase(funcIt);
+        auto snapshot = CopySnapshot();
+        std::vector<const FuncIdMap*> copiedMaps;
+        auto& objectFuncs = GetWritableFuncIdMap(*snapshot, a_objectName, copiedMaps);
+        const auto funcIt = objectFuncs.find(a_funcName);
+        FreeSlot(*snapshot, funcIt->second);
+        objectFuncs.erase(funcIt);
+
+        PublishSnapshot(std::move(snapshot));
         return true;
     }
 
     void JSFunctionStorage::ClearFunctionCallback()
     {
-        std::lock_guard lock(m_funcCallbackMapMutex);
-        m_funcCallbackMap.clear();
+        std::lock_guard lock(m_writeMutex);
+        auto snapshot = CopySnapshot();
+        for (const auto& obj : snapshot->funcIdMap)
+        {
+            for (const auto& func : *obj.second)
+            {
+                FreeSlot(*snapshot, func.second);
+            }
+        }
+        snapshot->funcIdMap.clear();
+
+        PublishSnapshot(std::move(snapshot));
     }
 
-    JSFuncCallbackData JSFunctionStorage::GetFunctionCallbackData(const std::string& a_objectName, const std::string& a_funcName)
+    JSFunctionStorage::FuncId JSFunctionStorage::GetFunctionId(std::string_view a_objectName, std::string_view a_funcName)
     {
-        std::lock_guard lock(m_funcCallbackMapMutex);
-        const auto objIt = m_funcCallbackMap.find(a_objectName);
-        if (objIt == m_funcCallbackMap.end())
+        const SnapshotReadGuard snapshot(*this);
+        const auto objIt = snapshot->funcIdMap.find(a_objectName);
+        if (objIt == snapshot->funcIdMap.end())
         {
-            return {};
+            return INVALID_FUNC_ID;
         }
 
-        const auto funcIt = objIt->second.find(a_funcName);
-        if (funcIt == objIt->second.end())
+        const auto funcIt = objIt->second->find(a_funcName);
+        if (funcIt == objIt->second->end())
         {
-            return {};
+            return INVALID_FUNC_ID;
         }
 
         return funcIt->second;
     }
 
-    void JSFunctionStorage::ExecuteFunctionCallback(const std::string& a_objectName,
-                                                    const std::string& a_funcName,
-                                                    std::shared_ptr<std::vector<std::string>> a_funcArgs,
+    JSFuncCallbackData JSFunctionStorage::GetFunctionCallbackData(FuncId a_funcId)
+    {
+        const SnapshotReadGuard snapshot(*this);
+        const auto slot = snapshot->FindSlot(a_funcId);
+        return slot != nullptr ? slot->callbackData : JSFuncCallbackData{};
+    }
+
+    void JSFunctionStorage::InvokeCallback(const JSFuncCallbackData& a_callbackData, JSCallBuffer& a_callBuffer)
+    {
+        const auto startTime = std::chrono::steady_clock::now();
+        if (a_callbackData.binaryArgs)
+        {
+            a_callbackData.binaryCallback(a_callBuffer.GetTypedArgs(), a_callBuffer.GetArgsCount(), a_callbackData.isAsync ? a_callBuffer.GetAsyncToken() : 0);
+        }
+        else if (a_callbackData.isAsync)
+        {
+            a_callbackData.asyncCallback(a_callBuffer.GetArgs(), a_callBuffer.GetArgsCount(), a_callBuffer.GetAsyncToken());
+        }
+        else
+        {
+            a_callbackData.callback(a_callBuffer.GetArgs(), a_callBuffer.GetArgsCount());
+        }
+        const auto endTime = std::chrono::steady_clock::now();
+
+        const auto queueWaitUs = a_callBuffer.receiveTime == std::chrono::steady_clock::time_point{}
+                                     ? NL::Metrics::MetricTable::NO_TIMING
+                                     : NL::Services::MetricsService::GetMicroseconds(startTime - a_callBuffer.receiveTime);
+        NL::Services::MetricsService::GetSingleton().GetFunctionTable().Record(a_callBuffer.metricKey,
+                                                                               a_callBuffer.GetDataSize(),
+                                                                               queueWaitUs,
+                                                                               NL::Services::MetricsService::GetMicroseconds(endTime - startTime));
+    }
+
+    void JSFunctionStorage::ExecuteFunctionCallback(std::shared_ptr<JSCallBuffer> a_callBuffer,
                                                     std::shared_ptr<JSFunctionStorage> a_storage)
     {
-        std::lock_guard lock(m_funcCallbackMapMutex);
-        const auto callbackData = GetFunctionCallbackData(a_objectName, a_funcName);
+        JSFuncCallbackData callbackData;
+        {
+            const SnapshotReadGuard snapshot(*this);
+            if (const auto slot = snapshot->FindSlot(a_callBuffer->funcId); slot != nullptr)
+            {
+                callbackData = slot->callbackData;
+                a_callBuffer->metricKey = slot->metricKey;
+            }
+        }
+
         if (callbackData.callback == nullptr)
         {
-            spdlog::debug("{}: function callback is nullptr for {}.{}", NameOf(JSFunctionStorage), a_objectName.c_str(), a_funcName.c_str());
+            spdlog::debug("{}: function callback is nullptr for id {}", NameOf(JSFunctionStorage), a_callBuffer->funcId);
+            JSCallBufferPool::GetSingleton().Release(std::move(a_callBuffer));
             return;
         }
 
         if (callbackData.executeInGameThread)
         {
-            SKSE::GetTaskInterface()->AddTask([=]() {
-                std::lock_guard lock(a_storage != nullptr ? a_storage->GetCallbackMutex() : m_funcCallbackMapMutex);
-                const auto innerCallbackData = a_storage != nullptr ? a_storage->GetFunctionCallbackData(a_objectName, a_funcName) : GetFunctionCallbackData(a_objectName, a_funcName);
+            m_gameThreadQueue.Push(std::move(a_callBuffer));
+        }
+        else
+        {
+            // Calls of one function run one at a time in call order unless parallelCalls is set
+            const auto funcId = a_callBuffer->funcId;
+            const auto asyncToken = callbackData.isAsync ? a_callBuffer->GetAsyncToken() : 0;
+            const auto orderKey = callbackData.parallelCalls ? NL::Common::WorkerPool::NO_ORDER_KEY : funcId;
+            NL::Common::WorkerPool::Task task = [this, a_storage, callBuffer = std::move(a_callBuffer)]() mutable {
+                // The function can be removed or replaced while the call is queued
+                const auto currentCallbackData = GetFunctionCallbackData(callBuffer->funcId);
+                if (currentCallbackData.callback == nullptr)
+                {
+                    spdlog::debug("{}: function callback is removed for id {}", NameOf(JSFunctionStorage), callBuffer->funcId);
+                }
+                else
+                {
+                    InvokeCallback(currentCallbackData, *callBuffer);
+                }
+                JSCallBufferPool::GetSingleton().Release(std::move(callBuffer));
+            };
 
-                if (innerCallbackData.callback == nullptr)
+            // Backpressure: never block the CEF UI thread or run the callback on it, the call is dropped and counted by the pool.
+            // A dropped task frees its call buffer instead of returning it to the pool
+            if (!JSCallbackWorkerPool::GetSingleton().TrySubmit(std::move(task), orderKey))
+            {
+                spdlog::warn("{}: callback queue is full, call of function id {} is dropped", NameOf(JSFunctionStorage), funcId);
+                if (asyncToken != 0)
                 {
-                    spdlog::debug("{}: function callback is nullptr for {}.{}", NameOf(JSFunctionStorage), a_objectName.c_str(), a_funcName.c_str());
-                    return;
+                    OnAsyncCallDropped(asyncToken);
                 }
+            }
+        }
+    }
 
-                auto argsCharArray = NL::Converters::CefValueToJSONConverter::ConvertToCharArray(a_funcArgs);
-                innerCallbackData.callback(argsCharArray.data(), static_cast<int>(argsCharArray.size()));
-            });
+    void JSFunctionStorage::DrainGameThreadQueue()
+    {
+        // Safe point for snapshots that a reader held during the last write, never wait for a writer on the game thread
+        if (std::unique_lock lock(m_writeMutex, std::try_to_lock); lock.owns_lock())
+        {
+            ReclaimRetiredSnapshots();
         }
-        else
+
+        if (m_gameThreadQueue.IsEmpty())
         {
-            auto argsCharArray = NL::Converters::CefValueToJSONConverter::ConvertToCharArray(a_funcArgs);
-            callbackData.callback(argsCharArray.data(), static_cast<int>(argsCharArray.size()));
+            return;
+        }
+
+        const auto budgetUs = m_gameThreadBudgetUs.load(std::memory_order_relaxed);
+        ::Common::Stopwatch stopwatch;
+        stopwatch.Start();
+
+        std::shared_ptr<JSCallBuffer> callBuffer;
+        while (m_gameThreadQueue.TryPop(callBuffer))
+        {
+            // The function can be removed or replaced while the call is queued, or by a previous callback
+            const auto callbackData = GetFunctionCallbackData(callBuffer->funcId);
+            if (callbackData.callback == nullptr)
+            {
+                spdlog::debug("{}: function callback is removed for id {}", NameOf(JSFunctionStorage), callBuffer->funcId);
+            }
+            else
+            {
+                InvokeCallback(callbackData, *callBuffer);
+            }
+
+            JSCallBufferPool::GetSingleton().Release(std::move(callBuffer));
+
+            // Over budget, the rest runs on the next frame
+            if (stopwatch.GetElapsedMicroseconds() >= budgetUs)
+            {
+                break;
+            }
         }
     }
 
+    void JSFunctionStorage::SetGameThreadBudget(std::uint32_t a_microseconds)
+    {
+        m_gameThreadBudgetUs.store(a_microseconds, std::memory_order_relaxed);
+    }
+
     size_t JSFunctionStorage::GetSize()
     {
-        size_t result = m_funcCallbackMap.size();
-        for (const auto& map : m_funcCallbackMap)
+        const SnapshotReadGuard snapshot(*this);
+        size_t result = snapshot->funcIdMap.size();
+        for (const auto& map : snapshot->funcIdMap)
+        {
+            result += map.second->size();
+        }
+        return result;
+    }
+
+    std::vector<std::pair<std::string, std::string>> JSFunctionStorage::GetFunctionNames()
+    {
+        const SnapshotReadGuard snapshot(*this);
+        std::vector<std::pair<std::string, std::string>> result;
+        result.reserve(snapshot->funcSlots.size() - snapshot->freeSlotIndices.size());
+        for (const auto& [objectName, funcMap] : snapshot->funcIdMap)
         {
-            result += map.second.size();
+            for (const auto& [funcName, funcId] : *funcMap)
+            {
+                result.emplace_back(objectName, funcName);
+            }
         }
         return result;
     }
 
-    CefRefPtr<CefDictionaryValue> JSFunctionStorage::ConvertToCefDictionary()
+    CefRefPtr<CefDictionaryValue> JSFunctionStorage::ConvertToCefDictionary(FunctionFilter a_filter)
     {
-        std::lock_guard lock(m_funcCallbackMapMutex);
+        const SnapshotReadGuard snapshot(*this);
         const auto result = CefDictionaryValue::Create();
 
-        for (const auto& obj : m_funcCallbackMap)
+        for (const auto& obj : snapshot->funcIdMap)
         {
             auto list = CefListValue::Create();
-            list->SetSize(obj.second.size());
             auto funcIdx = 0;
-            for (const auto& func : obj.second)
+            for (const auto& func : *obj.second)
             {
-                list->SetString(funcIdx++, func.first);
+                const auto& callbackData = snapshot->funcSlots[func.second & SLOT_INDEX_MASK].callbackData;
+                if (a_filter == FunctionFilter::All ||
+                    (a_filter == FunctionFilter::Batched && callbackData.batchCalls) ||
+                    (a_filter == FunctionFilter::Async && callbackData.isAsync) ||
+                    (a_filter == FunctionFilter::Lazy && callbackData.lazyBinding))
+                {
+                    list->SetString(funcIdx++, func.first);
+                }
             }
 
-            result->SetList(obj.first, list);
+            if (funcIdx > 0 || a_filter == FunctionFilter::All)
+            {
+                result->SetList(obj.first, list);
+            }
+        }
+
+        return result;
+    }
+
+    CefRefPtr<CefDictionaryValue> JSFunctionStorage::ConvertToCefIdDictionary()
+    {
+        const SnapshotReadGuard snapshot(*this);
+        const auto result = CefDictionaryValue::Create();
+
+        for (const auto& obj : snapshot->funcIdMap)
+        {
+            auto idDict = CefDictionaryValue::Create();
+            for (const auto& func : *obj.second)
+            {
+                // Same bits on the other side
+                idDict->SetInt(func.first, static_cast<int>(func.second));
+            }
+            result->SetDictionary(obj.first, idDict);
         }
 
         return result;
@@ -1,32 +1,171 @@
 #pragma once
 
 #include "PCH.h"
+#include "Common/MPSCQueue.h"
+#include "Common/Stopwatch.h"
+#include "Common/StringHash.h"
 #include "Converters/CefValueToJSONConverter.h"
+#include "JS/JSCallBuffer.h"
+#include "JS/JSCallbackWorkerPool.h"
+#include "Services/MetricsService.h"
 
 namespace NL::JS
 {
+    /// <summary>
+    /// Registered functions live in a dense slot table, calls from the renderer carry only the function id.
+    /// Id = [generation:12][slot index:20], a freed slot gets a new generation, so calls to a removed function never reach its replacement.
+    /// A slot that has used its last generation is retired and never reused.
+    /// Readers use an immutable snapshot without locking: they count themselves on a per-thread stripe and load a raw pointer.
+    /// Writers copy the snapshot (maps of unchanged objects are shared) and swap the pointer, a replaced snapshot is freed
+    /// once no reader is counted. Callbacks run outside any lock
+    /// </summary>
     class JSFunctionStorage
     {
+      public:
+        using FuncId = std::uint32_t;
+        static constexpr FuncId INVALID_FUNC_ID = 0;
+
       protected:
-        std::recursive_mutex m_funcCallbackMapMutex;
-        std::unordered_map<std::string, std::unordered_map<std::string, NL::JS::JSFuncCallbackData>> m_funcCallbackMap;
+        static constexpr std::uint32_t SLOT_INDEX_BITS = 20;
+        static constexpr FuncId SLOT_INDEX_MASK = (1u << SLOT_INDEX_BITS) - 1;
+        static constexpr std::uint32_t MAX_GENERATION = (1u << (32 - SLOT_INDEX_BITS)) - 1;
+
+        struct FunctionSlot
+        {
+            // INVALID_FUNC_ID while the slot is free
+            FuncId id = INVALID_FUNC_ID;
+            std::uint32_t generation = 0;
+            // MetricTable::MakeKey("objectName.funcName")
+            std::uint64_t metricKey = 0;
+            NL::JS::JSFuncCallbackData callbackData;
+        };
+
+        using FuncIdMap = NL::Common::StringMap<FuncId>;
+
+        struct Snapshot
+        {
+            // Function maps are shared with the previous snapshot until a writer changes them
+            NL::Common::StringMap<std::shared_ptr<FuncIdMap>> funcIdMap;
+            std::vector<FunctionSlot> funcSlots;
+            std::vector<std::uint32_t> freeSlotIndices;
+
+            const FunctionSlot* FindSlot(FuncId a_funcId) const;
+        };
+
+        // Readers of one thread always use the same stripe, so threads don't share a counter cache line
+        struct alignas(64) ReaderStripe
+        {
+            std::atomic_uint32_t count = 0;
+        };
+
+        /// <summary>
+        /// Keeps the snapshot loaded by the constructor alive until the destructor
+        /// </summary>
+        class SnapshotReadGuard
+        {
+          protected:
+            ReaderStripe& m_stripe;
+            const Snapshot* m_snapshot = nullptr;
+
+          public:
+            explicit SnapshotReadGuard(const JSFunctionStorage& a_storage);
+            SnapshotReadGuard(const SnapshotReadGuard&) = delete;
+            SnapshotReadGuard& operator=(const SnapshotReadGuard&) = delete;
+            ~SnapshotReadGuard();
+
+            const Snapshot* operator->() const;
+        };
+
+        static constexpr std::uint32_t DEFAULT_GAME_THREAD_BUDGET_US = 2000;
+        static constexpr size_t READER_STRIPE_COUNT = 16;
+
+        // Serializes writers and reclaiming of retired snapshots
+        std::mutex m_writeMutex;
+        std::atomic<const Snapshot*> m_snapshot;
+        std::vector<std::unique_ptr<const Snapshot>> m_retiredSnapshots;
+        mutable std::array<ReaderStripe, READER_STRIPE_COUNT> m_readerStripes;
+
+        // Drained once per frame by the menu of the browser (see DrainGameThreadQueue)
+        NL::Common::MPSCQueue<std::shared_ptr<JSCallBuffer>> m_gameThreadQueue;
+        std::atomic<std::uint32_t> m_gameThreadBudgetUs = DEFAULT_GAME_THREAD_BUDGET_US;
+
+        static void InvokeCallback(const JSFuncCallbackData& a_callbackData, JSCallBuffer& a_callBuffer);
+        static FuncId AllocateSlot(Snapshot& a_snapshot, const NL::JS::JSFuncCallbackData& a_callbackData, std::uint64_t a_metricKey);
+        static void FreeSlot(Snapshot& a_snapshot, FuncId a_funcId);
+        static size_t GetReaderStripeIndex();
+
+        /// <summary>
+        /// Returns the function map of the object that this write may change, a_copiedMaps holds the maps already copied by this write
+        /// </summary>
+        static FuncIdMap& GetWritableFuncIdMap(Snapshot& a_snapshot, std::string_view a_objectName, std::vector<const FuncIdMap*>& a_copiedMaps);
+        // Returns 1 if the function is new, 0 if it is replaced or -1 on error
+        static int AddToSnapshot(Snapshot& a_snapshot, const NL::JS::JSFuncInfo& a_funcInfo, std::vector<const FuncIdMap*>& a_copiedMaps);
+
+        // Call with m_writeMutex locked
+        std::unique_ptr<Snapshot> CopySnapshot() const;
+        void PublishSnapshot(std::unique_ptr<Snapshot> a_snapshot);
+        void ReclaimRetiredSnapshots();
 
       public:
+        enum class FunctionFilter : std::uint8_t
+        {
+            All = 0,
+            Batched,
+            Async,
+            Lazy,
+        };
+
         sigslot::signal<> OnQueueItemAdded;
+        /// <summary>
+        /// Async call token of a call dropped because the callback queue is full, the owner rejects its promise
+        /// </summary>
+        sigslot::signal<std::uint64_t> OnAsyncCallDropped;
+
+        JSFunctionStorage();
+        virtual ~JSFunctionStorage();
+
+        /// <summary>
+        /// Clears the flags a client built against an older API did not set (see JSFuncCallbackData::version)
+        /// </summary>
+        static JSFuncCallbackData GetSupportedCallbackData(const JSFuncCallbackData& a_callbackData);
+        /// <summary>
+        /// Object and function names can't contain '.', the renderer keys functions by "objectName.funcName"
+        /// </summary>
+        static bool IsValidFunctionName(const char* a_objectName, const char* a_funcName);
 
-        std::recursive_mutex& GetCallbackMutex();
-        // Returns true if the function is new, otherwise false (replaced)
+        // Returns true if the function is new, otherwise false (replaced, the id is kept, or the name is not valid)
         virtual bool AddFunctionCallback(const NL::JS::JSFuncInfo& a_funcInfo);
+        /// <summary>
+        /// Adds all functions with one snapshot copy, event functions are skipped. Returns the count of new functions
+        /// </summary>
+        virtual std::uint32_t AddFunctionCallbacks(NL::JS::JSFuncInfo* const* a_funcInfoArr, std::uint32_t a_funcInfoArrSize);
         // Returns true if the function found and removed, otherwise false
-        virtual bool RemoveFunctionCallback(const std::string& a_objectName, const std::string& a_funcName);
+        virtual bool RemoveFunctionCallback(std::string_view a_objectName, std::string_view a_funcName);
         virtual void ClearFunctionCallback();
-        virtual JSFuncCallbackData GetFunctionCallbackData(const std::string& a_objectName, const std::string& a_funcName);
-        virtual void ExecuteFunctionCallback(const std::string& a_objectName,
-                                             const std::string& a_funcName,
-                                             std::shared_ptr<std::vector<std::string>> a_funcArgs,
+        virtual FuncId GetFunctionId(std::string_view a_objectName, std::string_view a_funcName);
+        virtual JSFuncCallbackData GetFunctionCallbackData(FuncId a_funcId);
+        // The call buffer is returned to JSCallBufferPool after the callback. Queue wait and callback time are recorded in MetricsService.
+        // a_storage keeps the storage alive until worker pool calls run, game thread calls wait for DrainGameThreadQueue
+        virtual void ExecuteFunctionCallback(std::shared_ptr<JSCallBuffer> a_callBuffer,
                                              std::shared_ptr<JSFunctionStorage> a_storage = nullptr);
+        /// <summary>
+        /// Runs queued executeInGameThread calls within the game thread budget and frees replaced snapshots, call it on the game thread once per frame
+        /// </summary>
+        void DrainGameThreadQueue();
         size_t GetSize();
+        /// <summary>
+        /// (objectName, funcName) of every registered function
+        /// </summary>
+        std::vector<std::pair<std::string, std::string>> GetFunctionNames();
+        /// <summary>
+        /// Time for game thread callbacks per frame, the rest is carried over to the next frame. At least one call runs per frame
+        /// </summary>
+        void SetGameThreadBudget(std::uint32_t a_microseconds);
 
-        virtual CefRefPtr<CefDictionaryValue> ConvertToCefDictionary();
+        virtual CefRefPtr<CefDictionaryValue> ConvertToCefDictionary(FunctionFilter a_filter = FunctionFilter::All);
+        /// <summary>
+        /// { objectName: { funcName: id } }
+        /// </summary>
+        virtual CefRefPtr<CefDictionaryValue> ConvertToCefIdDictionary();
     };
 }
@@ -34,8 +34,13 @@ namespace NL::Menus
             eventFuncInfo->SetString(0, m_eventFuncInfo.objectName);
             eventFuncInfo->SetString(1, m_eventFuncInfo.funcName);
 
+            // Functions registered so far are bound by the renderer without waiting for a message
+            auto funcRegistry = CefListValue::Create();
+            m_browser->WriteFunctionRegistry(funcRegistry);
+
             auto jsFuncInfo = CefDictionaryValue::Create();
             jsFuncInfo->SetList(IPC_JS_EVENT_FUNCTION_ADD_NAME, eventFuncInfo);
+            jsFuncInfo->SetList(IPC_JS_FUNCTION_REGISTRY_NAME, funcRegistry);
 
             const auto createBrowserResult =
                 NL::Services::CEFService::CreateBrowser(m_browser->GetCefClient(),
@@ -68,6 +73,8 @@ namespace NL::Menus
 
     void CEFMenu::Draw()
     {
+        m_browser->FlushEventBatch();
+        NL::Services::MetricsService::GetSingleton().LogReportIfDue();
         m_cefRenderLayer->Draw();
     }
 
@@ -114,4 +121,10 @@ namespace NL::Menus
     {
         return SubMenuType::CEFMenu;
     }
+
+    void CEFMenu::Update()
+    {
+        // Callbacks with executeInGameThread
+        m_jsFuncStorage->DrainGameThreadQueue();
+    }
 }
@@ -8,6 +8,7 @@
 #include "JS/JSFunctionStorage.h"
 #include "JS/JSEventFuncInfo.h"
 #include "Services/CEFService.h"
+#include "Services/MetricsService.h"
 
 namespace NL::Menus
 {
@@ -48,5 +49,6 @@ namespace NL::Menus
 
         // NL::Menus::ISubMenu
         SubMenuType GetMenuType() override;
+        void Update() override;
     };
 }
@@ -18,5 +18,9 @@ namespace NL::Menus
       public:
         virtual ~ISubMenu() override = default;
         virtual SubMenuType GetMenuType() = 0;
+        /// <summary>
+        /// Called on the game thread once per frame before drawing, also while the menu is hidden
+        /// </summary>
+        virtual void Update() = 0;
     };
 }
@@ -105,6 +105,21 @@ namespace NL::Menus
 
     void MultiLayerMenu::PostDisplay()
     {
+        // Outside the lock: updates run game thread callbacks, they can add or remove menus.
+        // The references keep removed menus alive until their update returns
+        {
+            std::lock_guard<std::mutex> lock(m_mapMenuMutex);
+            for (const auto& subMenu : m_menuMap)
+            {
+                m_updateMenus.push_back(subMenu.second);
+            }
+        }
+        for (const auto& subMenu : m_updateMenus)
+        {
+            subMenu->Update();
+        }
+        m_updateMenus.clear();
+
         std::lock_guard<std::mutex> lock(m_mapMenuMutex);
         if (m_menuMap.empty())
         {
@@ -206,12 +221,20 @@ namespace NL::Menus
 
         auto inputEvent = *a_event;
         auto result = RE::BSEventNotifyControl::kContinue;
+        auto& inputRecordService = NL::Services::InputRecordService::GetSingleton();
+        if (inputRecordService.IsReplayPending()) [[unlikely]]
+        {
+            inputRecordService.ReplayPending(this);
+        }
+        inputRecordService.RecordEvents(inputEvent);
         if (!CanProcess(inputEvent)) [[unlikely]]
         {
             return RE::BSEventNotifyControl::kContinue;
         }
 
         std::lock_guard<std::mutex> lock(m_mapMenuMutex);
+        // Toggle hotkeys go first, a key that focuses a browser is delivered to it
+        NL::Services::HotkeyService::GetSingleton().ProcessInputEvents(inputEvent);
         while (inputEvent != nullptr)
         {
             for (const auto& subMenu : m_menuMap)
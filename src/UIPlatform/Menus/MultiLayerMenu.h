@@ -4,6 +4,8 @@
 #include "Menus/ISubMenu.h"
 #include "Render/RenderData.h"
 #include "Services/InputLangSwitchService.h"
+#include "Services/HotkeyService.h"
+#include "Services/InputRecordService.h"
 
 namespace NL::Menus
 {
@@ -18,6 +20,8 @@ namespace NL::Menus
         NL::Render::RenderData m_renderData;
         std::mutex m_mapMenuMutex;
         std::unordered_map<std::string, std::shared_ptr<ISubMenu>> m_menuMap;
+        // Sub menus updated this frame, reused to avoid allocations. Game thread only
+        std::vector<std::shared_ptr<ISubMenu>> m_updateMenus;
 
         bool m_isKeepOpen = true;
 
@@ -13,6 +13,7 @@ namespace NL::UI
         using BrowserRefHandle = std::uint32_t;
         static constexpr BrowserRefHandle InvalidBrowserRefHandle = 0;
         using OnShutdownFunc_t = void (*)();
+        using OnMetricsFunc_t = void (*)(const char* a_json);
 
     public:
         virtual ~IUIPlatformAPI() = default;
@@ -62,6 +63,16 @@ namespace NL::UI
         /// </summary>
         /// <param name="a_callback"></param>
         virtual void RegisterOnShutdown(OnShutdownFunc_t a_callback) = 0;
+
+        /// <summary>
+        /// Calls back with per-function and per-IPC-message counters as JSON:
+        /// {"plugin":{"functions":[...],"messages":[...]},"renderers":[{"browserId":1,"functions":[...],"messages":[...]}]}.
+        /// An entry has name, count, bytes and timings with count, avgUs, p50Us, p90Us, p99Us, maxUs.
+        /// Renderer counters are sent every 10 seconds, so they can be behind.
+        /// The string is valid only during the callback
+        /// </summary>
+        /// <param name="a_callback"></param>
+        virtual void __cdecl GetMetrics(OnMetricsFunc_t a_callback) = 0;
     };
 
     enum APIMessageType : std::uint32_t
@@ -53,9 +53,107 @@ namespace NL::CEF
         virtual void __cdecl LoadBrowserURL(const char* a_url, bool a_clearJSFunctions = true) = 0;
 
         virtual void __cdecl ExecuteJavaScript(const char* a_script, const char* a_scriptUrl = JS_EXECUTE_SCRIPT_URL) = 0;
+        /// <summary>
+        /// Adds or replaces a function. Object and function names can't contain '.', such functions are not added and an error is logged
+        /// </summary>
+        /// <param name="a_callbackInfo"></param>
+        /// <returns></returns>
         virtual void __cdecl AddFunctionCallback(const NL::JS::JSFuncInfo& a_callbackInfo) = 0;
         virtual void __cdecl RemoveFunctionCallback(const char* a_objectName, const char* a_funcName) = 0;
         virtual void __cdecl RemoveFunctionCallback(const NL::JS::JSFuncInfo& a_callbackInfo) = 0;
         virtual void __cdecl ExecEventFunction(const char* a_eventName, const char* a_data) = 0;
+        /// <summary>
+        /// Opt-in batching of ExecEventFunction calls. Events are buffered and sent once per frame as a single message,
+        /// the order is preserved. a_maxDelayMs limits how long an event can wait if no frame is drawn.
+        /// Disabling sends the pending events
+        /// </summary>
+        /// <param name="a_enable"></param>
+        /// <param name="a_maxDelayMs"></param>
+        /// <returns></returns>
+        virtual void __cdecl SetEventBatching(bool a_enable, std::uint32_t a_maxDelayMs = 50) = 0;
+        /// <summary>
+        /// Resolves the Promise of an async function call (see JSFuncAsyncCallback) with a JSON value
+        /// </summary>
+        /// <param name="a_token">Token passed to the callback, tokens of a page that is already unloaded are ignored</param>
+        /// <param name="a_json">JSON text, the promise is rejected if it can't be parsed</param>
+        /// <returns></returns>
+        virtual void __cdecl ResolveAsyncCall(std::uint64_t a_token, const char* a_json) = 0;
+        /// <summary>
+        /// Resolves the Promise of an async function call with an ArrayBuffer, the data is copied
+        /// </summary>
+        /// <param name="a_token"></param>
+        /// <param name="a_data"></param>
+        /// <param name="a_size"></param>
+        /// <returns></returns>
+        virtual void __cdecl ResolveAsyncCallBinary(std::uint64_t a_token, const void* a_data, std::uint32_t a_size) = 0;
+        /// <summary>
+        /// Rejects the Promise of an async function call with an Error
+        /// </summary>
+        /// <param name="a_token"></param>
+        /// <param name="a_message"></param>
+        /// <returns></returns>
+        virtual void __cdecl RejectAsyncCall(std::uint64_t a_token, const char* a_message) = 0;
+        /// <summary>
+        /// Registers the field layout of an event once, then send it with ExecEventFunctionValues.
+        /// JS listeners receive an object with these fields instead of a JSON string. Registering again replaces the schema
+        /// </summary>
+        /// <param name="a_eventName"></param>
+        /// <param name="a_fields"></param>
+        /// <param name="a_fieldCount"></param>
+        /// <returns></returns>
+        virtual void __cdecl RegisterEventSchema(const char* a_eventName, const NL::JS::JSEventField* a_fields, std::uint32_t a_fieldCount) = 0;
+        /// <summary>
+        /// Sends an event with a registered schema, values are in field order and converted to the field types.
+        /// The JS object is reused by the next event, listeners must copy what they keep
+        /// </summary>
+        /// <param name="a_eventName"></param>
+        /// <param name="a_values"></param>
+        /// <param name="a_valueCount"></param>
+        /// <returns></returns>
+        virtual void __cdecl ExecEventFunctionValues(const char* a_eventName, const double* a_values, std::uint32_t a_valueCount) = 0;
+        /// <summary>
+        /// Registers a script once, the source must be a function expression like "(hp, name) => { ... }".
+        /// The renderer compiles it once per page and then only the id and arguments are sent. Registering the same name again replaces the source and keeps the id
+        /// </summary>
+        /// <param name="a_name">Also used as the script url in JS errors</param>
+        /// <param name="a_source"></param>
+        /// <returns>Script id or 0 on error</returns>
+        virtual std::uint32_t __cdecl RegisterScript(const char* a_name, const char* a_source) = 0;
+        /// <summary>
+        /// Calls a registered script. Calls before the page is loaded are skipped
+        /// </summary>
+        /// <param name="a_scriptId"></param>
+        /// <param name="a_args"></param>
+        /// <param name="a_argCount"></param>
+        /// <returns></returns>
+        virtual void __cdecl ExecuteScript(std::uint32_t a_scriptId, const NL::JS::JSScriptArg* a_args, std::uint32_t a_argCount) = 0;
+        /// <summary>
+        /// Sends an event with binary data, JS listeners receive an ArrayBuffer instead of a string.
+        /// Data of IPC_SHARED_PAYLOAD_THRESHOLD bytes and more is written straight into shared memory
+        /// </summary>
+        /// <param name="a_eventName"></param>
+        /// <param name="a_data">Copied before the call returns</param>
+        /// <param name="a_size"></param>
+        /// <returns></returns>
+        virtual void __cdecl ExecEventFunctionBinary(const char* a_eventName, const void* a_data, std::uint32_t a_size) = 0;
+        /// <summary>
+        /// Registers a state object that JS reads as window[a_objectName].fieldName, each read returns the latest value from shared memory.
+        /// Set values with SetStateValues, no IPC message is sent per update. Registering the same object name again replaces the fields and keeps the id
+        /// </summary>
+        /// <param name="a_objectName"></param>
+        /// <param name="a_fields"></param>
+        /// <param name="a_fieldCount"></param>
+        /// <returns>State id or 0 on error</returns>
+        virtual std::uint32_t __cdecl RegisterStateObject(const char* a_objectName, const NL::JS::JSEventField* a_fields, std::uint32_t a_fieldCount) = 0;
+        /// <summary>
+        /// Sets values of a state object in field order starting at a_firstField, values are converted to the field types.
+        /// JS never sees a partially written update
+        /// </summary>
+        /// <param name="a_stateId"></param>
+        /// <param name="a_values"></param>
+        /// <param name="a_valueCount"></param>
+        /// <param name="a_firstField"></param>
+        /// <returns></returns>
+        virtual void __cdecl SetStateValues(std::uint32_t a_stateId, const double* a_values, std::uint32_t a_valueCount, std::uint32_t a_firstField = 0) = 0;
     };
 }
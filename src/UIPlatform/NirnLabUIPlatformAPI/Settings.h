@@ -2,6 +2,19 @@
 
 namespace NL::UI
 {
+    enum class InputRecordMode : int
+    {
+        Off = 0,
+        /// <summary>
+        /// Writes the input events seen by the browsers to "<log directory>/NirnLabUIPlatform.inputrec"
+        /// </summary>
+        Record = 1,
+        /// <summary>
+        /// Replays that file into the browsers on the first input event and logs the cost per event
+        /// </summary>
+        Replay = 2,
+    };
+
     /// <summary>
     /// Global (API) settings
     /// </summary>
@@ -11,7 +24,10 @@ namespace NL::UI
         /// Cef debugging port (http://localhost:9009)
         /// </summary>
         int remoteDebuggingPort = 9009;
-        int reservPad = 0;
+        /// <summary>
+        /// Input record/replay for measuring the input path, off by default
+        /// </summary>
+        InputRecordMode inputRecordMode = InputRecordMode::Off;
     };
 
     /// <summary>
@@ -18,10 +18,12 @@
 // std
 #include <wrl.h>
 #include <cmath>
+#include <charconv>
 #include <sstream>
 #include <shlobj.h>
 #include <cassert>
 #include <filesystem>
+#include <fstream>
 #include <span>
 #include <unordered_set>
 
@@ -54,6 +56,7 @@ namespace stl
 #include <include/cef_browser.h>
 #include <include/cef_client.h>
 #include <include/cef_version.h>
+#include <include/cef_task.h>
 
 // nlohmann-json (https://github.com/nlohmann/json)
 #include "nlohmann/json.hpp"
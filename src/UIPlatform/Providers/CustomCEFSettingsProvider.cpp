@@ -32,4 +32,9 @@ namespace NL::Providers
     {
         return m_defaultSettings->GetCefWindowInfo();
     }
+
+    NL::UI::InputRecordMode CustomCEFSettingsProvider::GetInputRecordMode()
+    {
+        return m_settings.inputRecordMode;
+    }
 }
@@ -20,5 +20,6 @@ namespace NL::Providers
         CefBrowserSettings GetCefBrowserSettings() override;
         CefBrowserSettings MergeAndGetCefBrowserSettings(NL::UI::BrowserSettings* a_settings) override;
         CefWindowInfo GetCefWindowInfo() override;
+        NL::UI::InputRecordMode GetInputRecordMode() override;
     };
 }
@@ -68,4 +68,9 @@ namespace NL::Providers
 
         return info;
     }
+
+    NL::UI::InputRecordMode DefaultCEFSettingsProvider::GetInputRecordMode()
+    {
+        return NL::UI::InputRecordMode::Off;
+    }
 }
@@ -14,5 +14,6 @@ namespace NL::Providers
         CefBrowserSettings GetCefBrowserSettings() override;
         CefBrowserSettings MergeAndGetCefBrowserSettings(NL::UI::BrowserSettings* a_settings) override;
         CefWindowInfo GetCefWindowInfo() override;
+        NL::UI::InputRecordMode GetInputRecordMode() override;
     };
 }
@@ -13,5 +13,6 @@ namespace NL::Providers
         virtual CefBrowserSettings GetCefBrowserSettings() = 0;
         virtual CefBrowserSettings MergeAndGetCefBrowserSettings(NL::UI::BrowserSettings* a_settings) = 0;
         virtual CefWindowInfo GetCefWindowInfo() = 0;
+        virtual NL::UI::InputRecordMode GetInputRecordMode() = 0;
     };
 }
@@ -14,6 +14,11 @@ namespace NL::Render
         a_render->Release();
     }
 
+    InputLatencyTracker* CEFCopyRenderLayer::GetInputLatencyTracker()
+    {
+        return &m_inputLatencyTracker;
+    }
+
     void CEFCopyRenderLayer::Init(RenderData* a_renderData)
     {
         IRenderLayer::Init(a_renderData);
@@ -85,6 +90,8 @@ namespace NL::Render
                 nullptr,
                 ::DirectX::Colors::White,
                 0.f);
+
+            m_inputLatencyTracker.OnPresent();
         }
     }
 
@@ -135,5 +142,12 @@ namespace NL::Render
         m_renderData->drawLock.Unlock();
 
         tex->Release();
+
+        m_inputLatencyTracker.OnPaint(!dirtyRects.empty());
+        const auto latencyReport = m_inputLatencyTracker.TakeReportIfDue();
+        if (!latencyReport.empty())
+        {
+            spdlog::info("{}: browser id {} {}", NameOf(CEFCopyRenderLayer), browser->GetIdentifier(), latencyReport);
+        }
     }
 }
@@ -3,6 +3,7 @@
 #include "PCH.h"
 #include "IRenderLayer.h"
 #include "Common/SpinLock.h"
+#include "Render/InputLatencyTracker.h"
 
 namespace NL::Render
 {
@@ -21,10 +22,13 @@ namespace NL::Render
         Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_cefSRV;
         Microsoft::WRL::ComPtr<ID3D11Device1> m_device1 = nullptr;
         Microsoft::WRL::ComPtr<ID3D11DeviceContext> m_deferredContext;
+        InputLatencyTracker m_inputLatencyTracker;
 
     public:
         ~CEFCopyRenderLayer() override = default;
 
+        InputLatencyTracker* GetInputLatencyTracker();
+
         // IRenderLayer
         void Init(RenderData* a_renderData) override;
         void Draw() override;
@@ -0,0 +1,95 @@
+#include "InputLatencyTracker.h"
+
+namespace NL::Render
+{
+    void InputLatencyTracker::OnInputForwarded(Clock::time_point a_now)
+    {
+        m_lock.Lock();
+        if (m_pendingInputCount < MAX_PENDING_INPUTS)
+        {
+            m_pendingInputs[m_pendingInputCount++] = a_now;
+        }
+        else
+        {
+            ++m_droppedInputs;
+        }
+        m_lock.Unlock();
+    }
+
+    void InputLatencyTracker::OnPaint(bool a_hasDirtyRects, Clock::time_point a_now)
+    {
+        if (!a_hasDirtyRects)
+        {
+            return;
+        }
+
+        m_lock.Lock();
+        // Pending inputs are in forward order. The first one stamped after this paint and all later ones wait for the next paint
+        std::size_t paintedCount = 0;
+        while (paintedCount < m_pendingInputCount && m_pendingInputs[paintedCount] <= a_now)
+        {
+            const auto inputTime = m_pendingInputs[paintedCount++];
+            m_inputToPaint.Add(a_now - inputTime);
+            if (m_paintedInputCount < MAX_PENDING_INPUTS)
+            {
+                m_paintedInputs[m_paintedInputCount++] = {inputTime, a_now};
+            }
+            else
+            {
+                ++m_droppedInputs;
+            }
+        }
+        std::copy(m_pendingInputs.begin() + paintedCount, m_pendingInputs.begin() + m_pendingInputCount, m_pendingInputs.begin());
+        m_pendingInputCount -= paintedCount;
+        m_lock.Unlock();
+    }
+
+    void InputLatencyTracker::OnPresent(Clock::time_point a_now)
+    {
+        m_lock.Lock();
+        // Painted inputs are in paint order, the ones painted after this draw started are shown by the next one
+        std::size_t presentedCount = 0;
+        while (presentedCount < m_paintedInputCount && m_paintedInputs[presentedCount].paintTime <= a_now)
+        {
+            m_inputToPresent.Add(a_now - m_paintedInputs[presentedCount++].inputTime);
+        }
+        std::copy(m_paintedInputs.begin() + presentedCount, m_paintedInputs.begin() + m_paintedInputCount, m_paintedInputs.begin());
+        m_paintedInputCount -= presentedCount;
+        m_lock.Unlock();
+    }
+
+    const Common::LatencyHistogram& InputLatencyTracker::GetInputToPaintHistogram() const
+    {
+        return m_inputToPaint;
+    }
+
+    const Common::LatencyHistogram& InputLatencyTracker::GetInputToPresentHistogram() const
+    {
+        return m_inputToPresent;
+    }
+
+    std::string InputLatencyTracker::TakeReportIfDue(Clock::time_point a_now)
+    {
+        m_lock.Lock();
+        if (a_now - m_lastReportTime < REPORT_INTERVAL || m_inputToPaint.GetCount() == 0)
+        {
+            m_lock.Unlock();
+            return {};
+        }
+
+        // Formatting allocates, keep it out of the lock the input and render threads spin on
+        const auto inputToPaint = m_inputToPaint.GetSnapshot();
+        const auto inputToPresent = m_inputToPresent.GetSnapshot();
+        const auto droppedInputs = m_droppedInputs;
+        m_inputToPaint.Reset();
+        m_inputToPresent.Reset();
+        m_droppedInputs = 0;
+        m_lastReportTime = a_now;
+        m_lock.Unlock();
+
+        return fmt::format("input-to-paint: {}; input-to-present: {}; untracked inputs: {}",
+                           inputToPaint.ToString(),
+                           inputToPresent.ToString(),
+                           droppedInputs);
+    }
+}
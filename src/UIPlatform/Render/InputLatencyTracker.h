@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Common/SpinLock.h"
+#include "Common/LatencyHistogram.h"
+
+namespace NL::Render
+{
+    /// <summary>
+    /// Correlates each forwarded input event with the first paint with dirty rects after it and with the first draw after this paint.
+    /// Input is stamped on the game input thread, paints come from the CEF UI thread and draws from the render thread
+    /// </summary>
+    class InputLatencyTracker
+    {
+      public:
+        using Clock = std::chrono::steady_clock;
+
+        struct PaintedInput
+        {
+            Clock::time_point inputTime{};
+            Clock::time_point paintTime{};
+        };
+
+        // Inputs above this count between two paints are not tracked, they are reported as untracked
+        static constexpr std::size_t MAX_PENDING_INPUTS = 64;
+        static constexpr auto REPORT_INTERVAL = std::chrono::seconds(30);
+
+      protected:
+        Common::SpinLock m_lock;
+        std::uint64_t m_droppedInputs = 0;
+
+        // Forwarded to CEF, waiting for a paint
+        std::array<Clock::time_point, MAX_PENDING_INPUTS> m_pendingInputs{};
+        std::size_t m_pendingInputCount = 0;
+
+        // Painted, waiting for the frame to be drawn
+        std::array<PaintedInput, MAX_PENDING_INPUTS> m_paintedInputs{};
+        std::size_t m_paintedInputCount = 0;
+
+        Clock::time_point m_lastReportTime = Clock::now();
+
+        Common::LatencyHistogram m_inputToPaint;
+        Common::LatencyHistogram m_inputToPresent;
+
+      public:
+        void OnInputForwarded(Clock::time_point a_now = Clock::now());
+        void OnPaint(bool a_hasDirtyRects, Clock::time_point a_now = Clock::now());
+        void OnPresent(Clock::time_point a_now = Clock::now());
+
+        const Common::LatencyHistogram& GetInputToPaintHistogram() const;
+        const Common::LatencyHistogram& GetInputToPresentHistogram() const;
+
+        /// <summary>
+        /// Returns the histogram summary and resets it once per REPORT_INTERVAL, otherwise an empty string
+        /// </summary>
+        std::string TakeReportIfDue(Clock::time_point a_now = Clock::now());
+    };
+}
@@ -0,0 +1,199 @@
+#include "HotkeyService.h"
+
+namespace NL::Services
+{
+    bool HotkeyService::IsKeySet(const KeyMask& a_mask, std::uint32_t a_keyCode)
+    {
+        return a_keyCode < KEY_COUNT && (a_mask[a_keyCode / 64] & (std::uint64_t(1) << (a_keyCode % 64))) != 0;
+    }
+
+    void HotkeyService::SetKey(KeyMask& a_mask, std::uint32_t a_keyCode)
+    {
+        if (a_keyCode < KEY_COUNT)
+        {
+            a_mask[a_keyCode / 64] |= std::uint64_t(1) << (a_keyCode % 64);
+        }
+    }
+
+    bool HotkeyService::IsSubsetOf(const KeyMask& a_mask, const KeyMask& a_state)
+    {
+        std::uint64_t missing = 0;
+        for (std::size_t i = 0; i < a_mask.size(); ++i)
+        {
+            missing |= a_mask[i] & ~a_state[i];
+        }
+        return missing == 0;
+    }
+
+    HotkeyService::KeyMask HotkeyService::MakeKeyboardSnapshot(const std::uint8_t* a_keyboardState)
+    {
+        KeyMask result{};
+        if (a_keyboardState == nullptr)
+        {
+            return result;
+        }
+
+        for (std::uint32_t keyCode = 0; keyCode < KEY_COUNT; ++keyCode)
+        {
+            if ((a_keyboardState[keyCode] & 0x80) != 0)
+            {
+                SetKey(result, keyCode);
+            }
+        }
+        return result;
+    }
+
+    void HotkeyService::RebuildKeyIndex()
+    {
+        for (auto& chordIndices : m_chordsByKey)
+        {
+            chordIndices.clear();
+        }
+
+        for (std::uint32_t chordIdx = 0; chordIdx < m_chords.size(); ++chordIdx)
+        {
+            const auto& mask = m_chords[chordIdx].mask;
+            for (std::uint32_t keyCode = 0; keyCode < KEY_COUNT; ++keyCode)
+            {
+                if (IsKeySet(mask, keyCode))
+                {
+                    m_chordsByKey[keyCode].push_back(chordIdx);
+                }
+            }
+        }
+
+        m_hasChords = !m_chords.empty();
+    }
+
+    HotkeyService::ChordHandle HotkeyService::BindChord(const void* a_owner, std::uint32_t a_action, std::span<const std::uint32_t> a_keyCodes, ChordCallback a_callback)
+    {
+        if (a_callback == nullptr)
+        {
+            return InvalidChordHandle;
+        }
+
+        Chord chord{};
+        for (const auto keyCode : a_keyCodes)
+        {
+            if (keyCode != 0)
+            {
+                SetKey(chord.mask, keyCode);
+            }
+        }
+
+        if (chord.mask == KeyMask{})
+        {
+            return InvalidChordHandle;
+        }
+
+        std::lock_guard lock(m_chordMutex);
+        chord.handle = m_nextHandle++;
+        chord.owner = a_owner;
+        chord.action = a_action;
+        chord.callback = std::move(a_callback);
+        m_chords.push_back(std::move(chord));
+        RebuildKeyIndex();
+
+        return m_chords.back().handle;
+    }
+
+    bool HotkeyService::UnbindChord(ChordHandle a_handle)
+    {
+        std::lock_guard lock(m_chordMutex);
+        const auto erasedCount = std::erase_if(m_chords, [&](const Chord& a_chord) {
+            return a_chord.handle == a_handle;
+        });
+
+        if (erasedCount > 0)
+        {
+            RebuildKeyIndex();
+        }
+        return erasedCount > 0;
+    }
+
+    void HotkeyService::UnbindChords(const void* a_owner, std::uint32_t a_action)
+    {
+        std::lock_guard lock(m_chordMutex);
+        const auto erasedCount = std::erase_if(m_chords, [&](const Chord& a_chord) {
+            return a_chord.owner == a_owner && a_chord.action == a_action;
+        });
+
+        if (erasedCount > 0)
+        {
+            RebuildKeyIndex();
+        }
+    }
+
+    void HotkeyService::UnbindAllChords(const void* a_owner)
+    {
+        std::lock_guard lock(m_chordMutex);
+        const auto erasedCount = std::erase_if(m_chords, [&](const Chord& a_chord) {
+            return a_chord.owner == a_owner;
+        });
+
+        if (erasedCount > 0)
+        {
+            RebuildKeyIndex();
+        }
+    }
+
+    std::size_t HotkeyService::MatchKeyDown(const KeyMask& a_state, std::uint32_t a_keyCode, std::vector<ChordCallback>& a_outCallbacks)
+    {
+        if (a_keyCode >= KEY_COUNT)
+        {
+            return 0;
+        }
+
+        // The pressed key may not be in the device state yet
+        auto state = a_state;
+        SetKey(state, a_keyCode);
+
+        std::size_t matchedCount = 0;
+        std::lock_guard lock(m_chordMutex);
+        for (const auto chordIdx : m_chordsByKey[a_keyCode])
+        {
+            const auto& chord = m_chords[chordIdx];
+            if (IsSubsetOf(chord.mask, state))
+            {
+                a_outCallbacks.push_back(chord.callback);
+                ++matchedCount;
+            }
+        }
+
+        return matchedCount;
+    }
+
+    void HotkeyService::ProcessInputEvents(RE::InputEvent* a_event)
+    {
+        if (!m_hasChords)
+        {
+            return;
+        }
+
+        const auto keyboard = RE::BSInputDeviceManager::GetSingleton()->GetKeyboard();
+        const auto state = MakeKeyboardSnapshot(keyboard == nullptr ? nullptr : keyboard->curState);
+
+        // Called from the input thread only
+        m_matchedCallbacks.clear();
+        for (auto inputEvent = a_event; inputEvent != nullptr; inputEvent = inputEvent->next)
+        {
+            if (inputEvent->GetEventType() != RE::INPUT_EVENT_TYPE::kButton || inputEvent->GetDevice() != RE::INPUT_DEVICE::kKeyboard)
+            {
+                continue;
+            }
+
+            const auto buttonEvent = inputEvent->AsButtonEvent();
+            if (buttonEvent->IsDown())
+            {
+                MatchKeyDown(state, buttonEvent->GetIDCode(), m_matchedCallbacks);
+            }
+        }
+
+        // Callbacks may bind or unbind chords
+        for (const auto& callback : m_matchedCallbacks)
+        {
+            callback();
+        }
+        m_matchedCallbacks.clear();
+    }
+}
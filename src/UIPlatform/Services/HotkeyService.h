@@ -0,0 +1,68 @@
+#pragma once
+
+#include "PCH.h"
+#include "Common/Singleton.h"
+
+namespace NL::Services
+{
+    /// <summary>
+    /// Matches key chords against one keyboard state snapshot per input event batch.
+    /// Chords are compiled into 256-bit masks indexed by each of their keys, so a key press only tests the chords containing that key
+    /// </summary>
+    class HotkeyService : public NL::Common::Singleton<HotkeyService>
+    {
+      public:
+        static constexpr std::size_t KEY_COUNT = 256;
+        using KeyMask = std::array<std::uint64_t, KEY_COUNT / 64>;
+        using ChordHandle = std::uint32_t;
+        static constexpr ChordHandle InvalidChordHandle = 0;
+        using ChordCallback = std::function<void()>;
+
+      private:
+        friend class NL::Common::Singleton<HotkeyService>;
+
+        struct Chord
+        {
+            ChordHandle handle = InvalidChordHandle;
+            const void* owner = nullptr;
+            std::uint32_t action = 0;
+            KeyMask mask{};
+            ChordCallback callback = nullptr;
+        };
+
+        std::mutex m_chordMutex;
+        ChordHandle m_nextHandle = 1;
+        std::vector<Chord> m_chords;
+        // Indices into m_chords for every key of the chord, rebuilt on bind/unbind
+        std::array<std::vector<std::uint32_t>, KEY_COUNT> m_chordsByKey;
+        std::atomic_bool m_hasChords = false;
+
+        std::vector<ChordCallback> m_matchedCallbacks;
+
+        void RebuildKeyIndex();
+
+      public:
+        static bool IsKeySet(const KeyMask& a_mask, std::uint32_t a_keyCode);
+        static void SetKey(KeyMask& a_mask, std::uint32_t a_keyCode);
+        static bool IsSubsetOf(const KeyMask& a_mask, const KeyMask& a_state);
+        static KeyMask MakeKeyboardSnapshot(const std::uint8_t* a_keyboardState);
+
+        /// <summary>
+        /// Binds a chord of keyboard scan codes (see RE::BSKeyboardDevice::Keys), zero and out of range codes are ignored
+        /// </summary>
+        /// <returns>InvalidChordHandle if there are no valid keys</returns>
+        ChordHandle BindChord(const void* a_owner, std::uint32_t a_action, std::span<const std::uint32_t> a_keyCodes, ChordCallback a_callback);
+        bool UnbindChord(ChordHandle a_handle);
+        void UnbindChords(const void* a_owner, std::uint32_t a_action);
+        void UnbindAllChords(const void* a_owner);
+
+        /// <summary>
+        /// Runs callbacks of the chords completed by key presses in the batch. Call once per input event batch
+        /// </summary>
+        void ProcessInputEvents(RE::InputEvent* a_event);
+        /// <summary>
+        /// Returns how many chords are completed by pressing a_keyCode in the a_state snapshot, their callbacks are appended to a_outCallbacks
+        /// </summary>
+        std::size_t MatchKeyDown(const KeyMask& a_state, std::uint32_t a_keyCode, std::vector<ChordCallback>& a_outCallbacks);
+    };
+}
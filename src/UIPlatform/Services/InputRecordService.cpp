@@ -0,0 +1,262 @@
+#include "InputRecordService.h"
+
+namespace NL::Services
+{
+    namespace
+    {
+        // Events are allocated like the game does it (RE::ButtonEvent::Create), so they are freed the same way
+        template <class T>
+        struct InputEventDeleter
+        {
+            void operator()(T* a_event) const
+            {
+                std::destroy_at(a_event);
+                RE::free(a_event);
+            }
+        };
+
+        template <class T>
+        using InputEventPtr = std::unique_ptr<T, InputEventDeleter<T>>;
+
+        InputEventPtr<RE::MouseMoveEvent> CreateMouseMoveEvent()
+        {
+            auto event = RE::malloc<RE::MouseMoveEvent>(sizeof(RE::MouseMoveEvent));
+            if (event == nullptr)
+            {
+                return nullptr;
+            }
+
+            std::memset(reinterpret_cast<void*>(event), 0, sizeof(RE::MouseMoveEvent));
+            stl::emplace_vtable(event);
+            event->device = RE::INPUT_DEVICE::kMouse;
+            event->eventType = RE::INPUT_EVENT_TYPE::kMouseMove;
+            event->next = nullptr;
+            event->userEvent = "";
+            return InputEventPtr<RE::MouseMoveEvent>(event);
+        }
+    }
+
+    bool InputRecordService::StartRecording(const std::filesystem::path& a_path)
+    {
+        std::lock_guard<std::mutex> lock(m_recordMutex);
+        if (m_isRecording)
+        {
+            spdlog::warn("{}: already recording", NameOf(InputRecordService));
+            return false;
+        }
+
+        m_recordStream.open(a_path, std::ios::binary | std::ios::trunc);
+        if (!m_recordStream.is_open())
+        {
+            spdlog::error("{}: can't open \"{}\" for writing", NameOf(InputRecordService), a_path.string());
+            return false;
+        }
+
+        const FileHeader header{};
+        m_recordStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        m_recordStartTime = std::chrono::steady_clock::now();
+        m_recordedCount = 0;
+        m_isRecording = true;
+
+        spdlog::info("{}: recording input to \"{}\"", NameOf(InputRecordService), a_path.string());
+        return true;
+    }
+
+    void InputRecordService::StopRecording()
+    {
+        std::lock_guard<std::mutex> lock(m_recordMutex);
+        if (!m_isRecording)
+        {
+            return;
+        }
+
+        m_isRecording = false;
+        m_recordStream.close();
+        spdlog::info("{}: recorded {} input events", NameOf(InputRecordService), m_recordedCount);
+    }
+
+    bool InputRecordService::IsRecording()
+    {
+        return m_isRecording;
+    }
+
+    void InputRecordService::RecordEvents(RE::InputEvent* a_event)
+    {
+        if (!m_isRecording)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_recordMutex);
+        if (!m_isRecording)
+        {
+            return;
+        }
+
+        const auto timestamp = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_recordStartTime).count());
+        const auto menuCursor = RE::MenuCursor::GetSingleton();
+        for (auto inputEvent = a_event; inputEvent != nullptr; inputEvent = inputEvent->next)
+        {
+            Record record{};
+            record.timestamp = timestamp;
+            record.eventType = static_cast<std::uint8_t>(inputEvent->GetEventType());
+            record.device = static_cast<std::uint8_t>(inputEvent->GetDevice());
+            if (menuCursor != nullptr)
+            {
+                record.cursorPosX = menuCursor->cursorPosX;
+                record.cursorPosY = menuCursor->cursorPosY;
+            }
+
+            switch (inputEvent->GetEventType())
+            {
+            case RE::INPUT_EVENT_TYPE::kButton: {
+                const auto buttonEvent = inputEvent->AsButtonEvent();
+                record.idCode = buttonEvent->GetIDCode();
+                record.value = buttonEvent->Value();
+                record.heldDuration = buttonEvent->HeldDuration();
+                break;
+            }
+            case RE::INPUT_EVENT_TYPE::kMouseMove: {
+                const auto mouseMoveEvent = inputEvent->AsMouseMoveEvent();
+                record.mouseInputX = mouseMoveEvent->mouseInputX;
+                record.mouseInputY = mouseMoveEvent->mouseInputY;
+                break;
+            }
+            default:
+                // Only buttons and mouse moves reach the browsers
+                continue;
+            }
+
+            m_recordStream.write(reinterpret_cast<const char*>(&record), sizeof(record));
+            ++m_recordedCount;
+        }
+    }
+
+    bool InputRecordService::LoadRecords(const std::filesystem::path& a_path, std::vector<Record>& a_outRecords)
+    {
+        std::ifstream stream(a_path, std::ios::binary);
+        if (!stream.is_open())
+        {
+            spdlog::error("{}: can't open \"{}\"", NameOf(InputRecordService), a_path.string());
+            return false;
+        }
+
+        FileHeader header{};
+        stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!stream || header.magic != FILE_MAGIC || header.version != FILE_VERSION)
+        {
+            spdlog::error("{}: \"{}\" is not an input record file (version {})", NameOf(InputRecordService), a_path.string(), FILE_VERSION);
+            return false;
+        }
+
+        Record record{};
+        while (stream.read(reinterpret_cast<char*>(&record), sizeof(record)))
+        {
+            a_outRecords.push_back(record);
+        }
+
+        return true;
+    }
+
+    void InputRecordService::SetReplayPending(const std::filesystem::path& a_path)
+    {
+        std::lock_guard<std::mutex> lock(m_replayMutex);
+        m_replayPath = a_path;
+        m_isReplayPending = true;
+    }
+
+    bool InputRecordService::IsReplayPending()
+    {
+        return m_isReplayPending;
+    }
+
+    void InputRecordService::ReplayPending(RE::BSTEventSink<RE::InputEvent*>* a_sink)
+    {
+        std::filesystem::path path;
+        {
+            std::lock_guard<std::mutex> lock(m_replayMutex);
+            if (!m_isReplayPending)
+            {
+                return;
+            }
+
+            // Cleared before the replay, the sink gets the replayed events through the same path
+            m_isReplayPending = false;
+            path = std::move(m_replayPath);
+        }
+
+        std::vector<Record> records;
+        if (LoadRecords(path, records))
+        {
+            Replay(records, a_sink);
+        }
+    }
+
+    InputRecordService::ReplayStats InputRecordService::Replay(const std::vector<Record>& a_records, RE::BSTEventSink<RE::InputEvent*>* a_sink)
+    {
+        ReplayStats stats{};
+        if (a_sink == nullptr || a_records.empty())
+        {
+            return stats;
+        }
+
+        const auto buttonEvent = InputEventPtr<RE::ButtonEvent>(RE::ButtonEvent::Create(RE::INPUT_DEVICE::kKeyboard, "", 0, 0.0f, 0.0f));
+        const auto mouseMoveEvent = CreateMouseMoveEvent();
+        if (buttonEvent == nullptr || mouseMoveEvent == nullptr)
+        {
+            spdlog::error("{}: can't allocate replay events", NameOf(InputRecordService));
+            return stats;
+        }
+
+        const auto menuCursor = RE::MenuCursor::GetSingleton();
+        for (const auto& record : a_records)
+        {
+            RE::InputEvent* inputEvent = nullptr;
+            switch (static_cast<RE::INPUT_EVENT_TYPE>(record.eventType))
+            {
+            case RE::INPUT_EVENT_TYPE::kButton:
+                buttonEvent->device = static_cast<RE::INPUT_DEVICE>(record.device);
+                buttonEvent->idCode = record.idCode;
+                buttonEvent->value = record.value;
+                buttonEvent->heldDownSecs = record.heldDuration;
+                inputEvent = buttonEvent.get();
+                break;
+            case RE::INPUT_EVENT_TYPE::kMouseMove:
+                mouseMoveEvent->mouseInputX = record.mouseInputX;
+                mouseMoveEvent->mouseInputY = record.mouseInputY;
+                inputEvent = mouseMoveEvent.get();
+                break;
+            default:
+                continue;
+            }
+
+            // Same start position as in the recording, the cursor menu applies mouse moves to it
+            if (menuCursor != nullptr)
+            {
+                menuCursor->cursorPosX = record.cursorPosX;
+                menuCursor->cursorPosY = record.cursorPosY;
+            }
+
+            const auto eventStart = std::chrono::steady_clock::now();
+            a_sink->ProcessEvent(&inputEvent, nullptr);
+            const auto eventNs = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - eventStart).count());
+            stats.totalNanoseconds += eventNs;
+            stats.maxEventNanoseconds = std::max(stats.maxEventNanoseconds, eventNs);
+            ++stats.eventCount;
+        }
+
+        if (stats.eventCount > 0 && stats.totalNanoseconds > 0)
+        {
+            stats.avgEventNanoseconds = static_cast<double>(stats.totalNanoseconds) / stats.eventCount;
+            stats.eventsPerSecond = stats.eventCount * 1'000'000'000.0 / stats.totalNanoseconds;
+        }
+
+        spdlog::info("{}: replayed {} events, {:.0f} events/s, avg {:.0f} ns, max {} ns per event",
+                     NameOf(InputRecordService),
+                     stats.eventCount,
+                     stats.eventsPerSecond,
+                     stats.avgEventNanoseconds,
+                     stats.maxEventNanoseconds);
+        return stats;
+    }
+}
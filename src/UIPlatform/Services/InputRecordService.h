@@ -0,0 +1,89 @@
+#pragma once
+
+#include "PCH.h"
+#include "Common/Singleton.h"
+
+namespace NL::Services
+{
+    /// <summary>
+    /// Captures input events seen by the multi layer menu into a binary file and replays them
+    /// through the multi layer menu input path to measure input translation cost. See NL::UI::InputRecordMode
+    /// </summary>
+    class InputRecordService : public NL::Common::Singleton<InputRecordService>
+    {
+      public:
+        static constexpr std::uint32_t FILE_MAGIC = 0x52494C4E; // "NLIR"
+        static constexpr std::uint32_t FILE_VERSION = 2;
+
+#pragma pack(push, 1)
+        struct FileHeader
+        {
+            std::uint32_t magic = FILE_MAGIC;
+            std::uint32_t version = FILE_VERSION;
+        };
+
+        struct Record
+        {
+            // Microseconds since the recording started
+            std::uint64_t timestamp = 0;
+            std::uint8_t eventType = 0;
+            std::uint8_t device = 0;
+            std::uint16_t reserved = 0;
+            std::uint32_t idCode = 0;
+            float value = 0.0f;
+            float heldDuration = 0.0f;
+            // Cursor position before the event, mouse moves are applied to it by the cursor menu
+            float cursorPosX = 0.0f;
+            float cursorPosY = 0.0f;
+            std::int32_t mouseInputX = 0;
+            std::int32_t mouseInputY = 0;
+        };
+#pragma pack(pop)
+
+        struct ReplayStats
+        {
+            std::uint64_t eventCount = 0;
+            std::uint64_t totalNanoseconds = 0;
+            std::uint64_t maxEventNanoseconds = 0;
+            double eventsPerSecond = 0.0;
+            double avgEventNanoseconds = 0.0;
+        };
+
+      private:
+        friend class NL::Common::Singleton<InputRecordService>;
+
+        std::mutex m_recordMutex;
+        std::atomic_bool m_isRecording = false;
+        std::ofstream m_recordStream;
+        std::chrono::steady_clock::time_point m_recordStartTime;
+        std::uint64_t m_recordedCount = 0;
+
+        std::mutex m_replayMutex;
+        std::atomic_bool m_isReplayPending = false;
+        std::filesystem::path m_replayPath;
+
+      public:
+        bool StartRecording(const std::filesystem::path& a_path);
+        void StopRecording();
+        bool IsRecording();
+        void RecordEvents(RE::InputEvent* a_event);
+
+        static bool LoadRecords(const std::filesystem::path& a_path, std::vector<Record>& a_outRecords);
+
+        /// <summary>
+        /// The file is replayed by the next ReplayPending call
+        /// </summary>
+        void SetReplayPending(const std::filesystem::path& a_path);
+        bool IsReplayPending();
+
+        /// <summary>
+        /// Replays the pending file once. Must be called from the game input thread
+        /// </summary>
+        void ReplayPending(RE::BSTEventSink<RE::InputEvent*>* a_sink);
+
+        /// <summary>
+        /// Feeds recorded events to the sink one by one as fast as possible. Must be called from the game input thread
+        /// </summary>
+        static ReplayStats Replay(const std::vector<Record>& a_records, RE::BSTEventSink<RE::InputEvent*>* a_sink);
+    };
+}
@@ -0,0 +1,191 @@
+#include "MetricsService.h"
+
+namespace NL::Services
+{
+    std::uint64_t MetricsService::GetMicroseconds(std::chrono::steady_clock::duration a_duration)
+    {
+        return static_cast<std::uint64_t>(std::max<std::int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(a_duration).count(), 0));
+    }
+
+    NL::Metrics::MetricTable& MetricsService::GetFunctionTable()
+    {
+        return m_functionTable;
+    }
+
+    NL::Metrics::MetricTable& MetricsService::GetMessageTable()
+    {
+        return m_messageTable;
+    }
+
+    bool MetricsService::SetRendererSnapshot(int a_browserId, const void* a_data, size_t a_size)
+    {
+        // [function entries][message entries] (see CEFMetrics::SendReportIfDue)
+        RendererSnapshot snapshot;
+        NL::IPC::PayloadReader reader(a_data, a_size);
+        if (!NL::Metrics::MetricTable::Deserialize(reader, snapshot.functions) ||
+            !NL::Metrics::MetricTable::Deserialize(reader, snapshot.messages) ||
+            !reader.IsEnd())
+        {
+            return false;
+        }
+
+        std::lock_guard locker(m_rendererMutex);
+        m_rendererMap.insert_or_assign(a_browserId, std::move(snapshot));
+        return true;
+    }
+
+    void MetricsService::RemoveRenderer(int a_browserId)
+    {
+        std::lock_guard locker(m_rendererMutex);
+        m_rendererMap.erase(a_browserId);
+    }
+
+    void MetricsService::WriteTiming(std::string& a_out, const NL::Metrics::HistogramSnapshot& a_timing)
+    {
+        a_out += "{\"count\":";
+        NL::Converters::JSONStreamWriter::WriteInt(a_out, static_cast<std::int64_t>(a_timing.count));
+        a_out += ",\"avgUs\":";
+        NL::Converters::JSONStreamWriter::WriteDouble(a_out, a_timing.count > 0 ? static_cast<double>(a_timing.sum) / a_timing.count : 0.0);
+        a_out += ",\"p50Us\":";
+        NL::Converters::JSONStreamWriter::WriteInt(a_out, static_cast<std::int64_t>(a_timing.GetPercentile(0.5)));
+        a_out += ",\"p90Us\":";
+        NL::Converters::JSONStreamWriter::WriteInt(a_out, static_cast<std::int64_t>(a_timing.GetPercentile(0.9)));
+        a_out += ",\"p99Us\":";
+        NL::Converters::JSONStreamWriter::WriteInt(a_out, static_cast<std::int64_t>(a_timing.GetPercentile(0.99)));
+        a_out += ",\"maxUs\":";
+        NL::Converters::JSONStreamWriter::WriteInt(a_out, static_cast<std::int64_t>(a_timing.max));
+        a_out += '}';
+    }
+
+    void MetricsService::WriteEntries(std::string& a_out, const std::vector<NL::Metrics::EntrySnapshot>& a_entries, std::initializer_list<std::string_view> a_timingNames)
+    {
+        a_out += '[';
+        for (size_t i = 0; i < a_entries.size(); ++i)
+        {
+            const auto& entry = a_entries[i];
+            if (i > 0)
+            {
+                a_out += ',';
+            }
+
+            a_out += "{\"name\":";
+            NL::Converters::JSONStreamWriter::WriteString(a_out, entry.name);
+            a_out += ",\"count\":";
+            NL::Converters::JSONStreamWriter::WriteInt(a_out, static_cast<std::int64_t>(entry.count));
+            a_out += ",\"bytes\":";
+            NL::Converters::JSONStreamWriter::WriteInt(a_out, static_cast<std::int64_t>(entry.bytes));
+
+            size_t timingIndex = 0;
+            for (const auto timingName : a_timingNames)
+            {
+                if (timingIndex >= entry.timings.size())
+                {
+                    break;
+                }
+
+                a_out += ',';
+                NL::Converters::JSONStreamWriter::WriteString(a_out, timingName);
+                a_out += ':';
+                WriteTiming(a_out, entry.timings[timingIndex++]);
+            }
+            a_out += '}';
+        }
+        a_out += ']';
+    }
+
+    std::string MetricsService::GetReportJSON()
+    {
+        std::string result;
+        result += "{\"plugin\":{\"functions\":";
+        WriteEntries(result, m_functionTable.TakeSnapshot(), {"queueWait", "callback"});
+        result += ",\"messages\":";
+        WriteEntries(result, m_messageTable.TakeSnapshot(), {"dispatch"});
+        result += "},\"renderers\":[";
+
+        std::lock_guard locker(m_rendererMutex);
+        auto isFirst = true;
+        for (const auto& [browserId, snapshot] : m_rendererMap)
+        {
+            if (!isFirst)
+            {
+                result += ',';
+            }
+            isFirst = false;
+
+            result += "{\"browserId\":";
+            NL::Converters::JSONStreamWriter::WriteInt(result, browserId);
+            result += ",\"functions\":";
+            WriteEntries(result, snapshot.functions, {"call"});
+            result += ",\"messages\":";
+            WriteEntries(result, snapshot.messages, {"dispatch"});
+            result += '}';
+        }
+        result += "]}";
+
+        return result;
+    }
+
+    void MetricsService::LogEntries(std::string_view a_section, std::vector<NL::Metrics::EntrySnapshot> a_entries)
+    {
+        const auto getTotalUs = [](const NL::Metrics::EntrySnapshot& a_entry) {
+            std::uint64_t total = 0;
+            for (const auto& timing : a_entry.timings)
+            {
+                total += timing.sum;
+            }
+            return total;
+        };
+
+        const auto count = std::min(a_entries.size(), LOG_TOP_COUNT);
+        std::partial_sort(a_entries.begin(), a_entries.begin() + count, a_entries.end(), [&](const auto& a_left, const auto& a_right) {
+            return getTotalUs(a_left) > getTotalUs(a_right);
+        });
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const auto& entry = a_entries[i];
+            spdlog::info("{}: {} \"{}\" count {}, bytes {}, [{}] [{}]",
+                         NameOf(MetricsService),
+                         a_section,
+                         entry.name,
+                         entry.count,
+                         entry.bytes,
+                         entry.timings[0].ToString(),
+                         entry.timings[1].ToString());
+        }
+    }
+
+    void MetricsService::LogReportIfDue(std::chrono::steady_clock::time_point a_now)
+    {
+        const auto now = a_now.time_since_epoch().count();
+        auto lastLogTime = m_lastLogTime.load(std::memory_order_relaxed);
+        if (std::chrono::steady_clock::duration(now - lastLogTime) < LOG_INTERVAL ||
+            !m_lastLogTime.compare_exchange_strong(lastLogTime, now, std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        LogEntries("plugin function", m_functionTable.TakeSnapshot());
+        LogEntries("plugin message", m_messageTable.TakeSnapshot());
+
+        {
+            std::lock_guard locker(m_rendererMutex);
+            for (const auto& [browserId, snapshot] : m_rendererMap)
+            {
+                LogEntries(fmt::format("renderer {} function", browserId), snapshot.functions);
+                LogEntries(fmt::format("renderer {} message", browserId), snapshot.messages);
+            }
+        }
+
+        const auto poolStats = NL::JS::JSCallbackWorkerPool::GetSingleton().GetStats();
+        spdlog::info("{}: callback pool queued {}/{}, peak {}, executed {}, stolen {}, rejected {}, waited {}",
+                     NameOf(MetricsService),
+                     poolStats.queuedCount,
+                     poolStats.maxQueuedCount,
+                     poolStats.peakQueuedCount,
+                     poolStats.executedCount,
+                     poolStats.stolenCount,
+                     poolStats.rejectedCount,
+                     poolStats.waitCount);
+    }
+}
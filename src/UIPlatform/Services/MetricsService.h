@@ -0,0 +1,66 @@
+#pragma once
+
+#include "PCH.h"
+#include "Common/Singleton.h"
+#include "Converters/JSONStreamWriter.h"
+#include "JS/JSCallbackWorkerPool.h"
+#include "Metrics/MetricTable.hpp"
+
+namespace NL::Services
+{
+    /// <summary>
+    /// Per-function and per-IPC-message counters of the plugin process and the last snapshots sent by renderers (see IPC_METRICS_EVENT).
+    /// Functions are keyed by MetricTable::MakeKey("objectName.funcName"), timing 0 is the queue wait, timing 1 is the callback.
+    /// Messages are keyed by MetricTable::MakeKey(message name), timing 0 is the dispatch
+    /// </summary>
+    class MetricsService : public NL::Common::Singleton<MetricsService>
+    {
+      public:
+        static constexpr auto LOG_INTERVAL = std::chrono::seconds(60);
+        // Entries per section in the log, sorted by total time
+        static constexpr size_t LOG_TOP_COUNT = 10;
+
+      protected:
+        friend class NL::Common::Singleton<MetricsService>;
+
+        struct RendererSnapshot
+        {
+            std::vector<NL::Metrics::EntrySnapshot> functions;
+            std::vector<NL::Metrics::EntrySnapshot> messages;
+        };
+
+        NL::Metrics::MetricTable m_functionTable;
+        NL::Metrics::MetricTable m_messageTable;
+
+        std::mutex m_rendererMutex;
+        std::map<int, RendererSnapshot> m_rendererMap;
+
+        std::atomic<std::chrono::steady_clock::rep> m_lastLogTime = std::chrono::steady_clock::now().time_since_epoch().count();
+
+        static void WriteTiming(std::string& a_out, const NL::Metrics::HistogramSnapshot& a_timing);
+        // One object per timing, a_timingNames are the keys of timing 0, 1...
+        static void WriteEntries(std::string& a_out, const std::vector<NL::Metrics::EntrySnapshot>& a_entries, std::initializer_list<std::string_view> a_timingNames);
+        static void LogEntries(std::string_view a_section, std::vector<NL::Metrics::EntrySnapshot> a_entries);
+
+      public:
+        static std::uint64_t GetMicroseconds(std::chrono::steady_clock::duration a_duration);
+
+        NL::Metrics::MetricTable& GetFunctionTable();
+        NL::Metrics::MetricTable& GetMessageTable();
+
+        /// <summary>
+        /// a_data is the IPC_METRICS_EVENT payload, returns false if it is malformed
+        /// </summary>
+        bool SetRendererSnapshot(int a_browserId, const void* a_data, size_t a_size);
+        void RemoveRenderer(int a_browserId);
+
+        /// <summary>
+        /// {"plugin":{"functions":[...],"messages":[...]},"renderers":[{"browserId":1,"functions":[...],"messages":[...]}]}
+        /// </summary>
+        std::string GetReportJSON();
+        /// <summary>
+        /// Logs the most expensive entries once per LOG_INTERVAL, any thread
+        /// </summary>
+        void LogReportIfDue(std::chrono::steady_clock::time_point a_now = std::chrono::steady_clock::now());
+    };
+}
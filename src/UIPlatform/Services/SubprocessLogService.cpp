@@ -0,0 +1,104 @@
+#include "SubprocessLogService.h"
+
+namespace NL::Services
+{
+    SubprocessLogService::Ring::~Ring()
+    {
+        if (process != nullptr)
+        {
+            ::CloseHandle(process);
+        }
+    }
+
+    SubprocessLogService::~SubprocessLogService()
+    {
+        Stop();
+    }
+
+    void SubprocessLogService::Drain(Ring& a_ring, const std::shared_ptr<spdlog::logger>& a_logger)
+    {
+        std::uint8_t level = 0;
+        std::string message;
+        while (a_ring.ring.Read(level, message))
+        {
+            if (a_logger != nullptr)
+            {
+                a_logger->log(static_cast<spdlog::level::level_enum>(std::min<std::uint8_t>(level, spdlog::level::off)), message);
+            }
+        }
+
+        if (const auto droppedCount = a_ring.ring.TakeDroppedCount(); droppedCount > 0 && a_logger != nullptr)
+        {
+            a_logger->warn("{}: {} messages of {} were dropped, the log ring was full", NameOf(SubprocessLogService), droppedCount, a_ring.mappingName);
+        }
+    }
+
+    void SubprocessLogService::DrainLoop(std::stop_token a_stopToken)
+    {
+        while (!a_stopToken.stop_requested())
+        {
+            const auto logger = spdlog::get(NL_UI_SUBPROC_NAME);
+            {
+                std::unique_lock locker(m_ringMutex);
+                for (auto it = m_rings.begin(); it != m_rings.end();)
+                {
+                    // Exit is checked first, so nothing written before it is lost
+                    const auto hasExited = (*it)->process != nullptr && ::WaitForSingleObject((*it)->process, 0) == WAIT_OBJECT_0;
+                    Drain(**it, logger);
+                    it = hasExited ? m_rings.erase(it) : std::next(it);
+                }
+
+                m_stopCondition.wait_for(locker, a_stopToken, DRAIN_INTERVAL, [] { return false; });
+            }
+        }
+    }
+
+    void SubprocessLogService::AddRing(const std::string& a_mappingName, DWORD a_processId)
+    {
+        std::lock_guard locker(m_ringMutex);
+        if (m_isStopped || std::any_of(m_rings.begin(), m_rings.end(), [&](const std::unique_ptr<Ring>& a_ring) { return a_ring->mappingName == a_mappingName; }))
+        {
+            return;
+        }
+
+        auto ring = std::make_unique<Ring>();
+        ring->mappingName = a_mappingName;
+        const auto mappingSize = NL::IPC::LogRing::GetMappingSize(NL::IPC::LogRing::DEFAULT_CAPACITY);
+        if (!ring->mapping.Open(a_mappingName, mappingSize, false) || !ring->ring.Attach(ring->mapping.GetMemory(), ring->mapping.GetSize()))
+        {
+            spdlog::error("{}: can't open log ring {}, error {}", NameOf(SubprocessLogService), a_mappingName, ::GetLastError());
+            return;
+        }
+
+        // Without a handle the ring stays open until Stop()
+        ring->process = ::OpenProcess(SYNCHRONIZE, FALSE, a_processId);
+        m_rings.push_back(std::move(ring));
+
+        if (!m_drainThread.joinable())
+        {
+            m_drainThread = std::jthread([this](std::stop_token a_stopToken) { DrainLoop(a_stopToken); });
+        }
+    }
+
+    void SubprocessLogService::Stop()
+    {
+        {
+            std::lock_guard locker(m_ringMutex);
+            m_isStopped = true;
+        }
+
+        if (m_drainThread.joinable())
+        {
+            m_drainThread.request_stop();
+            m_drainThread.join();
+        }
+
+        std::lock_guard locker(m_ringMutex);
+        const auto logger = spdlog::get(NL_UI_SUBPROC_NAME);
+        for (const auto& ring : m_rings)
+        {
+            Drain(*ring, logger);
+        }
+        m_rings.clear();
+    }
+}
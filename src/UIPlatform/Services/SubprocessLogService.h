@@ -0,0 +1,53 @@
+#pragma once
+
+#include "PCH.h"
+#include "Common/Singleton.h"
+#include "IPCLogRing.h"
+#include "IPCSharedMapping.h"
+
+namespace NL::Services
+{
+    /// <summary>
+    /// Drains the log rings of renderer processes (see IPC_LOG_RING_EVENT) into the NL_UI_SUBPROC_NAME logger on a background thread.
+    /// A ring is closed after its process has exited and the ring is empty
+    /// </summary>
+    class SubprocessLogService : public NL::Common::Singleton<SubprocessLogService>
+    {
+      public:
+        static constexpr auto DRAIN_INTERVAL = std::chrono::milliseconds(50);
+
+      protected:
+        friend class NL::Common::Singleton<SubprocessLogService>;
+
+        struct Ring
+        {
+            std::string mappingName;
+            HANDLE process = nullptr;
+            NL::IPC::SharedMapping mapping;
+            NL::IPC::LogRing ring;
+
+            ~Ring();
+        };
+
+        std::mutex m_ringMutex;
+        std::vector<std::unique_ptr<Ring>> m_rings;
+        bool m_isStopped = false;
+        std::condition_variable_any m_stopCondition;
+        std::jthread m_drainThread;
+
+        static void Drain(Ring& a_ring, const std::shared_ptr<spdlog::logger>& a_logger);
+        void DrainLoop(std::stop_token a_stopToken);
+
+      public:
+        ~SubprocessLogService() override;
+
+        /// <summary>
+        /// Opens the ring and starts the drain thread. A ring that is already open is skipped, so is any ring after Stop()
+        /// </summary>
+        void AddRing(const std::string& a_mappingName, DWORD a_processId);
+        /// <summary>
+        /// Drains all rings one last time and joins the drain thread
+        /// </summary>
+        void Stop();
+    };
+}
@@ -61,6 +61,23 @@ namespace NL::Services
             return static_cast<RE::IMenu*>(mlMenu.get());
         });
 
+        const auto inputRecordMode = a_settingsProvider->GetInputRecordMode();
+        if (inputRecordMode != NL::UI::InputRecordMode::Off)
+        {
+            if (auto recordPath = logger::log_directory())
+            {
+                *recordPath /= fmt::format("{}.inputrec"sv, NL::UI::LibVersion::PROJECT_NAME);
+                if (inputRecordMode == NL::UI::InputRecordMode::Record)
+                {
+                    InputRecordService::GetSingleton().StartRecording(*recordPath);
+                }
+                else if (inputRecordMode == NL::UI::InputRecordMode::Replay)
+                {
+                    InputRecordService::GetSingleton().SetReplayPending(*recordPath);
+                }
+            }
+        }
+
         s_isUIPInited = true;
         return true;
     }
@@ -85,6 +102,9 @@ namespace NL::Services
 
     void UIPlatformService::Shutdown()
     {
+        InputRecordService::GetSingleton().StopRecording();
+        NL::JS::JSCallbackWorkerPool::GetSingleton().Stop();
+
         try
         {
             NL::Services::CEFService::CEFShutdown();
@@ -97,6 +117,9 @@ namespace NL::Services
         {
             m_logger->error("{}: error while CEFShutdown", NameOf(UIPlatformService));
         }
+
+        // Records written before CEF was shut down
+        SubprocessLogService::GetSingleton().Stop();
     }
 
     std::shared_ptr<NL::Menus::MultiLayerMenu> UIPlatformService::GetMultiLayerMenu()
@@ -2,6 +2,8 @@
 
 #include "PCH.h"
 #include "CEFService.h"
+#include "InputRecordService.h"
+#include "SubprocessLogService.h"
 #include "Common/Singleton.h"
 #include "Render/IRenderLayer.h"
 #include "CEF/NirnLabCefApp.h"
@@ -131,8 +131,8 @@ extern "C"
         const auto thisLibVer = GetUIPlatformAPIVersion();
         spdlog::info("NirnLabUIPlatform version: {}.{}", NL::UI::LibVersion::GetMajorVersion(thisLibVer.libVersion), NL::UI::LibVersion::GetMinorVersion(thisLibVer.libVersion));
 
-        const auto requestMajorVer = NL::UI::APIVersion::GetMajorVersion(a_requestLibVersion);
-        if (requestMajorVer != NL::UI::APIVersion::MAJOR)
+        // A newer client would call methods this version doesn't have
+        if (!NL::UI::APIVersion::IsCompatible(NL::UI::APIVersion::AS_INT, a_requestLibVersion))
         {
             spdlog::error("Can't return API for \"{}\", this ver is {}.{} and their ver is {}.{}",
                           a_requestLibName == nullptr ? "null" : a_requestLibName,
@@ -40,6 +40,11 @@ namespace NL::UI::DllLoader
     inline ResponseVersionMessage GetUIPlatformAPIVersion()
     {
         const auto funcPtr = reinterpret_cast<decltype(&GetUIPlatformAPIVersion)>(GetProcAddress(GetNirnLabUILib(), NameOf(GetUIPlatformAPIVersion)));
+        if (funcPtr == nullptr)
+        {
+            throw std::runtime_error(std::format("{} not found in {}.dll", NameOf(GetUIPlatformAPIVersion), NL::UI::LibVersion::PROJECT_NAME));
+        }
+
         return funcPtr();
     }
 
@@ -65,6 +70,12 @@ namespace NL::UI::DllLoader
             return false;
         }
 
+        // Older libraries only check the major version, so the client checks the minor version itself
+        if (!NL::UI::APIVersion::IsCompatible(GetUIPlatformAPIVersion().apiVersion, a_requestLibVersion))
+        {
+            return false;
+        }
+
         return funcPtr(a_outApi, a_settings, a_requestLibVersion, a_requestLibName);
     }
 }
@@ -3,12 +3,115 @@
 namespace NL::JS
 {
     using JSFuncCallback = void (*)(const char** a_args, int a_argsCount);
+    /// <summary>
+    /// The JS function returns a Promise. Complete it with IBrowser::ResolveAsyncCall/RejectAsyncCall using a_token,
+    /// from any thread. The promise is rejected if it is not completed in time
+    /// </summary>
+    using JSFuncAsyncCallback = void (*)(const char** a_args, int a_argsCount, std::uint64_t a_token);
+
+    enum class JSArgType : std::uint8_t
+    {
+        JSON = 0,
+        // ArrayBuffer, typed array or DataView bytes
+        Binary,
+    };
+
+    /// <summary>
+    /// Argument of JSFuncBinaryCallback. JSON data is null terminated, size doesn't count the terminator.
+    /// Data is valid until the callback returns
+    /// </summary>
+    struct JSArg
+    {
+        JSArgType type = JSArgType::JSON;
+        const char* data = nullptr;
+        std::uint32_t size = 0;
+    };
+
+    /// <summary>
+    /// Binary-safe variant, ArrayBuffer and typed array arguments are passed as bytes instead of null.
+    /// a_token is 0 unless isAsync is true (see JSFuncAsyncCallback)
+    /// </summary>
+    using JSFuncBinaryCallback = void (*)(const JSArg* a_args, int a_argsCount, std::uint64_t a_token);
 
     struct JSFuncCallbackData
     {
-        JSFuncCallback callback = nullptr;
+        // Flags after isEventFunction were added in API 3.1
+        static constexpr std::uint8_t VERSION = 1;
+
+        union
+        {
+            JSFuncCallback callback = nullptr;
+            // Used if isAsync is true
+            JSFuncAsyncCallback asyncCallback;
+            // Used if binaryArgs is true
+            JSFuncBinaryCallback binaryCallback;
+        };
         bool executeInGameThread = true;
         bool isEventFunction = false;
+        /// <summary>
+        /// Set by the initializer. Clients built against API 3.0 have padding here, the flags below are ignored unless it is VERSION
+        /// </summary>
+        std::uint8_t version = VERSION;
+        /// <summary>
+        /// Calls made within one JS task are sent together after the task ends, in call order.
+        /// Use for functions called in a loop (filters, drag updates)
+        /// </summary>
+        bool batchCalls = false;
+        bool isAsync = false;
+        /// <summary>
+        /// Only for executeInGameThread = false. Callbacks run on worker threads, one at a time in call order by default.
+        /// Set to run calls of this function in parallel
+        /// </summary>
+        bool parallelCalls = false;
+        /// <summary>
+        /// Use binaryCallback. Other callbacks get null for binary arguments.
+        /// Only top-level arguments can be binary, ArrayBuffers inside arrays and objects are dropped from the JSON
+        /// </summary>
+        bool binaryArgs = false;
+        /// <summary>
+        /// Only for functions with an object name. The JS function is created on first access through the namespace object
+        /// instead of on every page load, use for large APIs. Lazy functions are not listed by Object.keys
+        /// </summary>
+        bool lazyBinding = false;
+    };
+    // The 3.0 layout had the same size, the flags live in its padding
+    static_assert(sizeof(JSFuncCallbackData) == 16);
+
+    enum class JSEventFieldType : std::uint8_t
+    {
+        Int32 = 0,
+        Float,
+        Double,
+        Bool,
+    };
+
+    /// <summary>
+    /// Field of a positional event payload (see IBrowser::RegisterEventSchema)
+    /// </summary>
+    struct JSEventField
+    {
+        const char* name = nullptr;
+        JSEventFieldType type = JSEventFieldType::Double;
+    };
+
+    enum class JSScriptArgType : std::uint8_t
+    {
+        Null = 0,
+        Bool,
+        Int,
+        Double,
+        String,
+    };
+
+    /// <summary>
+    /// Argument of a registered script call (see IBrowser::RegisterScript).
+    /// Bool, Int and Double use number, String uses string
+    /// </summary>
+    struct JSScriptArg
+    {
+        JSScriptArgType type = JSScriptArgType::Null;
+        double number = 0.0;
+        const char* string = nullptr;
     };
 
     struct JSFuncInfo
@@ -25,10 +25,8 @@ namespace NL::UI::SKSELoader
                 const auto versionInfo = reinterpret_cast<NL::UI::ResponseVersionMessage*>(a_msg->data);
                 spdlog::info("NirnLabUIPlatform loader: installed version: {}.{}", NL::UI::LibVersion::GetMajorVersion(versionInfo->libVersion), NL::UI::LibVersion::GetMinorVersion(versionInfo->libVersion));
 
-                const auto majorAPIVersion = NL::UI::APIVersion::GetMajorVersion(versionInfo->apiVersion);
-                const auto minorAPIVersion = NL::UI::APIVersion::GetMinorVersion(versionInfo->apiVersion);
                 // Different major version can cause serious compatibility issues. Older minor version may have missing methods
-                if (majorAPIVersion != NL::UI::APIVersion::MAJOR || minorAPIVersion != NL::UI::APIVersion::MINOR)
+                if (!NL::UI::APIVersion::IsCompatible(versionInfo->apiVersion))
                 {
                     LoaderData::s_canUseAPI = false;
                     spdlog::error("NirnLabUIPlatform loader: can't use using this API version. We have {}.{}, but {}.{} is installed",
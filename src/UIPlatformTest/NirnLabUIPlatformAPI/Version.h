@@ -26,10 +26,10 @@ namespace NL::UI::LibVersion
 namespace NL::UI::APIVersion
 {
     inline constexpr std::uint32_t MAJOR = 3;
-    inline constexpr std::uint32_t MINOR = 0;
+    inline constexpr std::uint32_t MINOR = 1;
 
     inline constexpr auto MAJOR_MULT = 100000;
-    inline constexpr auto AS_STRING = "3.0";
+    inline constexpr auto AS_STRING = "3.1";
     inline constexpr std::uint32_t AS_INT = (static_cast<std::uint32_t>(MAJOR * MAJOR_MULT + MINOR));
 	
     inline std::uint32_t GetMajorVersion(std::uint32_t a_version)
@@ -41,4 +41,12 @@ namespace NL::UI::APIVersion
     {
         return a_version - GetMajorVersion(a_version) * MAJOR_MULT;
     }
+
+    /// <summary>
+    /// New methods are appended to the interfaces in minor versions, so a client can use a library with the same major and the same or newer minor
+    /// </summary>
+    inline bool IsCompatible(std::uint32_t a_libraryVersion, std::uint32_t a_clientVersion = AS_INT)
+    {
+        return GetMajorVersion(a_libraryVersion) == GetMajorVersion(a_clientVersion) && GetMinorVersion(a_libraryVersion) >= GetMinorVersion(a_clientVersion);
+    }
 }
@@ -71,9 +71,8 @@ void Init1stMethodToGetAPI()
             const auto versionInfo = reinterpret_cast<NL::UI::ResponseVersionMessage*>(a_msg->data);
             spdlog::info("NirnLabUIPlatform version: {}.{}", NL::UI::LibVersion::GetMajorVersion(versionInfo->libVersion), NL::UI::LibVersion::GetMinorVersion(versionInfo->libVersion));
 
-            const auto majorAPIVersion = NL::UI::APIVersion::GetMajorVersion(versionInfo->apiVersion);
-            // If the major version is different from ours, then using the API may cause problems
-            if (majorAPIVersion != NL::UI::APIVersion::MAJOR)
+            // If the major version is different from ours or the minor version is older, then using the API may cause problems
+            if (!NL::UI::APIVersion::IsCompatible(versionInfo->apiVersion))
             {
                 s_canUseAPI = false;
                 spdlog::error("Can't using this API version of NirnLabUIPlatform. We have {}.{} and installed is {}.{}",